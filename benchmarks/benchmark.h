@@ -0,0 +1,190 @@
+/**
+ * @file benchmark.h
+ * @brief Small helpers shared by the forest benchmarks
+ */
+
+#ifndef FOREST_BENCHMARK_H
+#define FOREST_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace benchmark {
+        /**
+         * @brief A monotonic stopwatch started on construction
+         */
+        class timer {
+        private:
+                std::chrono::steady_clock::time_point start;
+        public:
+                timer() {
+                        start = std::chrono::steady_clock::now();
+                }
+                /**
+                 * @brief Finds the number of seconds elapsed since construction
+                 * @return The elapsed time in seconds
+                 */
+                double seconds() const {
+                        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                }
+        };
+        /**
+         * @brief Counts the last level cache misses of the current thread from construction on
+         *
+         * Uses perf_event_open on Linux. Where hardware counters are unavailable, e.g. in
+         * containers or with a restrictive perf_event_paranoid setting, available() is false.
+         */
+        class cache_misses {
+        private:
+                int descriptor;
+        public:
+                cache_misses() {
+                        descriptor = -1;
+#if defined(__linux__)
+                        perf_event_attr attributes = perf_event_attr();
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.size = sizeof(attributes);
+                        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+                        attributes.exclude_kernel = 1;
+                        attributes.exclude_hv = 1;
+                        descriptor = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+                        if (descriptor != -1) {
+                                ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+                                ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+                        }
+#endif
+                }
+                cache_misses(const cache_misses &) = delete;
+                cache_misses &operator=(const cache_misses &) = delete;
+                ~cache_misses() {
+#if defined(__linux__)
+                        if (descriptor != -1) close(descriptor);
+#endif
+                }
+                bool available() const {
+                        return descriptor != -1;
+                }
+                /**
+                 * @brief Finds the number of cache misses counted so far
+                 * @return The number of cache misses or 0 if the counter is unavailable
+                 */
+                unsigned long long count() const {
+                        unsigned long long value = 0;
+#if defined(__linux__)
+                        if (descriptor != -1 && read(descriptor, &value, sizeof(value)) != sizeof(value)) value = 0;
+#endif
+                        return value;
+                }
+        };
+        /**
+         * @brief Finds the resident set size of the current process
+         * @return The resident set size in bytes or 0 if it cannot be determined
+         */
+        inline unsigned long long resident_set_size() {
+#if defined(__linux__)
+                std::ifstream file("/proc/self/statm");
+                unsigned long long pages = 0;
+                unsigned long long resident = 0;
+                if (file >> pages >> resident) {
+                        return resident * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+                }
+#endif
+                return 0;
+        }
+        /**
+         * @brief Runs a function in a child process where possible, so that its resident set growth is not hidden by memory freed earlier
+         * @param function The function to run
+         * @return void
+         */
+        template <typename function_t>
+        void isolated(function_t function) {
+#if defined(__unix__) || defined(__APPLE__)
+                std::cout.flush();
+                pid_t pid = fork();
+                if (pid == 0) {
+                        function();
+                        std::cout.flush();
+                        _exit(0);
+                }
+                if (pid > 0) {
+                        int status = 0;
+                        waitpid(pid, &status, 0);
+                        return;
+                }
+#endif
+                function();
+        }
+        /**
+         * @brief Reads a positive integer command line argument
+         * @param argc The argument count passed to main
+         * @param argv The argument vector passed to main
+         * @param index The position of the argument
+         * @param fallback The value returned when the argument is missing
+         * @return The value of the argument or fallback
+         */
+        inline unsigned long long argument(int argc, char const *argv[], int index, unsigned long long fallback) {
+                if (index < argc) {
+                        unsigned long long value = std::strtoull(argv[index], nullptr, 10);
+                        if (value > 0) return value;
+                }
+                return fallback;
+        }
+        /**
+         * @brief Generates the keys 0, 1, ..., n - 1 in a random order
+         * @param n The number of keys
+         * @param seed The seed of the random number generator
+         * @return The shuffled keys
+         */
+        inline std::vector <int> shuffled_keys(unsigned long long n, unsigned seed = 42) {
+                std::vector <int> keys(n);
+                for (unsigned long long i = 0; i < n; i++) keys[i] = static_cast<int>(i);
+                std::shuffle(keys.begin(), keys.end(), std::mt19937(seed));
+                return keys;
+        }
+        /**
+         * @brief Prevents the compiler from optimizing away the computation of value
+         */
+        template <typename T>
+        inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__)
+                asm volatile("" : : "r,m"(value) : "memory");
+#else
+                static volatile const T *sink;
+                sink = &value;
+#endif
+        }
+        /**
+         * @brief Prints one result row
+         * @param name The name of the measured operation
+         * @param operations The number of operations performed
+         * @param seconds The time taken in seconds
+         * @return void
+         */
+        inline void report(const std::string &name, unsigned long long operations, double seconds) {
+                std::cout << std::left << std::setw(48) << name << std::right
+                          << std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms"
+                          << std::setw(14) << std::setprecision(1) << (seconds > 0 ? operations / seconds / 1e6 : 0) << " Mops/s"
+                          << std::setw(14) << std::setprecision(2) << (operations > 0 ? seconds * 1e9 / operations : 0) << " ns/op"
+                          << std::endl;
+        }
+}
+
+#endif
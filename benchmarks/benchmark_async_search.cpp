@@ -0,0 +1,62 @@
+#include "benchmark.h"
+#include <forest/async_search.h>
+#include <forest/red_black_tree.h>
+#include <iostream>
+
+#if defined(FOREST_ASYNC_SEARCH)
+
+typedef forest::red_black_tree <int, int> tree_t;
+typedef forest::red_black_tree_node <int, int> node_t;
+
+void run(unsigned long long n, unsigned long long lookups) {
+        // Shuffled keys, so the nodes are scattered through memory
+        std::vector <int> keys = benchmark::shuffled_keys(n, 3);
+        tree_t tree;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        keys = std::vector <int> ();
+        // Queries are drawn from a range twice the size of the keys, so about half of the lookups miss
+        std::vector <int> queries = benchmark::shuffled_keys(2 * n, 7);
+        queries.resize(std::min(2 * n, lookups));
+        std::string size = std::to_string(n / 1000000) + "M";
+        unsigned long long hits = 0;
+        benchmark::timer timer;
+        for (int query : queries) {
+                hits += tree.search(query) != nullptr;
+        }
+        benchmark::report("search " + size, queries.size(), timer.seconds());
+        std::vector <node_t *> batched(queries.size());
+        timer = benchmark::timer();
+        tree.search_batch(queries.data(), queries.size(), batched.data());
+        benchmark::report("search_batch " + size, queries.size(), timer.seconds());
+        std::vector <const node_t *> interleaved(queries.size());
+        for (std::size_t lanes = 1; lanes <= 64; lanes *= 2) {
+                timer = benchmark::timer();
+                forest::interleaved_search(tree, queries.data(), queries.size(), interleaved.data(), lanes);
+                benchmark::report("interleaved_search " + std::to_string(lanes) + " lanes " + size, queries.size(), timer.seconds());
+                if (!std::equal(interleaved.begin(), interleaved.end(), batched.begin())) {
+                        std::cerr << "interleaved_search disagrees with search_batch" << std::endl;
+                        std::exit(1);
+                }
+        }
+        benchmark::do_not_optimize(hits);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long largest = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 1000000);
+        for (unsigned long long n = 1000000; n <= largest; n *= 10) {
+                benchmark::isolated([&]() { run(n, lookups); });
+        }
+        return 0;
+}
+
+#else
+
+int main() {
+        std::cout << "async_search.h needs a compiler with coroutines" << std::endl;
+        return 0;
+}
+
+#endif
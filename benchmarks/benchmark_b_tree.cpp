@@ -0,0 +1,50 @@
+#include "benchmark.h"
+#include <forest/b_tree.h>
+#include <forest/red_black_tree.h>
+
+template <typename tree_t>
+void run(const std::string &name, const std::vector <int> &keys, const std::vector <int> &queries) {
+        unsigned long long before = benchmark::resident_set_size();
+        tree_t tree;
+        benchmark::timer timer;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        benchmark::report(name + " insert", keys.size(), timer.seconds());
+        unsigned long long after = benchmark::resident_set_size();
+        std::cout << name << " height " << tree.height() << ", resident set grew by " << (after - before) / (1 << 20) << " MiB" << std::endl;
+        unsigned long long found = 0;
+        benchmark::cache_misses misses;
+        timer = benchmark::timer();
+        for (int query : queries) {
+                found += tree.search(query) != nullptr;
+        }
+        benchmark::report(name + " search", queries.size(), timer.seconds());
+        if (misses.available()) {
+                std::cout << name << " search cache misses per lookup " << static_cast<double>(misses.count()) / queries.size() << std::endl;
+        }
+        timer = benchmark::timer();
+        for (const auto &element : tree) {
+                found += element.value;
+        }
+        benchmark::report(name + " scan", keys.size(), timer.seconds());
+        timer = benchmark::timer();
+        for (int query : queries) {
+                found += tree.erase(query);
+        }
+        benchmark::report(name + " erase", queries.size(), timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 2000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::vector <int> queries = benchmark::shuffled_keys(n, 7);
+        queries.resize(std::min(n, lookups));
+        benchmark::isolated([&]() { run <forest::red_black_tree <int, int> > ("red_black_tree", keys, queries); });
+        benchmark::isolated([&]() { run <forest::b_tree <int, int, std::less <int>, 15> > ("b_tree 15 keys", keys, queries); });
+        benchmark::isolated([&]() { run <forest::b_tree <int, int> > ("b_tree 64 keys", keys, queries); });
+        benchmark::isolated([&]() { run <forest::b_tree <int, int, std::less <int>, 255> > ("b_tree 255 keys", keys, queries); });
+        return 0;
+}
@@ -0,0 +1,66 @@
+#include "benchmark.h"
+#include <forest/b_tree.h>
+#include <forest/bplus_tree.h>
+#include <forest/red_black_tree.h>
+
+/**
+ * @brief Adds up the values handed to it by for_each_in_range, whatever the element type of the tree
+ */
+struct accumulate {
+        unsigned long long *sum;
+        template <typename element_t>
+        void operator()(const element_t &element) const {
+                *sum += element.value;
+        }
+};
+
+template <typename tree_t>
+void run(const std::string &name, const std::vector <int> &keys, const std::vector <int> &starts, unsigned long long passes, int range) {
+        tree_t tree;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        unsigned long long sum = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < passes; i++) {
+                for (const auto &element : tree) {
+                        sum += element.value;
+                }
+        }
+        benchmark::report(name + " iterator scan", passes * keys.size(), timer.seconds());
+        int n = static_cast<int>(keys.size());
+        timer = benchmark::timer();
+        for (unsigned long long i = 0; i < passes; i++) {
+                tree.for_each_in_range(0, n, accumulate {&sum});
+        }
+        benchmark::report(name + " for_each_in_range all", passes * keys.size(), timer.seconds());
+        unsigned long long visited = 0;
+        timer = benchmark::timer();
+        for (int start : starts) {
+                unsigned long long before = sum;
+                tree.for_each_in_range(start, start + range, accumulate {&sum});
+                visited += sum != before;
+        }
+        double seconds = timer.seconds();
+        // Keys are 0 to n - 1, so a range starting at start holds min(range, n - start) keys
+        unsigned long long scanned = 0;
+        for (int start : starts) {
+                scanned += std::min(range, n - start);
+        }
+        benchmark::report(name + " for_each_in_range " + std::to_string(range), scanned, seconds);
+        benchmark::do_not_optimize(sum + visited);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 2000000);
+        unsigned long long passes = benchmark::argument(argc, argv, 2, 10);
+        int range = static_cast<int>(benchmark::argument(argc, argv, 3, 100));
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::vector <int> starts = benchmark::shuffled_keys(n, 7);
+        starts.resize(std::min <unsigned long long> (n, 100000));
+        // Mops/s is millions of keys scanned per second
+        benchmark::isolated([&]() { run <forest::red_black_tree <int, int> > ("red_black_tree", keys, starts, passes, range); });
+        benchmark::isolated([&]() { run <forest::b_tree <int, int> > ("b_tree", keys, starts, passes, range); });
+        benchmark::isolated([&]() { run <forest::bplus_tree <int, int> > ("bplus_tree", keys, starts, passes, range); });
+        return 0;
+}
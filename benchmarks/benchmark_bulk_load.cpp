@@ -0,0 +1,42 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+
+template <typename tree_t>
+void run_insert(const std::string &name, const std::vector <std::pair <int, int> > &pairs) {
+        benchmark::timer timer;
+        tree_t tree;
+        for (const auto &pair : pairs) {
+                tree.insert(pair.first, pair.second);
+        }
+        benchmark::report(name, pairs.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+template <typename tree_t>
+void run_assign_sorted(const std::string &name, const std::vector <std::pair <int, int> > &pairs) {
+        benchmark::timer timer;
+        tree_t tree = tree_t::from_sorted(pairs.begin(), pairs.end());
+        benchmark::report(name, pairs.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 5000000);
+        std::vector <std::pair <int, int> > sorted;
+        for (unsigned long long i = 0; i < n; i++) {
+                sorted.push_back(std::make_pair(static_cast<int>(i), static_cast<int>(i)));
+        }
+        std::vector <std::pair <int, int> > shuffled = sorted;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+        std::cout << "Loading " << n << " sorted keys" << std::endl;
+        run_insert<forest::red_black_tree <int, int> >("red_black_tree insert sorted", sorted);
+        run_assign_sorted<forest::red_black_tree <int, int> >("red_black_tree from_sorted", sorted);
+        run_insert<forest::splay_tree <int, int> >("splay_tree insert sorted", sorted);
+        run_assign_sorted<forest::splay_tree <int, int> >("splay_tree from_sorted", sorted);
+        run_assign_sorted<forest::binary_search_tree <int, int> >("binary_search_tree from_sorted", sorted);
+        // Inserting sorted keys into a binary search tree is quadratic, so shuffled keys are the baseline
+        run_insert<forest::binary_search_tree <int, int> >("binary_search_tree insert shuffled", shuffled);
+        return 0;
+}
@@ -0,0 +1,58 @@
+#include "benchmark.h"
+#include <forest/cache_oblivious_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/static_search_tree.h>
+#include <algorithm>
+
+template <typename function_t>
+void measure(const std::string &name, const std::vector <int> &queries, function_t search) {
+        unsigned long long found = 0;
+        benchmark::timer timer;
+        for (int query : queries) {
+                found += search(query);
+        }
+        benchmark::report(name, queries.size(), timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+void run(unsigned long long n, unsigned long long lookups) {
+        std::vector <std::pair <int, int> > pairs;
+        pairs.reserve(n);
+        for (unsigned long long i = 0; i < n; i++) {
+                pairs.emplace_back(static_cast<int>(i), static_cast<int>(i));
+        }
+        forest::red_black_tree <int, int> tree = forest::red_black_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+        pairs = std::vector <std::pair <int, int> > ();
+        forest::static_search_tree <int, int> eytzinger = tree.freeze();
+        forest::cache_oblivious_search_tree <int, int> van_emde_boas = forest::cache_oblivious_search_tree <int, int>::from_tree(tree);
+        std::vector <int> sorted;
+        sorted.reserve(n);
+        for (const auto &node : tree) {
+                sorted.push_back(node.key);
+        }
+        // Queries are drawn from a range twice the size of the keys, so about half of the lookups miss
+        std::vector <int> queries = benchmark::shuffled_keys(2 * n, 7);
+        queries.resize(std::min(2 * n, lookups));
+        std::string size = n >= 1000000 ? std::to_string(n / 1000000) + "M" : std::to_string(n / 1000) + "K";
+        measure("red_black_tree " + size, queries, [&](int key) {
+                return tree.search(key) != nullptr;
+        });
+        measure("sorted array binary search " + size, queries, [&](int key) {
+                return std::binary_search(sorted.begin(), sorted.end(), key);
+        });
+        measure("static_search_tree (Eytzinger) " + size, queries, [&](int key) {
+                return eytzinger.search(key) != nullptr;
+        });
+        measure("cache_oblivious_search_tree (vEB) " + size, queries, [&](int key) {
+                return van_emde_boas.search(key) != nullptr;
+        });
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long largest = benchmark::argument(argc, argv, 1, 10000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        for (unsigned long long n = 100000; n <= largest; n *= 10) {
+                benchmark::isolated([&]() { run(n, lookups); });
+        }
+        return 0;
+}
@@ -0,0 +1,48 @@
+#include "benchmark.h"
+#include <forest/pool_allocator.h>
+#include <forest/red_black_tree.h>
+
+template <bool compact>
+using tree_t = forest::red_black_tree <int, int, std::less <int>, forest::pool_allocator <forest::red_black_tree_node <int, int> >, false, compact>;
+
+template <bool compact>
+void run(const std::string &name, const std::vector <int> &keys, const std::vector <int> &queries) {
+        unsigned long long before = benchmark::resident_set_size();
+        tree_t <compact> tree;
+        benchmark::timer timer;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        benchmark::report(name + " insert", keys.size(), timer.seconds());
+        unsigned long long after = benchmark::resident_set_size();
+        std::cout << name << " node size " << sizeof(forest::red_black_tree_node <int, int, false, compact>) << " bytes, "
+                  << "resident set grew by " << (after - before) / (1 << 20) << " MiB" << std::endl;
+        unsigned long long found = 0;
+        benchmark::cache_misses misses;
+        timer = benchmark::timer();
+        for (int query : queries) {
+                found += tree.search(query) != nullptr;
+        }
+        benchmark::report(name + " search", queries.size(), timer.seconds());
+        if (misses.available()) {
+                std::cout << name << " search cache misses per lookup " << static_cast<double>(misses.count()) / queries.size() << std::endl;
+        }
+        timer = benchmark::timer();
+        for (const auto &node : tree) {
+                found += node.value;
+        }
+        benchmark::report(name + " iteration", keys.size(), timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 4000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::vector <int> queries = benchmark::shuffled_keys(n, 7);
+        queries.resize(std::min(n, lookups));
+        // Each tree is destroyed before the next one is built, so the resident set growth of each is measured alone
+        run <false> ("color_t", keys, queries);
+        run <true> ("compact", keys, queries);
+        return 0;
+}
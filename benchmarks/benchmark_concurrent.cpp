@@ -0,0 +1,79 @@
+#include "benchmark.h"
+#include <forest/concurrent.h>
+#include <forest/red_black_tree.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief A plain mutex with the interface of a reader writer lock, so readers serialize like under one global std::mutex
+ */
+class exclusive_mutex {
+private:
+        std::mutex mutex;
+public:
+        void lock() {
+                mutex.lock();
+        }
+        void unlock() {
+                mutex.unlock();
+        }
+        void lock_shared() {
+                mutex.lock();
+        }
+        void unlock_shared() {
+                mutex.unlock();
+        }
+};
+
+/**
+ * @brief Runs threads that each search random keys, and insert or erase one key in every writes_per operations
+ */
+template <typename mutex_t>
+void measure(const std::string &name, unsigned long long n, unsigned long long threads, unsigned long long operations, unsigned long long writes_per) {
+        forest::concurrent <forest::red_black_tree <int, int>, mutex_t> tree;
+        std::vector <int> keys = benchmark::shuffled_keys(n, 3);
+        tree.write([&keys](forest::red_black_tree <int, int> &x) {
+                for (int key : keys) {
+                        x.insert(key, key);
+                }
+        });
+        std::atomic <unsigned long long> found(0);
+        std::vector <std::thread> workers;
+        benchmark::timer timer;
+        for (unsigned long long t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                        std::mt19937 random(static_cast<unsigned>(t));
+                        unsigned long long hits = 0;
+                        for (unsigned long long i = 0; i < operations / threads; i++) {
+                                // Keys at or above n are only ever inserted and erased again by the writes
+                                if (i % writes_per == writes_per - 1) {
+                                        int key = static_cast<int>(n + t);
+                                        if (!tree.insert(key, key)) tree.erase(key);
+                                } else {
+                                        hits += tree.contains(static_cast<int>(random() % n));
+                                }
+                        }
+                        found += hits;
+                });
+        }
+        for (std::thread &worker : workers) {
+                worker.join();
+        }
+        benchmark::report(name + " " + std::to_string(threads) + " threads", operations / threads * threads, timer.seconds());
+        benchmark::do_not_optimize(found.load());
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long operations = benchmark::argument(argc, argv, 2, 2000000);
+        // One write in every 100 operations
+        unsigned long long writes_per = benchmark::argument(argc, argv, 3, 100);
+        std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+        for (unsigned long long threads = 1; threads <= 64; threads *= 2) {
+                benchmark::isolated([&]() { measure<exclusive_mutex>("std::mutex", n, threads, operations, writes_per); });
+                benchmark::isolated([&]() { measure<forest::reader_writer_mutex>("reader_writer_mutex", n, threads, operations, writes_per); });
+                benchmark::isolated([&]() { measure<forest::default_shared_mutex>("default_shared_mutex", n, threads, operations, writes_per); });
+        }
+        return 0;
+}
@@ -0,0 +1,73 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <map>
+
+struct red_black_tree_adapter {
+        forest::red_black_tree <int, int> tree;
+        void insert(int key) { tree.insert(key, key); }
+        void erase(int key) { tree.erase(key); }
+        bool search(int key) { return tree.search(key) != nullptr; }
+};
+
+struct binary_search_tree_adapter {
+        forest::binary_search_tree <int, int> tree;
+        void insert(int key) { tree.insert(key, key); }
+        void erase(int key) { tree.erase(key); }
+        bool search(int key) { return tree.search(key) != nullptr; }
+};
+
+struct map_adapter {
+        std::map <int, int> tree;
+        void insert(int key) { tree.emplace(key, key); }
+        void erase(int key) { tree.erase(key); }
+        bool search(int key) { return tree.find(key) != tree.end(); }
+};
+
+/**
+ * @brief Preloads n keys and then runs operations on random keys of [0, 2n)
+ * @param inserts The percentage of operations that insert
+ * @param erases The percentage of operations that erase, the rest are searches
+ */
+template <typename adapter_t>
+void run(const std::string &name, unsigned long long n, unsigned long long operations, unsigned inserts, unsigned erases) {
+        adapter_t adapter;
+        for (int key : benchmark::shuffled_keys(n)) {
+                adapter.insert(key * 2);
+        }
+        std::mt19937 random(7);
+        unsigned long long found = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < operations; i++) {
+                int key = static_cast<int>(random() % (2 * n));
+                unsigned operation = random() % 100;
+                if (operation < inserts) {
+                        adapter.insert(key);
+                } else if (operation < inserts + erases) {
+                        adapter.erase(key);
+                } else {
+                        found += adapter.search(key);
+                }
+        }
+        benchmark::report(name, operations, timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long operations = benchmark::argument(argc, argv, 2, 2000000);
+        std::cout << "Mixed workloads on " << n << " preloaded keys" << std::endl;
+        run<binary_search_tree_adapter>("binary_search_tree 50% insert 50% erase", n, operations, 50, 50);
+        run<red_black_tree_adapter>("red_black_tree 50% insert 50% erase", n, operations, 50, 50);
+        run<map_adapter>("std::map 50% insert 50% erase", n, operations, 50, 50);
+        run<binary_search_tree_adapter>("binary_search_tree 10/10/80 insert/erase/search", n, operations, 10, 10);
+        run<red_black_tree_adapter>("red_black_tree 10/10/80 insert/erase/search", n, operations, 10, 10);
+        run<map_adapter>("std::map 10/10/80 insert/erase/search", n, operations, 10, 10);
+        run<binary_search_tree_adapter>("binary_search_tree 20/80 insert/erase", n, operations, 20, 80);
+        run<red_black_tree_adapter>("red_black_tree 20/80 insert/erase", n, operations, 20, 80);
+        run<map_adapter>("std::map 20/80 insert/erase", n, operations, 20, 80);
+        run<binary_search_tree_adapter>("binary_search_tree 100% erase", n, operations, 0, 100);
+        run<red_black_tree_adapter>("red_black_tree 100% erase", n, operations, 0, 100);
+        run<map_adapter>("std::map 100% erase", n, operations, 0, 100);
+        return 0;
+}
@@ -0,0 +1,87 @@
+#include "benchmark.h"
+#include <forest/red_black_tree.h>
+#include <array>
+#include <vector>
+
+typedef std::vector <char> vector_value;
+typedef std::array <char, 4096> array_value;
+
+/**
+ * @brief The insert signature used before values were passed by reference: both arguments are copied on every call
+ */
+template <typename tree_t, typename key_t, typename value_t>
+bool legacy_insert(tree_t &tree, key_t key, value_t value) {
+        return tree.insert(key, value) != nullptr;
+}
+
+template <typename value_t, typename function_t>
+void run(const std::string &name, const std::vector <int> &keys, function_t function) {
+        forest::red_black_tree <int, value_t> tree;
+        unsigned long long inserted = 0;
+        benchmark::timer timer;
+        for (int key : keys) {
+                inserted += function(tree, key);
+        }
+        benchmark::report(name, keys.size(), timer.seconds());
+        benchmark::do_not_optimize(inserted);
+}
+
+template <typename value_t, typename function_t>
+void run_duplicates(const std::string &name, const std::vector <int> &keys, function_t function) {
+        forest::red_black_tree <int, value_t> tree;
+        for (int key : keys) {
+                tree.try_emplace(key);
+        }
+        unsigned long long inserted = 0;
+        benchmark::timer timer;
+        for (int key : keys) {
+                inserted += function(tree, key);
+        }
+        benchmark::report(name, keys.size(), timer.seconds());
+        benchmark::do_not_optimize(inserted);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 100000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        const vector_value vector(4096, 'x');
+        const array_value array = {};
+
+        std::cout << "std::vector <char> (4096) values, new keys" << std::endl;
+        run <vector_value> ("legacy by value", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                return legacy_insert(tree, key, vector);
+        });
+        run <vector_value> ("insert const &", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                return tree.insert(key, vector) != nullptr;
+        });
+        run <vector_value> ("insert &&", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                vector_value value(4096, 'x');
+                return tree.insert(key, std::move(value)) != nullptr;
+        });
+        run <vector_value> ("try_emplace", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                return tree.try_emplace(key, 4096, 'x').second;
+        });
+
+        std::cout << "std::vector <char> (4096) values, existing keys" << std::endl;
+        run_duplicates <vector_value> ("legacy by value", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                return legacy_insert(tree, key, vector);
+        });
+        run_duplicates <vector_value> ("insert const &", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                return tree.insert(key, vector) != nullptr;
+        });
+        run_duplicates <vector_value> ("try_emplace", keys, [&](forest::red_black_tree <int, vector_value> &tree, int key) {
+                return tree.try_emplace(key, 4096, 'x').second;
+        });
+
+        std::cout << "std::array <char, 4096> values, new keys" << std::endl;
+        run <array_value> ("legacy by value", keys, [&](forest::red_black_tree <int, array_value> &tree, int key) {
+                return legacy_insert(tree, key, array);
+        });
+        run <array_value> ("insert const &", keys, [&](forest::red_black_tree <int, array_value> &tree, int key) {
+                return tree.insert(key, array) != nullptr;
+        });
+        run <array_value> ("try_emplace", keys, [&](forest::red_black_tree <int, array_value> &tree, int key) {
+                return tree.try_emplace(key).second;
+        });
+        return 0;
+}
@@ -0,0 +1,95 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <map>
+
+/**
+ * @brief Generates increasing keys where each key is swapped with a random key at most window positions later
+ */
+std::vector <int> near_sorted_keys(unsigned long long n, unsigned long long window) {
+        std::vector <int> keys(n);
+        for (unsigned long long i = 0; i < n; i++) keys[i] = static_cast<int>(i);
+        std::mt19937 random(7);
+        for (unsigned long long i = 0; i + 1 < n; i++) {
+                if (random() % 4 != 0) continue;
+                std::swap(keys[i], keys[std::min(n - 1, i + 1 + random() % window)]);
+        }
+        return keys;
+}
+
+template <typename tree_t>
+void run_insert(const std::string &name, const std::vector <int> &keys) {
+        tree_t tree;
+        benchmark::timer timer;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        benchmark::report(name, keys.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+template <typename tree_t>
+void run_insert_end(const std::string &name, const std::vector <int> &keys) {
+        tree_t tree;
+        benchmark::timer timer;
+        for (int key : keys) {
+                tree.insert(tree.end(), key, key);
+        }
+        benchmark::report(name, keys.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+template <typename tree_t>
+void run_insert_previous(const std::string &name, const std::vector <int> &keys) {
+        tree_t tree;
+        typename tree_t::iterator hint = tree.end();
+        benchmark::timer timer;
+        for (int key : keys) {
+                hint = tree.insert(hint, key, key);
+        }
+        benchmark::report(name, keys.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+void run_map(const std::string &name, const std::vector <int> &keys) {
+        std::map <int, int> map;
+        benchmark::timer timer;
+        for (int key : keys) {
+                map.emplace(key, key);
+        }
+        benchmark::report(name + " std::map emplace", keys.size(), timer.seconds());
+        benchmark::do_not_optimize(map.size());
+        map.clear();
+        timer = benchmark::timer();
+        for (int key : keys) {
+                map.emplace_hint(map.end(), key, key);
+        }
+        benchmark::report(name + " std::map emplace_hint end()", keys.size(), timer.seconds());
+        benchmark::do_not_optimize(map.size());
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        std::vector <int> monotone = near_sorted_keys(n, 1);
+        for (unsigned long long i = 0; i < n; i++) monotone[i] = static_cast<int>(i);
+        std::vector <int> near_sorted = near_sorted_keys(n, 16);
+        std::vector <int> random = benchmark::shuffled_keys(n);
+        const std::pair <const char *, const std::vector <int> *> streams[] = {
+                {"monotone", &monotone},
+                {"near sorted", &near_sorted},
+                {"random", &random}
+        };
+        for (const auto &stream : streams) {
+                std::string name = stream.first;
+                const std::vector <int> &keys = *stream.second;
+                run_map(name, keys);
+                run_insert <forest::red_black_tree <int, int> > (name + " red_black_tree insert", keys);
+                run_insert_end <forest::red_black_tree <int, int> > (name + " red_black_tree insert(end())", keys);
+                run_insert_previous <forest::red_black_tree <int, int> > (name + " red_black_tree insert(previous)", keys);
+                // Without rebalancing a near sorted stream degenerates into a list with quadratic insertion
+                if (stream.second == &near_sorted) continue;
+                run_insert <forest::binary_search_tree <int, int> > (name + " binary_search_tree insert", keys);
+                run_insert_previous <forest::binary_search_tree <int, int> > (name + " binary_search_tree insert(previous)", keys);
+        }
+        return 0;
+}
@@ -0,0 +1,73 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+
+template <bool indexed>
+using red_black_tree_t = forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, false, false, indexed>;
+template <bool indexed>
+using binary_search_tree_t = forest::binary_search_tree <int, int, std::less <int>, indexed>;
+template <bool indexed>
+using splay_tree_t = forest::splay_tree <int, int, std::less <int>, indexed>;
+
+/**
+ * @brief Copies a tree with index storage as raw bytes
+ */
+template <typename tree_t>
+tree_t copy(const tree_t &tree, std::true_type) {
+        return tree.clone();
+}
+
+/**
+ * @brief Copies a tree with pointer links, which can only be rebuilt node by node from its sorted contents
+ */
+template <typename tree_t>
+tree_t copy(const tree_t &tree, std::false_type) {
+        std::vector <std::pair <int, int> > pairs;
+        pairs.reserve(tree.size());
+        for (const auto &node : tree) {
+                pairs.emplace_back(node.key, node.value);
+        }
+        return tree_t::from_sorted(pairs.begin(), pairs.end());
+}
+
+template <typename tree_t, bool indexed>
+void run(const std::string &name, unsigned long long node_size, const std::vector <int> &keys, const std::vector <int> &queries) {
+        unsigned long long before = benchmark::resident_set_size();
+        tree_t tree;
+        benchmark::timer timer;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        benchmark::report(name + " insert", keys.size(), timer.seconds());
+        unsigned long long after = benchmark::resident_set_size();
+        std::cout << name << " node size " << node_size << " bytes, "
+                  << "resident set grew by " << (after - before) / (1 << 20) << " MiB" << std::endl;
+        unsigned long long found = 0;
+        timer = benchmark::timer();
+        for (int query : queries) {
+                found += tree.search(query) != nullptr;
+        }
+        benchmark::report(name + " search", queries.size(), timer.seconds());
+        timer = benchmark::timer();
+        tree_t other = copy(tree, std::integral_constant <bool, indexed>());
+        benchmark::report(name + " copy", keys.size(), timer.seconds());
+        found += other.size();
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 2000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::vector <int> queries = benchmark::shuffled_keys(n, 7);
+        queries.resize(std::min(n, lookups));
+        // Each tree is built in its own process, as node arrays are returned to the system while single nodes stay in the heap
+        benchmark::isolated([&]() { run <red_black_tree_t <false>, false> ("red_black_tree pointer", sizeof(forest::red_black_tree_node <int, int>), keys, queries); });
+        benchmark::isolated([&]() { run <red_black_tree_t <true>, true> ("red_black_tree indexed", sizeof(forest::red_black_tree_node <int, int, false, false, true>), keys, queries); });
+        benchmark::isolated([&]() { run <binary_search_tree_t <false>, false> ("binary_search_tree pointer", sizeof(forest::binary_search_tree_node <int, int>), keys, queries); });
+        benchmark::isolated([&]() { run <binary_search_tree_t <true>, true> ("binary_search_tree indexed", sizeof(forest::binary_search_tree_node <int, int, true>), keys, queries); });
+        benchmark::isolated([&]() { run <splay_tree_t <false>, false> ("splay_tree pointer", sizeof(forest::splay_tree_node <int, int>), keys, queries); });
+        benchmark::isolated([&]() { run <splay_tree_t <true>, true> ("splay_tree indexed", sizeof(forest::splay_tree_node <int, int, true>), keys, queries); });
+        return 0;
+}
@@ -0,0 +1,50 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <map>
+
+template <typename tree_t>
+void run(const std::string &name, const std::vector <int> &keys, unsigned long long scans) {
+        tree_t tree;
+        for (int key : keys) {
+                tree.insert(key, key);
+        }
+        long long sum = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < scans; i++) {
+                for (const auto &node : tree) {
+                        sum += node.value;
+                }
+        }
+        benchmark::report(name, keys.size() * scans, timer.seconds());
+        benchmark::do_not_optimize(sum);
+}
+
+void run_map(const std::string &name, const std::vector <int> &keys, unsigned long long scans) {
+        std::map <int, int> tree;
+        for (int key : keys) {
+                tree.emplace(key, key);
+        }
+        long long sum = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < scans; i++) {
+                for (const auto &node : tree) {
+                        sum += node.second;
+                }
+        }
+        benchmark::report(name, keys.size() * scans, timer.seconds());
+        benchmark::do_not_optimize(sum);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long scans = benchmark::argument(argc, argv, 2, 10);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::cout << "Full scans over " << n << " random keys" << std::endl;
+        run<forest::binary_search_tree <int, int> >("binary_search_tree", keys, scans);
+        run<forest::red_black_tree <int, int> >("red_black_tree", keys, scans);
+        run<forest::splay_tree <int, int> >("splay_tree", keys, scans);
+        run_map("std::map", keys, scans);
+        return 0;
+}
@@ -0,0 +1,52 @@
+#include "benchmark.h"
+#include <forest/b_tree.h>
+#include <forest/node_search.h>
+#include <forest/red_black_tree.h>
+
+/**
+ * @brief Orders keys like std::less, but is not std::less, so b_tree searches its nodes with a binary search
+ */
+template <typename key_t>
+struct binary_search_less {
+        bool operator()(const key_t &x, const key_t &y) const {
+                return x < y;
+        }
+};
+
+template <typename tree_t, typename key_t>
+void run(const std::string &name, const std::vector <key_t> &keys, const std::vector <key_t> &queries) {
+        tree_t tree;
+        for (const key_t &key : keys) {
+                tree.insert(key, 1);
+        }
+        unsigned long long found = 0;
+        benchmark::timer timer;
+        for (const key_t &query : queries) {
+                found += tree.search(query) != nullptr;
+        }
+        benchmark::report(name + " search", queries.size(), timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+template <typename key_t>
+void run_all(const std::string &type, const std::vector <int> &shuffled, const std::vector <int> &shuffled_queries) {
+        std::vector <key_t> keys(shuffled.begin(), shuffled.end());
+        std::vector <key_t> queries(shuffled_queries.begin(), shuffled_queries.end());
+        benchmark::isolated([&]() { run <forest::red_black_tree <key_t, int> > ("red_black_tree " + type, keys, queries); });
+        benchmark::isolated([&]() { run <forest::b_tree <key_t, int, binary_search_less <key_t> > > ("b_tree binary search " + type, keys, queries); });
+        benchmark::isolated([&]() { run <forest::b_tree <key_t, int> > ("b_tree node_search " + type, keys, queries); });
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 2000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::vector <int> queries = benchmark::shuffled_keys(n, 7);
+        queries.resize(std::min(n, lookups));
+        std::cout << "node_search instruction set: " << forest::node_search_instruction_set() << std::endl;
+        run_all <std::int32_t> ("int32", keys, queries);
+        run_all <std::int64_t> ("int64", keys, queries);
+        // Every key below 2^24 is exact as a float
+        run_all <float> ("float", keys, queries);
+        return 0;
+}
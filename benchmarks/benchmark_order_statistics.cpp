@@ -0,0 +1,66 @@
+#include "benchmark.h"
+#include <forest/red_black_tree.h>
+
+typedef forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, true> order_statistic_tree;
+
+/**
+ * @brief Inserts a stream of latencies and asks for the p50 and p99 every period inserts
+ */
+void run_tree(const std::vector <int> &latencies, unsigned long long period) {
+        order_statistic_tree tree;
+        long long sum = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < latencies.size(); i++) {
+                tree.insert(latencies[i], 0);
+                if (i % period == 0) {
+                        sum += tree.select(tree.size() / 2)->key;
+                        sum += tree.select(tree.size() * 99 / 100)->key;
+                        sum += tree.rank(latencies[i]);
+                }
+        }
+        benchmark::report("red_black_tree select/rank period=" + std::to_string(period), latencies.size(), timer.seconds());
+        benchmark::do_not_optimize(sum);
+}
+
+void run_insert(const std::vector <int> &latencies) {
+        forest::red_black_tree <int, int> tree;
+        benchmark::timer timer;
+        for (int latency : latencies) {
+                tree.insert(latency, 0);
+        }
+        benchmark::report("red_black_tree insert without counts", latencies.size(), timer.seconds());
+}
+
+/**
+ * @brief Answers the same queries by sorting a snapshot of the keys seen so far
+ */
+void run_snapshot(const std::vector <int> &latencies, unsigned long long period) {
+        std::vector <int> keys;
+        std::vector <int> snapshot;
+        long long sum = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < latencies.size(); i++) {
+                keys.push_back(latencies[i]);
+                if (i % period == 0) {
+                        snapshot = keys;
+                        std::sort(snapshot.begin(), snapshot.end());
+                        sum += snapshot[snapshot.size() / 2];
+                        sum += snapshot[snapshot.size() * 99 / 100];
+                        sum += std::lower_bound(snapshot.begin(), snapshot.end(), latencies[i]) - snapshot.begin();
+                }
+        }
+        benchmark::report("sorted snapshot period=" + std::to_string(period), latencies.size(), timer.seconds());
+        benchmark::do_not_optimize(sum);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 100000);
+        std::vector <int> latencies = benchmark::shuffled_keys(n);
+        std::cout << "p50/p99/rank queries over a stream of " << n << " distinct latencies" << std::endl;
+        run_insert(latencies);
+        for (unsigned long long period : {10000ULL, 1000ULL, 100ULL}) {
+                run_tree(latencies, period);
+                run_snapshot(latencies, period);
+        }
+        return 0;
+}
@@ -0,0 +1,29 @@
+#include "benchmark.h"
+#include <forest/red_black_tree.h>
+#include <forest/pool_allocator.h>
+
+template <typename tree_t>
+void run(const std::string &name, const std::vector <int> &keys) {
+        unsigned long long rss = benchmark::resident_set_size();
+        benchmark::timer timer;
+        tree_t *tree = new tree_t;
+        for (int key : keys) {
+                tree->insert(key, key);
+        }
+        double seconds = timer.seconds();
+        benchmark::report(name + " insert", keys.size(), seconds);
+        std::cout << std::left << std::setw(48) << (name + " rss") << std::right << std::setw(12)
+                  << (benchmark::resident_set_size() - rss) / (1024 * 1024) << " MiB" << std::endl;
+        benchmark::do_not_optimize(tree->size());
+        delete tree;
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 2000000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        std::cout << "red_black_tree <int, int> with " << n << " random keys" << std::endl;
+        // The pool releases its blocks to the operating system on destruction, so it runs first
+        run<forest::red_black_tree <int, int, std::less <int>, forest::pool_allocator <int> > >("pool_allocator", keys);
+        run<forest::red_black_tree <int, int> >("std::allocator", keys);
+        return 0;
+}
@@ -0,0 +1,126 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <functional>
+#include <queue>
+#include <set>
+
+/**
+ * @brief Generates the deadlines of a scheduler: the earliest task runs and is rescheduled a random delay later
+ *
+ * The low bits hold a sequence number so that every deadline is unique.
+ */
+class deadlines {
+private:
+        std::mt19937_64 random;
+        unsigned long long sequence;
+public:
+        deadlines() : random(7), sequence(0) {
+
+        }
+        unsigned long long next(unsigned long long now) {
+                return ((now >> 24) + 1 + random() % 1000) << 24 | (sequence++ & 0xffffff);
+        }
+};
+
+template <typename tree_t>
+void run_tree(const std::string &name, unsigned long long n, unsigned long long operations) {
+        tree_t tree;
+        deadlines generator;
+        for (unsigned long long i = 0; i < n; i++) {
+                tree.insert(generator.next(0), i);
+        }
+        benchmark::timer timer;
+        unsigned long long checksum = 0;
+        for (unsigned long long i = 0; i < operations; i++) {
+                unsigned long long now = tree.minimum()->key;
+                unsigned long long task = tree.minimum()->value;
+                tree.pop_min();
+                tree.insert(generator.next(now), task);
+                checksum += task;
+        }
+        benchmark::report(name, operations, timer.seconds());
+        benchmark::do_not_optimize(checksum);
+}
+
+void run_priority_queue(unsigned long long n, unsigned long long operations) {
+        typedef std::pair <unsigned long long, unsigned long long> task_t;
+        std::priority_queue <task_t, std::vector <task_t>, std::greater <task_t> > queue;
+        deadlines generator;
+        for (unsigned long long i = 0; i < n; i++) {
+                queue.push(std::make_pair(generator.next(0), i));
+        }
+        benchmark::timer timer;
+        unsigned long long checksum = 0;
+        for (unsigned long long i = 0; i < operations; i++) {
+                task_t top = queue.top();
+                queue.pop();
+                queue.push(std::make_pair(generator.next(top.first), top.second));
+                checksum += top.second;
+        }
+        benchmark::report("std::priority_queue", operations, timer.seconds());
+        benchmark::do_not_optimize(checksum);
+}
+
+void run_set(unsigned long long n, unsigned long long operations) {
+        std::set <std::pair <unsigned long long, unsigned long long> > set;
+        deadlines generator;
+        for (unsigned long long i = 0; i < n; i++) {
+                set.insert(std::make_pair(generator.next(0), i));
+        }
+        benchmark::timer timer;
+        unsigned long long checksum = 0;
+        for (unsigned long long i = 0; i < operations; i++) {
+                std::pair <unsigned long long, unsigned long long> top = *set.begin();
+                set.erase(set.begin());
+                set.insert(std::make_pair(generator.next(top.first), top.second));
+                checksum += top.second;
+        }
+        benchmark::report("std::set", operations, timer.seconds());
+        benchmark::do_not_optimize(checksum);
+}
+
+/**
+ * @brief Compares the cached minimum with the walk down the left spine that minimum() used to do
+ */
+void run_minimum(unsigned long long n, unsigned long long operations) {
+        forest::red_black_tree <unsigned long long, unsigned long long> tree;
+        deadlines generator;
+        for (unsigned long long i = 0; i < n; i++) {
+                tree.insert(generator.next(0), i);
+        }
+        const forest::red_black_tree_node <unsigned long long, unsigned long long> *root = tree.minimum();
+        while (root->get_parent() != nullptr) root = root->get_parent();
+        benchmark::timer timer;
+        unsigned long long checksum = 0;
+        for (unsigned long long i = 0; i < operations; i++) {
+                const forest::red_black_tree_node <unsigned long long, unsigned long long> *x = root;
+                while (x->get_left() != nullptr) x = x->get_left();
+                checksum += x->value;
+                benchmark::do_not_optimize(root);
+        }
+        benchmark::report("red_black_tree left spine walk", operations, timer.seconds());
+        timer = benchmark::timer();
+        for (unsigned long long i = 0; i < operations; i++) {
+                checksum += tree.minimum()->value;
+                benchmark::do_not_optimize(tree);
+        }
+        benchmark::report("red_black_tree minimum()", operations, timer.seconds());
+        benchmark::do_not_optimize(checksum);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 100000);
+        unsigned long long operations = benchmark::argument(argc, argv, 2, 2000000);
+        std::cout << n << " pending tasks, minimum, pop and reschedule" << std::endl;
+        run_priority_queue(n, operations);
+        run_set(n, operations);
+        run_tree <forest::red_black_tree <unsigned long long, unsigned long long> > ("red_black_tree", n, operations);
+        run_tree <forest::splay_tree <unsigned long long, unsigned long long> > ("splay_tree", n, operations);
+        // Always taking the minimum and inserting above it unbalances a binary_search_tree into a right leaning list
+        run_tree <forest::binary_search_tree <unsigned long long, unsigned long long> > ("binary_search_tree, a tenth of the tasks", n / 10, operations / 10);
+        std::cout << n << " pending tasks, minimum only" << std::endl;
+        run_minimum(n, operations * 10);
+        return 0;
+}
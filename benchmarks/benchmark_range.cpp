@@ -0,0 +1,79 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <map>
+
+template <typename tree_t>
+void run(const std::string &name, tree_t &tree, unsigned long long n, unsigned long long width, unsigned long long queries) {
+        std::mt19937 random(7);
+        unsigned long long visited = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < queries; i++) {
+                int lo = static_cast<int>(random() % n);
+                tree.for_each_in_range(lo, lo + static_cast<int>(width), [&visited](const typename tree_t::const_iterator::value_type &node) {
+                        visited += node.value;
+                });
+        }
+        benchmark::report(name + " width=" + std::to_string(width), queries, timer.seconds());
+        benchmark::do_not_optimize(visited);
+}
+
+void run_map(std::map <int, int> &tree, unsigned long long n, unsigned long long width, unsigned long long queries) {
+        std::mt19937 random(7);
+        unsigned long long visited = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < queries; i++) {
+                int lo = static_cast<int>(random() % n);
+                auto end = tree.lower_bound(lo + static_cast<int>(width));
+                for (auto it = tree.lower_bound(lo); it != end; ++it) {
+                        visited += it->second;
+                }
+        }
+        benchmark::report("std::map width=" + std::to_string(width), queries, timer.seconds());
+        benchmark::do_not_optimize(visited);
+}
+
+/**
+ * @brief The range query available before lower_bound: scan every node from the minimum
+ */
+void run_full_scan(forest::red_black_tree <int, int> &tree, unsigned long long n, unsigned long long width, unsigned long long queries) {
+        std::mt19937 random(7);
+        unsigned long long visited = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < queries; i++) {
+                int lo = static_cast<int>(random() % n);
+                int hi = lo + static_cast<int>(width);
+                for (const auto &node : tree) {
+                        if (node.key >= lo && node.key < hi) visited += node.value;
+                }
+        }
+        benchmark::report("red_black_tree full scan width=" + std::to_string(width), queries, timer.seconds());
+        benchmark::do_not_optimize(visited);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long queries = benchmark::argument(argc, argv, 2, 100000);
+        std::vector <int> keys = benchmark::shuffled_keys(n);
+        forest::binary_search_tree <int, int> binary_search_tree;
+        forest::red_black_tree <int, int> red_black_tree;
+        forest::splay_tree <int, int> splay_tree;
+        std::map <int, int> map;
+        for (int key : keys) {
+                binary_search_tree.insert(key, key);
+                red_black_tree.insert(key, key);
+                splay_tree.insert(key, key);
+                map.emplace(key, key);
+        }
+        std::cout << "Range queries over " << n << " keys" << std::endl;
+        for (unsigned long long width : {10ULL, 1000ULL, 100000ULL}) {
+                unsigned long long count = std::max(1ULL, queries * 10 / width);
+                run("binary_search_tree", binary_search_tree, n, width, count);
+                run("red_black_tree", red_black_tree, n, width, count);
+                run("splay_tree", splay_tree, n, width, count);
+                run_map(map, n, width, count);
+                run_full_scan(red_black_tree, n, width, std::max(1ULL, count / 10000));
+        }
+        return 0;
+}
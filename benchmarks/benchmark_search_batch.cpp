@@ -0,0 +1,70 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/cache_oblivious_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/static_search_tree.h>
+
+/**
+ * @brief Runs the queries through search_batch in batches of the size specified and reports the time per key
+ */
+template <typename result_t, typename function_t>
+void measure(const std::string &name, const std::vector <int> &queries, std::size_t batch, function_t search_batch) {
+        std::vector <result_t> found(batch);
+        unsigned long long hits = 0;
+        benchmark::timer timer;
+        for (std::size_t first = 0; first + batch <= queries.size(); first += batch) {
+                search_batch(&queries[first], batch, found.data());
+                for (std::size_t i = 0; i < batch; i++) {
+                        hits += found[i] != nullptr;
+                }
+        }
+        benchmark::report(name + " batch " + std::to_string(batch), queries.size() / batch * batch, timer.seconds());
+        benchmark::do_not_optimize(hits);
+}
+
+void run(unsigned long long n, unsigned long long lookups) {
+        // Shuffled keys, so the nodes of the pointer based trees are scattered through memory
+        std::vector <int> keys = benchmark::shuffled_keys(n, 3);
+        forest::red_black_tree <int, int> red_black_tree;
+        forest::binary_search_tree <int, int> binary_search_tree;
+        for (int key : keys) {
+                red_black_tree.insert(key, key);
+                binary_search_tree.insert(key, key);
+        }
+        keys = std::vector <int> ();
+        forest::static_search_tree <int, int> eytzinger = red_black_tree.freeze();
+        forest::cache_oblivious_search_tree <int, int> van_emde_boas = forest::cache_oblivious_search_tree <int, int>::from_tree(red_black_tree);
+        // Queries are drawn from a range twice the size of the keys, so about half of the lookups miss
+        std::vector <int> queries = benchmark::shuffled_keys(2 * n, 7);
+        queries.resize(std::min(2 * n, lookups));
+        std::string size = std::to_string(n / 1000000) + "M";
+        for (std::size_t batch = 1; batch <= 256; batch *= 2) {
+                measure<forest::red_black_tree_node <int, int> *>("red_black_tree " + size, queries, batch, [&](const int *first, std::size_t count, forest::red_black_tree_node <int, int> **out) {
+                        red_black_tree.search_batch(first, count, out);
+                });
+        }
+        for (std::size_t batch = 1; batch <= 256; batch *= 2) {
+                measure<forest::binary_search_tree_node <int, int> *>("binary_search_tree " + size, queries, batch, [&](const int *first, std::size_t count, forest::binary_search_tree_node <int, int> **out) {
+                        binary_search_tree.search_batch(first, count, out);
+                });
+        }
+        for (std::size_t batch = 1; batch <= 256; batch *= 2) {
+                measure<const int *>("static_search_tree " + size, queries, batch, [&](const int *first, std::size_t count, const int **out) {
+                        eytzinger.search_batch(first, count, out);
+                });
+        }
+        for (std::size_t batch = 1; batch <= 256; batch *= 2) {
+                measure<const forest::cache_oblivious_search_tree_element <int, int> *>("cache_oblivious_search_tree " + size, queries, batch, [&](const int *first, std::size_t count, const forest::cache_oblivious_search_tree_element <int, int> **out) {
+                        van_emde_boas.search_batch(first, count, out);
+                });
+        }
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long largest = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 1000000);
+        for (unsigned long long n = 1000000; n <= largest; n *= 10) {
+                benchmark::isolated([&]() { run(n, lookups); });
+        }
+        return 0;
+}
@@ -0,0 +1,28 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+
+template <typename tree_t>
+void run(const std::string &name, unsigned long long n, unsigned long long calls) {
+        tree_t tree;
+        for (int key : benchmark::shuffled_keys(n)) {
+                tree.insert(key, key);
+        }
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < calls; i++) {
+                benchmark::do_not_optimize(tree.size());
+        }
+        benchmark::report(name + " size() n=" + std::to_string(n), calls, timer.seconds());
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long calls = benchmark::argument(argc, argv, 2, 10000000);
+        for (unsigned long long m = 1000; m <= n; m *= 10) {
+                run<forest::binary_search_tree <int, int> >("binary_search_tree", m, calls);
+                run<forest::red_black_tree <int, int> >("red_black_tree", m, calls);
+                run<forest::splay_tree <int, int> >("splay_tree", m, calls);
+        }
+        return 0;
+}
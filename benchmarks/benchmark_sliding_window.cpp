@@ -0,0 +1,61 @@
+#include "benchmark.h"
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <map>
+
+struct splay_tree_adapter {
+        forest::splay_tree <int, int> tree;
+        void insert(int key) { tree.insert(key, key); }
+        void erase(int key) { tree.erase(key); }
+        bool search(int key) { return tree.search(key) != nullptr; }
+};
+
+struct red_black_tree_adapter {
+        forest::red_black_tree <int, int> tree;
+        void insert(int key) { tree.insert(key, key); }
+        void erase(int key) { tree.erase(key); }
+        bool search(int key) { return tree.search(key) != nullptr; }
+};
+
+struct map_adapter {
+        std::map <int, int> tree;
+        void insert(int key) { tree.emplace(key, key); }
+        void erase(int key) { tree.erase(key); }
+        bool search(int key) { return tree.find(key) != tree.end(); }
+};
+
+/**
+ * @brief Keeps the most recent window keys of an increasing stream, like a cache evicting its oldest entries
+ *
+ * Every step inserts the next key, erases the key that falls out of the window and looks up
+ * a few keys that are skewed towards the most recent ones.
+ */
+template <typename adapter_t>
+void run(const std::string &name, unsigned long long window, unsigned long long steps) {
+        adapter_t adapter;
+        std::mt19937 random(7);
+        std::geometric_distribution <int> age(0.01);
+        unsigned long long found = 0;
+        benchmark::timer timer;
+        for (unsigned long long i = 0; i < steps; i++) {
+                int key = static_cast<int>(i);
+                adapter.insert(key);
+                if (i >= window) adapter.erase(static_cast<int>(i - window));
+                for (int j = 0; j < 4; j++) {
+                        found += adapter.search(key - age(random));
+                }
+        }
+        benchmark::report(name + " window=" + std::to_string(window), steps, timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long steps = benchmark::argument(argc, argv, 1, 2000000);
+        std::cout << "Sliding window of insert, erase and 4 recent lookups per step" << std::endl;
+        for (unsigned long long window = 1000; window <= 1000000; window *= 10) {
+                run<splay_tree_adapter>("splay_tree", window, steps);
+                run<red_black_tree_adapter>("red_black_tree", window, steps);
+                run<map_adapter>("std::map", window, steps);
+        }
+        return 0;
+}
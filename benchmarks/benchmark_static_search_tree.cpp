@@ -0,0 +1,43 @@
+#include "benchmark.h"
+#include <forest/red_black_tree.h>
+#include <forest/static_search_tree.h>
+
+void run(unsigned long long n, unsigned long long lookups) {
+        std::vector <std::pair <int, int> > pairs;
+        pairs.reserve(n);
+        for (unsigned long long i = 0; i < n; i++) {
+                pairs.emplace_back(static_cast<int>(i), static_cast<int>(i));
+        }
+        forest::red_black_tree <int, int> tree = forest::red_black_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+        pairs = std::vector <std::pair <int, int> > ();
+        // Queries are drawn from a range twice the size of the keys, so about half of the lookups miss
+        std::vector <int> queries = benchmark::shuffled_keys(2 * n, 7);
+        queries.resize(std::min(2 * n, lookups));
+        std::string size = std::to_string(n / 1000000) + "M";
+        unsigned long long found = 0;
+        benchmark::timer timer;
+        for (int query : queries) {
+                found += tree.search(query) != nullptr;
+        }
+        benchmark::report("red_black_tree search " + size, queries.size(), timer.seconds());
+        timer = benchmark::timer();
+        forest::static_search_tree <int, int> frozen = tree.freeze();
+        benchmark::report("freeze " + size, n, timer.seconds());
+        tree.clear();
+        timer = benchmark::timer();
+        for (int query : queries) {
+                found += frozen.search(query) != nullptr;
+        }
+        benchmark::report("static_search_tree search " + size, queries.size(), timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long largest = benchmark::argument(argc, argv, 1, 10000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        // 1M, 10M and on up to the largest size, pass 100000000 for 100M keys given enough memory
+        for (unsigned long long n = 1000000; n <= largest; n *= 10) {
+                benchmark::isolated([&]() { run(n, lookups); });
+        }
+        return 0;
+}
@@ -0,0 +1,115 @@
+#include "benchmark.h"
+#include <forest/red_black_tree.h>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief The search loop used before the comparator parameter: up to two comparisons per level
+ */
+template <typename node_t>
+const node_t *legacy_search(const node_t *x, const std::string &key, unsigned long long &comparisons) {
+        while (x != nullptr) {
+                comparisons++;
+                if (key > x->key) {
+                        x = x->get_right();
+                        continue;
+                }
+                comparisons++;
+                if (key < x->key) {
+                        x = x->get_left();
+                } else {
+                        return x;
+                }
+        }
+        return nullptr;
+}
+
+/**
+ * @brief A transparent comparator that counts how often it is called
+ */
+struct counting_less {
+        typedef void is_transparent;
+        static unsigned long long comparisons;
+        template <typename a_t, typename b_t>
+        bool operator()(const a_t &a, const b_t &b) const {
+                comparisons++;
+                return std::less <>()(a, b);
+        }
+};
+
+unsigned long long counting_less::comparisons = 0;
+
+template <typename tree_t, typename query_t>
+void run(const std::string &name, tree_t &tree, const std::vector <query_t> &queries) {
+        unsigned long long found = 0;
+        benchmark::timer timer;
+        for (const query_t &query : queries) {
+                found += tree.search(query) != nullptr;
+        }
+        benchmark::report(name, queries.size(), timer.seconds());
+        benchmark::do_not_optimize(found);
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long lookups = benchmark::argument(argc, argv, 2, 2000000);
+        std::vector <std::string> keys;
+        for (int key : benchmark::shuffled_keys(n)) {
+                char buffer[64];
+                // A long common prefix makes every comparison walk a few cache lines of characters
+                std::snprintf(buffer, sizeof(buffer), "/var/log/service/events/%012d", key);
+                keys.push_back(buffer);
+        }
+        forest::red_black_tree <std::string, int, std::less <> > tree;
+        for (unsigned long long i = 0; i < n; i++) {
+                tree.insert(keys[i], static_cast<int>(i));
+        }
+        std::vector <std::string> strings;
+        std::vector <const char *> pointers;
+        std::vector <std::string_view> views;
+        std::mt19937 random(7);
+        for (unsigned long long i = 0; i < lookups; i++) {
+                strings.push_back(keys[random() % n]);
+        }
+        for (const std::string &key : strings) {
+                pointers.push_back(key.c_str());
+                views.push_back(key);
+        }
+        const forest::red_black_tree_node <std::string, int> *root = tree.minimum();
+        while (root->get_parent() != nullptr) root = root->get_parent();
+        std::cout << "Lookups of " << lookups << " string keys in a tree of " << n << std::endl;
+        unsigned long long comparisons = 0;
+        {
+                unsigned long long found = 0;
+                benchmark::timer timer;
+                for (const std::string &query : strings) {
+                        found += legacy_search(root, query, comparisons) != nullptr;
+                }
+                benchmark::report("two comparisons per level (before)", lookups, timer.seconds());
+                benchmark::do_not_optimize(found);
+        }
+        {
+                unsigned long long found = 0;
+                benchmark::timer timer;
+                for (const char *query : pointers) {
+                        found += legacy_search(root, std::string(query), comparisons) != nullptr;
+                }
+                benchmark::report("two comparisons, temporary std::string", lookups, timer.seconds());
+                benchmark::do_not_optimize(found);
+        }
+        run("search(std::string)", tree, strings);
+        run("search(const char *)", tree, pointers);
+        run("search(std::string_view)", tree, views);
+        forest::red_black_tree <std::string, int, counting_less> counted;
+        for (unsigned long long i = 0; i < n; i++) {
+                counted.insert(keys[i], static_cast<int>(i));
+        }
+        counting_less::comparisons = 0;
+        for (const std::string_view &query : views) {
+                benchmark::do_not_optimize(counted.search(query));
+        }
+        std::cout << "comparisons per lookup: before " << std::setprecision(2) << static_cast<double>(comparisons) / (2 * lookups)
+                  << ", after " << static_cast<double>(counting_less::comparisons) / lookups << std::endl;
+        return 0;
+}
@@ -0,0 +1,34 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+
+template <typename tree_t>
+void run(const std::string &name, const std::vector <int> &keys) {
+        tree_t *tree = new tree_t;
+        for (int key : keys) {
+                tree->insert(key, key);
+        }
+        benchmark::timer timer;
+        delete tree;
+        benchmark::report(name, keys.size(), timer.seconds());
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long n = benchmark::argument(argc, argv, 1, 1000000);
+        unsigned long long m = benchmark::argument(argc, argv, 2, 20000);
+        std::vector <int> random = benchmark::shuffled_keys(n);
+        std::vector <int> ascending(n);
+        for (unsigned long long i = 0; i < n; i++) ascending[i] = static_cast<int>(i);
+        std::cout << "Teardown of trees with " << n << " nodes" << std::endl;
+        run<forest::binary_search_tree <int, int> >("binary_search_tree random", random);
+        run<forest::red_black_tree <int, int> >("red_black_tree random", random);
+        run<forest::red_black_tree <int, int> >("red_black_tree ascending", ascending);
+        run<forest::splay_tree <int, int> >("splay_tree random", random);
+        // Ascending inserts leave the splay tree as a single left leaning path
+        run<forest::splay_tree <int, int> >("splay_tree degenerate", ascending);
+        // Building a degenerate binary search tree is quadratic, so it uses a smaller size
+        ascending.resize(std::min(n, m));
+        run<forest::binary_search_tree <int, int> >("binary_search_tree degenerate (" + std::to_string(ascending.size()) + ")", ascending);
+        return 0;
+}
@@ -0,0 +1,86 @@
+#include "benchmark.h"
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+/**
+ * @brief Draws words from a Zipf distribution over a fixed vocabulary, like the tokens of natural text
+ */
+std::vector <std::string> zipf_words(unsigned long long vocabulary, unsigned long long n) {
+        std::vector <std::string> words;
+        for (int key : benchmark::shuffled_keys(vocabulary)) {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "word%d", key);
+                words.push_back(buffer);
+        }
+        std::vector <double> cumulative(vocabulary);
+        double sum = 0;
+        for (unsigned long long i = 0; i < vocabulary; i++) {
+                sum += 1.0 / static_cast<double>(i + 1);
+                cumulative[i] = sum;
+        }
+        std::mt19937 random(7);
+        std::uniform_real_distribution <double> distribution(0, sum);
+        std::vector <std::string> tokens;
+        tokens.reserve(n);
+        for (unsigned long long i = 0; i < n; i++) {
+                unsigned long long rank = std::lower_bound(cumulative.begin(), cumulative.end(), distribution(random)) - cumulative.begin();
+                tokens.push_back(words[std::min(rank, vocabulary - 1)]);
+        }
+        return tokens;
+}
+
+/**
+ * @brief Counts with a search followed by an insert of the missing words, two descents per new word
+ */
+template <typename tree_t>
+void run_search_insert(const std::string &name, const std::vector <std::string> &tokens) {
+        tree_t tree;
+        benchmark::timer timer;
+        for (const std::string &token : tokens) {
+                auto x = tree.search(token);
+                if (x != nullptr) {
+                        x->value++;
+                } else {
+                        tree.insert(token, 1);
+                }
+        }
+        benchmark::report(name, tokens.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+template <typename tree_t>
+void run_upsert(const std::string &name, const std::vector <std::string> &tokens) {
+        tree_t tree;
+        benchmark::timer timer;
+        for (const std::string &token : tokens) {
+                tree.upsert(token, [](int &count) { count++; });
+        }
+        benchmark::report(name, tokens.size(), timer.seconds());
+        benchmark::do_not_optimize(tree.size());
+}
+
+int main(int argc, char const *argv[]) {
+        unsigned long long vocabulary = benchmark::argument(argc, argv, 1, 100000);
+        unsigned long long n = benchmark::argument(argc, argv, 2, 2000000);
+        std::vector <std::string> tokens = zipf_words(vocabulary, n);
+        {
+                std::map <std::string, int> map;
+                benchmark::timer timer;
+                for (const std::string &token : tokens) {
+                        map[token]++;
+                }
+                benchmark::report("std::map operator[]", tokens.size(), timer.seconds());
+                benchmark::do_not_optimize(map.size());
+        }
+        run_search_insert <forest::red_black_tree <std::string, int> > ("red_black_tree search + insert", tokens);
+        run_upsert <forest::red_black_tree <std::string, int> > ("red_black_tree upsert", tokens);
+        run_search_insert <forest::splay_tree <std::string, int> > ("splay_tree search + insert", tokens);
+        run_upsert <forest::splay_tree <std::string, int> > ("splay_tree upsert", tokens);
+        run_search_insert <forest::binary_search_tree <std::string, int> > ("binary_search_tree search + insert", tokens);
+        run_upsert <forest::binary_search_tree <std::string, int> > ("binary_search_tree upsert", tokens);
+        return 0;
+}
@@ -0,0 +1,60 @@
+#include <forest/b_tree.h>
+#include <iostream>
+
+int main(int argc, char const *argv[]) {
+        forest::b_tree <int, int> b_tree;
+
+        b_tree.insert(4,0);
+        b_tree.insert(2,0);
+        b_tree.insert(90,0);
+        b_tree.insert(3,100);
+        b_tree.insert(0,0);
+        b_tree.insert(14,0);
+        b_tree.insert(45,0);
+
+        std::cout << "Pre Order Traversal" << std::endl;
+        std::cout << std::endl;
+        b_tree.pre_order_traversal();
+        std::cout << std::endl;
+
+        std::cout << "In Order Traversal" << std::endl;
+        std::cout << std::endl;
+        b_tree.in_order_traversal();
+        std::cout << std::endl;
+
+        std::cout << "Post Order Traversal" << std::endl;
+        std::cout << std::endl;
+        b_tree.post_order_traversal();
+        std::cout << std::endl;
+
+        std::cout << "Breadth First Traversal" << std::endl;
+        std::cout << std::endl;
+        b_tree.breadth_first_traversal();
+        std::cout << std::endl;
+
+        auto min = b_tree.minimum();
+        if (min != nullptr) {
+                std::cout << "Minimum: " << min->key << std::endl;
+        }
+
+        auto max = b_tree.maximum();
+        if (max != nullptr) {
+                std::cout << "Maximum: " << max->key << std::endl;
+        }
+
+        std::cout << "Height: " << b_tree.height() << std::endl;
+
+        std::cout << "Size: " << b_tree.size() << std::endl;
+
+        std::cout << "Empty: " << (b_tree.empty() ? "yes" : "no") << std::endl;
+
+        auto n = b_tree.search(3);
+        if (n != nullptr) {
+                std::cout << std::endl;
+                std::cout << "Found key 3 with value " << n->value << std::endl;
+        }
+
+        b_tree.graphviz("b_tree.dot");
+
+        return 0;
+}
@@ -0,0 +1,60 @@
+#include <forest/bplus_tree.h>
+#include <iostream>
+
+int main(int argc, char const *argv[]) {
+        forest::bplus_tree <int, int> bplus_tree;
+
+        bplus_tree.insert(4,0);
+        bplus_tree.insert(2,0);
+        bplus_tree.insert(90,0);
+        bplus_tree.insert(3,100);
+        bplus_tree.insert(0,0);
+        bplus_tree.insert(14,0);
+        bplus_tree.insert(45,0);
+
+        std::cout << "Pre Order Traversal" << std::endl;
+        std::cout << std::endl;
+        bplus_tree.pre_order_traversal();
+        std::cout << std::endl;
+
+        std::cout << "In Order Traversal" << std::endl;
+        std::cout << std::endl;
+        bplus_tree.in_order_traversal();
+        std::cout << std::endl;
+
+        std::cout << "Post Order Traversal" << std::endl;
+        std::cout << std::endl;
+        bplus_tree.post_order_traversal();
+        std::cout << std::endl;
+
+        std::cout << "Breadth First Traversal" << std::endl;
+        std::cout << std::endl;
+        bplus_tree.breadth_first_traversal();
+        std::cout << std::endl;
+
+        auto min = bplus_tree.minimum();
+        if (min != nullptr) {
+                std::cout << "Minimum: " << min->key << std::endl;
+        }
+
+        auto max = bplus_tree.maximum();
+        if (max != nullptr) {
+                std::cout << "Maximum: " << max->key << std::endl;
+        }
+
+        std::cout << "Height: " << bplus_tree.height() << std::endl;
+
+        std::cout << "Size: " << bplus_tree.size() << std::endl;
+
+        std::cout << "Empty: " << (bplus_tree.empty() ? "yes" : "no") << std::endl;
+
+        auto n = bplus_tree.search(3);
+        if (n != nullptr) {
+                std::cout << std::endl;
+                std::cout << "Found key 3 with value " << n->value << std::endl;
+        }
+
+        bplus_tree.graphviz("bplus_tree.dot");
+
+        return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file async_search.h
+ * @brief Interleaved searches of binary trees written as C++20 coroutines
+ *
+ * Everything here is only defined when the compiler supports coroutines, which
+ * FOREST_ASYNC_SEARCH tells. The rest of the library needs nothing newer than C++11.
+ */
+
+#ifndef ASYNC_SEARCH_H
+#define ASYNC_SEARCH_H
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define FOREST_ASYNC_SEARCH 1
+#endif
+#endif
+
+#if defined(FOREST_ASYNC_SEARCH)
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "prefetch.h"
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief A search suspended at a node, owning its coroutine
+         * @tparam node_t The node type, const for searches that do not change the tree
+         */
+        template <typename node_t>
+        class search_task {
+        public:
+                struct promise_type {
+                        node_t *result = nullptr;
+                        /**
+                         * @brief Takes the frame of a search from the frames of finished searches of the thread, if any
+                         *
+                         * The frames of one kind of search all have the same size, and a scheduler
+                         * starts a search whenever one finishes, so a frame is almost always at hand.
+                         */
+                        static void *operator new(std::size_t size) {
+                                frame *&free = free_frames();
+                                if (free != nullptr && free->size == size) {
+                                        frame *x = free;
+                                        free = x->next;
+                                        return x;
+                                }
+                                return ::operator new(size < sizeof(frame) ? sizeof(frame) : size);
+                        }
+                        static void operator delete(void *address, std::size_t size) {
+                                frame *x = static_cast<frame *>(address);
+                                x->size = size;
+                                x->next = free_frames();
+                                free_frames() = x;
+                        }
+                        search_task get_return_object() {
+                                return search_task(std::coroutine_handle <promise_type>::from_promise(*this));
+                        }
+                        std::suspend_always initial_suspend() noexcept {
+                                return {};
+                        }
+                        std::suspend_always final_suspend() noexcept {
+                                return {};
+                        }
+                        void return_value(node_t *x) {
+                                result = x;
+                        }
+                        void unhandled_exception() {
+                                throw;
+                        }
+                };
+        private:
+                struct frame {
+                        frame *next;
+                        std::size_t size;
+                };
+                /**
+                 * @brief The frames of finished searches of a thread, freed when the thread exits
+                 */
+                struct frame_list {
+                        frame *first = nullptr;
+                        ~frame_list() {
+                                while (first != nullptr) {
+                                        frame *x = first;
+                                        first = x->next;
+                                        ::operator delete(x);
+                                }
+                        }
+                };
+                static frame *&free_frames() {
+                        thread_local frame_list frames;
+                        return frames.first;
+                }
+                std::coroutine_handle <promise_type> handle;
+                explicit search_task(std::coroutine_handle <promise_type> handle) : handle(handle) {
+
+                }
+        public:
+                search_task() : handle(nullptr) {
+
+                }
+                search_task(const search_task &) = delete;
+                search_task &operator=(const search_task &) = delete;
+                search_task(search_task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {
+
+                }
+                search_task &operator=(search_task &&other) noexcept {
+                        if (this != &other) {
+                                if (handle) handle.destroy();
+                                handle = std::exchange(other.handle, nullptr);
+                        }
+                        return *this;
+                }
+                ~search_task() {
+                        if (handle) handle.destroy();
+                }
+                /**
+                 * @brief Checks whether the task holds a search
+                 */
+                explicit operator bool() const {
+                        return static_cast<bool>(handle);
+                }
+                /**
+                 * @brief Checks whether the search has found its node, or that there is none
+                 */
+                bool done() const {
+                        return handle.done();
+                }
+                /**
+                 * @brief Runs the search until it reaches the next node or finishes
+                 */
+                void resume() {
+                        handle.resume();
+                }
+                /**
+                 * @brief Returns the node found by a finished search
+                 * @return The node with the key searched for, or nullptr
+                 */
+                node_t *result() const {
+                        return handle.promise().result;
+                }
+        };
+        /**
+         * @brief Suspends a search after asking for the cache line of the node it goes to next
+         */
+        struct prefetch_awaiter {
+                const void *address;
+                bool await_ready() const noexcept {
+                        return false;
+                }
+                void await_suspend(std::coroutine_handle <>) const noexcept {
+                        prefetch(address);
+                }
+                void await_resume() const noexcept {
+
+                }
+        };
+        /**
+         * @brief Searches for a key below a node, suspending at every node it moves to
+         *
+         * The search is the one of the trees themselves, except that before reading a node it
+         * prefetches it and yields, so a scheduler can run other searches while the node loads.
+         * The key is held by reference and must outlive the search.
+         * @param x The root of the tree, or of the subtree, to search
+         * @param key The key to search for
+         * @param compare The strict weak ordering of the tree
+         * @return The task of the search, which starts suspended
+         */
+        template <typename node_t, typename other_t, typename compare_t>
+        search_task <node_t> async_search(node_t *x, const other_t &key, compare_t compare) {
+                node_t *y = nullptr;
+                while (x != nullptr) {
+                        if (compare(x->key, key)) {
+                                x = x->get_right();
+                        } else {
+                                y = x;
+                                x = x->get_left();
+                        }
+                        if (x != nullptr) co_await prefetch_awaiter{x};
+                }
+                co_return y != nullptr && !compare(key, y->key) ? y : nullptr;
+        }
+        static const std::size_t async_search_lanes = 16; ///< The default number of searches interleaved_search keeps in flight
+        /**
+         * @brief Searches a tree for several keys, switching between searches whenever one waits for memory
+         *
+         * Up to lanes searches are in flight and resumed in turn, each going one level down;
+         * when one finishes, the next key takes its lane. Works with the trees that expose
+         * root_node(), i.e. red_black_tree, binary_search_tree and splay_tree.
+         * @param tree The tree to search
+         * @param keys The keys to search for
+         * @param n The number of keys
+         * @param out Set to the node with each key, or nullptr
+         * @param lanes The number of searches in flight
+         * @return void
+         */
+        template <typename tree_t, typename key_t, typename node_t>
+        void interleaved_search(const tree_t &tree, const key_t *keys, std::size_t n, node_t **out, std::size_t lanes = async_search_lanes) {
+                node_t *root = tree.root_node();
+                if (lanes == 0) lanes = 1;
+                std::vector <search_task <node_t> > tasks(lanes < n ? lanes : n);
+                std::vector <std::size_t> slots(tasks.size());
+                std::size_t next = 0;
+                for (std::size_t i = 0; i < tasks.size(); i++) {
+                        tasks[i] = async_search(root, keys[next], tree.key_comp());
+                        slots[i] = next++;
+                }
+                for (std::size_t running = tasks.size(); running > 0;) {
+                        for (std::size_t i = 0; i < tasks.size(); i++) {
+                                if (!tasks[i]) continue;
+                                tasks[i].resume();
+                                if (!tasks[i].done()) continue;
+                                out[slots[i]] = tasks[i].result();
+                                if (next < n) {
+                                        tasks[i] = async_search(root, keys[next], tree.key_comp());
+                                        slots[i] = next++;
+                                } else {
+                                        tasks[i] = search_task <node_t> ();
+                                        running--;
+                                }
+                        }
+                }
+        }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,1095 @@
+/**
+ * @file b_tree.h
+ */
+
+#ifndef B_TREE_H
+#define B_TREE_H
+
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <queue>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "node_search.h"
+#include "static_search_tree.h"
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief The default number of keys per node of a b_tree, enough to fill four cache lines with keys
+         */
+        template <typename key_t>
+        struct b_tree_capacity : std::integral_constant <std::size_t, (256 / sizeof(key_t) < 3 ? 3 : 256 / sizeof(key_t))> {
+
+        };
+        /**
+         * @brief A b tree leaf node, the base of every b tree node
+         *
+         * The keys of a node are kept apart from its values, so the keys compared during a search
+         * are packed into as few cache lines as possible. Slots past count hold no objects.
+         * @tparam capacity The maximum number of keys per node
+         */
+        template <typename key_t, typename value_t, std::size_t capacity>
+        struct b_tree_node {
+                std::uint16_t count;    ///< The number of keys of the node
+                std::uint16_t position; ///< The index of the node among the children of its parent
+                bool leaf;              ///< Whether the node has no children
+                b_tree_node *parent;    ///< A pointer to the parent of the node
+                typename std::aligned_storage <sizeof(key_t), alignof(key_t)>::type key_slots[capacity];       ///< The sorted keys of the node
+                typename std::aligned_storage <sizeof(value_t), alignof(value_t)>::type value_slots[capacity]; ///< The values of the node
+                explicit b_tree_node(bool leaf) : count(0), position(0), leaf(leaf), parent(nullptr) {
+
+                }
+                key_t *keys() {
+                        return reinterpret_cast<key_t *>(key_slots);
+                }
+                const key_t *keys() const {
+                        return reinterpret_cast<const key_t *>(key_slots);
+                }
+                key_t &key(std::size_t i) {
+                        return keys()[i];
+                }
+                const key_t &key(std::size_t i) const {
+                        return keys()[i];
+                }
+                value_t &value(std::size_t i) {
+                        return reinterpret_cast<value_t *>(value_slots)[i];
+                }
+                const value_t &value(std::size_t i) const {
+                        return reinterpret_cast<const value_t *>(value_slots)[i];
+                }
+                /**
+                 * @brief Constructs the element of an empty slot
+                 */
+                void construct(std::size_t i, key_t &&key, value_t &&value) {
+                        ::new (static_cast<void *>(&key_slots[i])) key_t(std::move(key));
+                        ::new (static_cast<void *>(&value_slots[i])) value_t(std::move(value));
+                }
+                /**
+                 * @brief Destroys the element of a slot, leaving the slot empty
+                 */
+                void destroy(std::size_t i) {
+                        key(i).~key_t();
+                        value(i).~value_t();
+                }
+                /**
+                 * @brief Moves the element of slot i into the empty slot j of a node, leaving slot i empty
+                 */
+                void move(std::size_t i, b_tree_node *x, std::size_t j) {
+                        x->construct(j, std::move(key(i)), std::move(value(i)));
+                        destroy(i);
+                }
+                /**
+                 * @brief Prints to the std::cout the keys of the node
+                 */
+                void info() const {
+                        for (std::size_t i = 0; i < count; i++) {
+                                std::cout << key(i) << (i + 1 < count ? "\t" : "");
+                        }
+                        std::cout << std::endl;
+                }
+        };
+        /**
+         * @brief A b tree internal node, which adds the children to a leaf node
+         */
+        template <typename key_t, typename value_t, std::size_t capacity>
+        struct b_tree_internal_node : b_tree_node <key_t, value_t, capacity> {
+                b_tree_node <key_t, value_t, capacity> *children[capacity + 1]; ///< The children of the node, child i holds the keys less than key i
+                b_tree_internal_node() : b_tree_node <key_t, value_t, capacity> (false) {
+
+                }
+                static b_tree_node <key_t, value_t, capacity> *child(const b_tree_node <key_t, value_t, capacity> *x, std::size_t i) {
+                        return static_cast<const b_tree_internal_node *>(x)->children[i];
+                }
+        };
+        /**
+         * @brief A reference to an element of a b tree, with the members of a tree node
+         * @tparam value_t The value type, const for a constant reference
+         */
+        template <typename key_t, typename value_t>
+        struct b_tree_reference {
+                const key_t &key; ///< The key of the element
+                value_t &value;   ///< The value of the element
+        };
+        /**
+         * @brief A nullable pointer to an element of a b tree
+         *
+         * Elements of a b tree have no node of their own, so search and friends return this
+         * in place of a node pointer: it compares to nullptr and x->key and x->value work as
+         * they do for the other trees. Inserting or erasing moves elements between slots, so
+         * like a std::vector iterator it is invalidated by any change to the tree.
+         * @tparam value_t The value type, const for a pointer to a constant element
+         */
+        template <typename key_t, typename value_t>
+        class b_tree_pointer {
+        private:
+                typename std::aligned_storage <sizeof(b_tree_reference <key_t, value_t>), alignof(b_tree_reference <key_t, value_t>)>::type storage;
+                bool null;
+                void assign(const key_t &key, value_t &value) {
+                        ::new (static_cast<void *>(&storage)) b_tree_reference <key_t, value_t> {key, value};
+                        null = false;
+                }
+        public:
+                b_tree_pointer() {
+                        null = true;
+                }
+                b_tree_pointer(std::nullptr_t) {
+                        null = true;
+                }
+                b_tree_pointer(const key_t &key, value_t &value) {
+                        assign(key, value);
+                }
+                b_tree_pointer(const b_tree_pointer &other) {
+                        null = true;
+                        if (!other.null) assign(other->key, other->value);
+                }
+                /**
+                 * @brief Converts a pointer to a mutable element into a pointer to a constant one
+                 */
+                template <typename other_t, typename = typename std::enable_if <std::is_const <value_t>::value && !std::is_const <other_t>::value>::type>
+                b_tree_pointer(const b_tree_pointer <key_t, other_t> &other) {
+                        null = true;
+                        if (other != nullptr) assign(other->key, other->value);
+                }
+                b_tree_pointer &operator=(const b_tree_pointer &other) {
+                        null = true;
+                        if (!other.null) assign(other->key, other->value);
+                        return *this;
+                }
+                const b_tree_reference <key_t, value_t> *operator->() const {
+                        return reinterpret_cast<const b_tree_reference <key_t, value_t> *>(&storage);
+                }
+                b_tree_reference <key_t, value_t> operator*() const {
+                        return *operator->();
+                }
+                explicit operator bool() const {
+                        return !null;
+                }
+                bool operator==(std::nullptr_t) const {
+                        return null;
+                }
+                bool operator!=(std::nullptr_t) const {
+                        return !null;
+                }
+                template <typename other_t>
+                bool operator==(const b_tree_pointer <key_t, other_t> &other) const {
+                        if (null || other == nullptr) return null && other == nullptr;
+                        return &(*this)->key == &other->key;
+                }
+                template <typename other_t>
+                bool operator!=(const b_tree_pointer <key_t, other_t> &other) const {
+                        return !(*this == other);
+                }
+        };
+        template <typename, typename, typename, std::size_t> class b_tree;
+        /**
+         * @brief A bidirectional iterator over the elements of a b tree in key order
+         *
+         * An iterator is a node and the index of a key in it. Dereferencing yields a
+         * b_tree_reference, whose key must not be modified.
+         * @tparam reference_t value_t for a mutable iterator and const value_t for a constant one
+         */
+        template <typename key_t, typename value_t, std::size_t capacity, typename reference_t>
+        class b_tree_iterator {
+        private:
+                template <typename, typename, std::size_t, typename> friend class b_tree_iterator;
+                template <typename, typename, typename, std::size_t> friend class b_tree;
+                b_tree_node <key_t, value_t, capacity> *node;
+                std::size_t index;
+                b_tree_node <key_t, value_t, capacity> *const *root;
+        public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef b_tree_reference <key_t, reference_t> value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef b_tree_pointer <key_t, reference_t> pointer;
+                typedef b_tree_reference <key_t, reference_t> reference;
+                /**
+                 * @brief Finds the leaf with the minimum key of the subtree rooted at x
+                 */
+                static b_tree_node <key_t, value_t, capacity> *minimum(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return nullptr;
+                        while (!x->leaf) x = b_tree_internal_node <key_t, value_t, capacity>::child(x, 0);
+                        return x;
+                }
+                /**
+                 * @brief Finds the leaf with the maximum key of the subtree rooted at x
+                 */
+                static b_tree_node <key_t, value_t, capacity> *maximum(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return nullptr;
+                        while (!x->leaf) x = b_tree_internal_node <key_t, value_t, capacity>::child(x, x->count);
+                        return x;
+                }
+                /**
+                 * @brief Moves x and i to the next key in order, or x to nullptr past the maximum
+                 */
+                static void successor(b_tree_node <key_t, value_t, capacity> *&x, std::size_t &i) {
+                        if (!x->leaf) {
+                                x = minimum(b_tree_internal_node <key_t, value_t, capacity>::child(x, i + 1));
+                                i = 0;
+                                return;
+                        }
+                        i++;
+                        while (i == x->count && x->parent != nullptr) {
+                                i = x->position;
+                                x = x->parent;
+                        }
+                        if (i == x->count) {
+                                x = nullptr;
+                                i = 0;
+                        }
+                }
+                /**
+                 * @brief Moves x and i to the previous key in order, or x to nullptr before the minimum
+                 */
+                static void predecessor(b_tree_node <key_t, value_t, capacity> *&x, std::size_t &i) {
+                        if (!x->leaf) {
+                                x = maximum(b_tree_internal_node <key_t, value_t, capacity>::child(x, i));
+                                i = x->count - 1;
+                                return;
+                        }
+                        while (i == 0 && x->parent != nullptr) {
+                                i = x->position;
+                                x = x->parent;
+                        }
+                        if (i == 0) {
+                                x = nullptr;
+                        } else {
+                                i--;
+                        }
+                }
+                b_tree_iterator() {
+                        node = nullptr;
+                        index = 0;
+                        root = nullptr;
+                }
+                b_tree_iterator(b_tree_node <key_t, value_t, capacity> *node, std::size_t index, b_tree_node <key_t, value_t, capacity> *const *root) {
+                        this->node = node;
+                        this->index = index;
+                        this->root = root;
+                }
+                /**
+                 * @brief Converts a mutable iterator into a constant one
+                 */
+                template <typename other_t, typename = typename std::enable_if <std::is_const <reference_t>::value && !std::is_const <other_t>::value>::type>
+                b_tree_iterator(const b_tree_iterator <key_t, value_t, capacity, other_t> &other) {
+                        node = other.node;
+                        index = other.index;
+                        root = other.root;
+                }
+                reference operator*() const {
+                        return reference {node->key(index), node->value(index)};
+                }
+                pointer operator->() const {
+                        return pointer(node->key(index), node->value(index));
+                }
+                b_tree_iterator &operator++() {
+                        successor(node, index);
+                        return *this;
+                }
+                b_tree_iterator operator++(int) {
+                        b_tree_iterator x = *this;
+                        ++(*this);
+                        return x;
+                }
+                b_tree_iterator &operator--() {
+                        if (node == nullptr) {
+                                node = maximum(*root);
+                                index = node->count - 1;
+                        } else {
+                                predecessor(node, index);
+                        }
+                        return *this;
+                }
+                b_tree_iterator operator--(int) {
+                        b_tree_iterator x = *this;
+                        --(*this);
+                        return x;
+                }
+                template <typename other_t>
+                bool operator==(const b_tree_iterator <key_t, value_t, capacity, other_t> &other) const {
+                        return node == other.node && index == other.index;
+                }
+                template <typename other_t>
+                bool operator!=(const b_tree_iterator <key_t, value_t, capacity, other_t> &other) const {
+                        return !(*this == other);
+                }
+        };
+        /**
+         * @brief A b tree
+         *
+         * Every node holds up to capacity sorted keys, so a lookup visits log_(capacity/2)(n) nodes
+         * instead of the log_2(n) of a binary tree, and reads the keys of each node from a few
+         * adjacent cache lines. Integer and floating point keys ordered by std::less are compared
+         * against a node with vector instructions, see node_search. Elements are moved between
+         * slots as nodes split and merge, so pointers and iterators to elements are invalidated
+         * by inserting and erasing.
+         * @tparam key_t The key type
+         * @tparam value_t The value type
+         * @tparam compare_t The strict weak ordering of the keys
+         * @tparam capacity The maximum number of keys per node, one less than the fan-out
+         */
+        template <typename key_t, typename value_t, typename compare_t = std::less <key_t>, std::size_t capacity = b_tree_capacity <key_t>::value>
+        class b_tree {
+                static_assert(capacity >= 3, "a b tree node must hold at least 3 keys");
+                static_assert(capacity < 65535, "the keys of a b tree node are counted with 16 bits");
+        private:
+                static const std::size_t min_count = (capacity - 1) / 2; ///< The minimum number of keys of a node other than the root
+                compare_t compare;
+                b_tree_node <key_t, value_t, capacity> *root;
+                unsigned long long node_count;
+                static b_tree_node <key_t, value_t, capacity> *child(const b_tree_node <key_t, value_t, capacity> *x, std::size_t i) {
+                        return b_tree_internal_node <key_t, value_t, capacity>::child(x, i);
+                }
+                static void set_child(b_tree_node <key_t, value_t, capacity> *x, std::size_t i, b_tree_node <key_t, value_t, capacity> *y) {
+                        static_cast<b_tree_internal_node <key_t, value_t, capacity> *>(x)->children[i] = y;
+                        y->parent = x;
+                        y->position = static_cast<std::uint16_t>(i);
+                }
+                static b_tree_node <key_t, value_t, capacity> *create_node(bool leaf) {
+                        if (leaf) return new b_tree_node <key_t, value_t, capacity> (true);
+                        return new b_tree_internal_node <key_t, value_t, capacity> ();
+                }
+                static void destroy_node(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x->leaf) {
+                                delete x;
+                        } else {
+                                delete static_cast<b_tree_internal_node <key_t, value_t, capacity> *>(x);
+                        }
+                }
+                /**
+                 * @brief Finds the index of the first key of a node that is not less than the key specified
+                 */
+                template <typename other_t>
+                std::size_t lower_bound(const b_tree_node <key_t, value_t, capacity> *x, const other_t &key) const {
+                        return node_search <key_t, compare_t>::lower_bound(x->keys(), x->count, key, compare);
+                }
+                /**
+                 * @brief Finds the index of the first key of a node that is greater than the key specified
+                 */
+                template <typename other_t>
+                std::size_t upper_bound(const b_tree_node <key_t, value_t, capacity> *x, const other_t &key) const {
+                        return node_search <key_t, compare_t>::upper_bound(x->keys(), x->count, key, compare);
+                }
+                /**
+                 * @brief Finds the element with the key specified
+                 * @return The node holding the key and its index, or nullptr
+                 */
+                template <typename other_t>
+                std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> find(const other_t &key) const {
+                        b_tree_node <key_t, value_t, capacity> *x = root;
+                        while (x != nullptr) {
+                                std::size_t i = lower_bound(x, key);
+                                if (i < x->count && !compare(key, x->key(i))) return std::make_pair(x, i);
+                                if (x->leaf) break;
+                                x = child(x, i);
+                        }
+                        return std::make_pair(nullptr, 0);
+                }
+                /**
+                 * @brief Finds the first element whose key is not less than the key specified
+                 */
+                template <typename other_t>
+                std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> lower_bound_element(const other_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> result(nullptr, 0);
+                        b_tree_node <key_t, value_t, capacity> *x = root;
+                        while (x != nullptr) {
+                                std::size_t i = lower_bound(x, key);
+                                if (i < x->count) result = std::make_pair(x, i);
+                                if (x->leaf) break;
+                                x = child(x, i);
+                        }
+                        return result;
+                }
+                /**
+                 * @brief Finds the first element whose key is greater than the key specified
+                 */
+                template <typename other_t>
+                std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> upper_bound_element(const other_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> result(nullptr, 0);
+                        b_tree_node <key_t, value_t, capacity> *x = root;
+                        while (x != nullptr) {
+                                std::size_t i = upper_bound(x, key);
+                                if (i < x->count) result = std::make_pair(x, i);
+                                if (x->leaf) break;
+                                x = child(x, i);
+                        }
+                        return result;
+                }
+                /**
+                 * @brief Inserts an element into a node that has room for it
+                 * @param right The child that follows the element in an internal node
+                 */
+                void insert_into(b_tree_node <key_t, value_t, capacity> *x, std::size_t i, key_t &&key, value_t &&value, b_tree_node <key_t, value_t, capacity> *right) {
+                        for (std::size_t j = x->count; j > i; j--) x->move(j - 1, x, j);
+                        x->construct(i, std::move(key), std::move(value));
+                        if (!x->leaf) {
+                                for (std::size_t j = x->count + 1; j > i + 1; j--) set_child(x, j, child(x, j - 1));
+                                set_child(x, i + 1, right);
+                        }
+                        x->count++;
+                }
+                /**
+                 * @brief Inserts an element into a node, splitting the node and its ancestors as needed
+                 * @param right The child that follows the element in an internal node
+                 * @return The node and the index the element ends up at
+                 */
+                std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> insert_element(b_tree_node <key_t, value_t, capacity> *x, std::size_t i, key_t &&key, value_t &&value, b_tree_node <key_t, value_t, capacity> *right) {
+                        if (x->count < capacity) {
+                                insert_into(x, i, std::move(key), std::move(value), right);
+                                return std::make_pair(x, i);
+                        }
+                        // A full node is split around its middle element first, then the element goes into the half it belongs to
+                        const std::size_t middle = capacity / 2;
+                        b_tree_node <key_t, value_t, capacity> *y = create_node(x->leaf);
+                        for (std::size_t j = middle + 1; j < capacity; j++) x->move(j, y, j - middle - 1);
+                        if (!x->leaf) {
+                                for (std::size_t j = middle + 1; j <= capacity; j++) set_child(y, j - middle - 1, child(x, j));
+                        }
+                        y->count = static_cast<std::uint16_t>(capacity - middle - 1);
+                        key_t middle_key(std::move(x->key(middle)));
+                        value_t middle_value(std::move(x->value(middle)));
+                        x->destroy(middle);
+                        x->count = static_cast<std::uint16_t>(middle);
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> result;
+                        if (i <= middle) {
+                                insert_into(x, i, std::move(key), std::move(value), right);
+                                result = std::make_pair(x, i);
+                        } else {
+                                insert_into(y, i - middle - 1, std::move(key), std::move(value), right);
+                                result = std::make_pair(y, i - middle - 1);
+                        }
+                        if (x->parent == nullptr) {
+                                b_tree_node <key_t, value_t, capacity> *z = create_node(false);
+                                z->construct(0, std::move(middle_key), std::move(middle_value));
+                                z->count = 1;
+                                set_child(z, 0, x);
+                                set_child(z, 1, y);
+                                root = z;
+                        } else {
+                                insert_element(x->parent, x->position, std::move(middle_key), std::move(middle_value), y);
+                        }
+                        return result;
+                }
+                /**
+                 * @brief Inserts an element unless an element with an equivalent key exists
+                 *
+                 * The element, and therefore the value, is only constructed when the key is absent.
+                 * It is constructed before the tree is modified, so a throwing constructor leaves the tree intact.
+                 * @param key The key for the new element, used for the descent and then forwarded
+                 * @param args The arguments the value of the new element is constructed from
+                 * @return The new or the existing element and whether the element was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> insert_node(other_t &&key, args_t &&... args) {
+                        b_tree_node <key_t, value_t, capacity> *x = root;
+                        std::size_t i = 0;
+                        while (x != nullptr) {
+                                i = lower_bound(x, key);
+                                if (i < x->count && !compare(key, x->key(i))) return std::make_pair(b_tree_pointer <key_t, value_t> (x->key(i), x->value(i)), false);
+                                if (x->leaf) break;
+                                x = child(x, i);
+                        }
+                        key_t new_key(std::forward<other_t>(key));
+                        value_t new_value(std::forward<args_t>(args)...);
+                        node_count++;
+                        if (x == nullptr) {
+                                root = create_node(true);
+                                insert_into(root, 0, std::move(new_key), std::move(new_value), nullptr);
+                                return std::make_pair(b_tree_pointer <key_t, value_t> (root->key(0), root->value(0)), true);
+                        }
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> result = insert_element(x, i, std::move(new_key), std::move(new_value), nullptr);
+                        return std::make_pair(b_tree_pointer <key_t, value_t> (result.first->key(result.second), result.first->value(result.second)), true);
+                }
+                /**
+                 * @brief Moves the last element of child k into child k + 1 through the separator k of p
+                 */
+                void rotate_right(b_tree_node <key_t, value_t, capacity> *p, std::size_t k) {
+                        b_tree_node <key_t, value_t, capacity> *left = child(p, k);
+                        b_tree_node <key_t, value_t, capacity> *right = child(p, k + 1);
+                        for (std::size_t j = right->count; j > 0; j--) right->move(j - 1, right, j);
+                        p->move(k, right, 0);
+                        left->move(left->count - 1, p, k);
+                        if (!right->leaf) {
+                                for (std::size_t j = right->count + 1; j > 0; j--) set_child(right, j, child(right, j - 1));
+                                set_child(right, 0, child(left, left->count));
+                        }
+                        left->count--;
+                        right->count++;
+                }
+                /**
+                 * @brief Moves the first element of child k + 1 into child k through the separator k of p
+                 */
+                void rotate_left(b_tree_node <key_t, value_t, capacity> *p, std::size_t k) {
+                        b_tree_node <key_t, value_t, capacity> *left = child(p, k);
+                        b_tree_node <key_t, value_t, capacity> *right = child(p, k + 1);
+                        p->move(k, left, left->count);
+                        right->move(0, p, k);
+                        if (!left->leaf) set_child(left, left->count + 1, child(right, 0));
+                        for (std::size_t j = 1; j < right->count; j++) right->move(j, right, j - 1);
+                        if (!right->leaf) {
+                                for (std::size_t j = 1; j <= right->count; j++) set_child(right, j - 1, child(right, j));
+                        }
+                        left->count++;
+                        right->count--;
+                }
+                /**
+                 * @brief Merges child k + 1 and the separator k of p into child k
+                 */
+                void merge(b_tree_node <key_t, value_t, capacity> *p, std::size_t k) {
+                        b_tree_node <key_t, value_t, capacity> *left = child(p, k);
+                        b_tree_node <key_t, value_t, capacity> *right = child(p, k + 1);
+                        p->move(k, left, left->count);
+                        for (std::size_t j = 0; j < right->count; j++) right->move(j, left, left->count + 1 + j);
+                        if (!left->leaf) {
+                                for (std::size_t j = 0; j <= right->count; j++) set_child(left, left->count + 1 + j, child(right, j));
+                        }
+                        left->count = static_cast<std::uint16_t>(left->count + right->count + 1);
+                        for (std::size_t j = k + 1; j < p->count; j++) p->move(j, p, j - 1);
+                        for (std::size_t j = k + 2; j <= p->count; j++) set_child(p, j - 1, child(p, j));
+                        p->count--;
+                        destroy_node(right);
+                }
+                /**
+                 * @brief Restores the minimum number of keys of x and its ancestors after an element was removed from x
+                 */
+                void rebalance(b_tree_node <key_t, value_t, capacity> *x) {
+                        while (x != root && x->count < min_count) {
+                                b_tree_node <key_t, value_t, capacity> *p = x->parent;
+                                std::size_t k = x->position;
+                                // Borrowing from a sibling ends the rebalancing, merging may leave the parent short
+                                if (k > 0 && child(p, k - 1)->count > min_count) {
+                                        rotate_right(p, k - 1);
+                                        return;
+                                }
+                                if (k < p->count && child(p, k + 1)->count > min_count) {
+                                        rotate_left(p, k);
+                                        return;
+                                }
+                                merge(p, k > 0 ? k - 1 : k);
+                                x = p;
+                        }
+                        if (root->count == 0) {
+                                b_tree_node <key_t, value_t, capacity> *old = root;
+                                if (root->leaf) {
+                                        root = nullptr;
+                                } else {
+                                        root = child(root, 0);
+                                        root->parent = nullptr;
+                                        root->position = 0;
+                                }
+                                destroy_node(old);
+                        }
+                }
+                /**
+                 * @brief Removes the element i of x
+                 *
+                 * An element of an internal node is replaced by its predecessor, so elements are only
+                 * ever removed from leaves.
+                 */
+                void erase_element(b_tree_node <key_t, value_t, capacity> *x, std::size_t i) {
+                        if (!x->leaf) {
+                                b_tree_node <key_t, value_t, capacity> *y = iterator::maximum(child(x, i));
+                                x->destroy(i);
+                                y->move(y->count - 1, x, i);
+                                y->count--;
+                                x = y;
+                        } else {
+                                x->destroy(i);
+                                for (std::size_t j = i + 1; j < x->count; j++) x->move(j, x, j - 1);
+                                x->count--;
+                        }
+                        node_count--;
+                        rebalance(x);
+                }
+                void pre_order_traversal(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        x->info();
+                        if (x->leaf) return;
+                        for (std::size_t i = 0; i <= x->count; i++) pre_order_traversal(child(x, i));
+                }
+                void in_order_traversal(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        for (std::size_t i = 0; i < x->count; i++) {
+                                if (!x->leaf) in_order_traversal(child(x, i));
+                                std::cout << x->key(i) << std::endl;
+                        }
+                        if (!x->leaf) in_order_traversal(child(x, x->count));
+                }
+                void post_order_traversal(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        if (!x->leaf) {
+                                for (std::size_t i = 0; i <= x->count; i++) post_order_traversal(child(x, i));
+                        }
+                        x->info();
+                }
+                void breadth_first_traversal(b_tree_node <key_t, value_t, capacity> *x) {
+                        std::queue <b_tree_node <key_t, value_t, capacity> *> queue;
+                        if (x == nullptr) return;
+                        queue.push(x);
+                        while(queue.empty() == false) {
+                                b_tree_node <key_t, value_t, capacity> *y = queue.front();
+                                y->info();
+                                queue.pop();
+                                if (y->leaf) continue;
+                                for (std::size_t i = 0; i <= y->count; i++) queue.push(child(y, i));
+                        }
+                }
+                void clear(b_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        if (!x->leaf) {
+                                for (std::size_t i = 0; i <= x->count; i++) clear(child(x, i));
+                        }
+                        for (std::size_t i = 0; i < x->count; i++) x->destroy(i);
+                        destroy_node(x);
+                }
+                unsigned long long graphviz(std::ofstream &file, b_tree_node <key_t, value_t, capacity> *x, unsigned long long *count) {
+                        unsigned long long id = (*count)++;
+                        file << "\t" << "node" << id << " [label=\"";
+                        for (std::size_t i = 0; i < x->count; i++) {
+                                file << "<c" << i << "> |" << x->key(i) << "|";
+                        }
+                        file << "<c" << x->count << "> \"];" << std::endl;
+                        if (x->leaf) return id;
+                        for (std::size_t i = 0; i <= x->count; i++) {
+                                unsigned long long y = graphviz(file, child(x, i), count);
+                                file << "\t" << "node" << id << ":c" << i << " -> " << "node" << y << ";" << std::endl;
+                        }
+                        return id;
+                }
+        public:
+                typedef b_tree_iterator <key_t, value_t, capacity, value_t> iterator;
+                typedef b_tree_iterator <key_t, value_t, capacity, const value_t> const_iterator;
+                typedef std::reverse_iterator <iterator> reverse_iterator;
+                typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+                b_tree() {
+                        root = nullptr;
+                        node_count = 0;
+                }
+                explicit b_tree(const compare_t &compare) : compare(compare) {
+                        root = nullptr;
+                        node_count = 0;
+                }
+                b_tree(const b_tree &) = delete;
+                b_tree &operator=(const b_tree &) = delete;
+                b_tree(b_tree &&other) : compare(std::move(other.compare)) {
+                        root = other.root;
+                        node_count = other.node_count;
+                        other.root = nullptr;
+                        other.node_count = 0;
+                }
+                b_tree &operator=(b_tree &&other) {
+                        if (this != &other) {
+                                clear();
+                                compare = std::move(other.compare);
+                                root = other.root;
+                                node_count = other.node_count;
+                                other.root = nullptr;
+                                other.node_count = 0;
+                        }
+                        return *this;
+                }
+                ~b_tree() {
+                        clear();
+                }
+                /**
+                 * @brief Performs a Pre Order Traversal starting from the root node, printing the keys of each node
+                 * @return void
+                 */
+                void pre_order_traversal() {
+                        pre_order_traversal(root);
+                }
+                /**
+                 * @brief Performs a In Order Traversal starting from the root node, printing each key
+                 * @return void
+                 */
+                void in_order_traversal() {
+                        in_order_traversal(root);
+                }
+                /**
+                 * @brief Performs a Post Order Traversal starting from the root node, printing the keys of each node
+                 * @return void
+                 */
+                void post_order_traversal() {
+                        post_order_traversal(root);
+                }
+                /**
+                 * @brief Performs a Breadth First Traversal starting from the root node, printing the keys of each node
+                 * @return void
+                 */
+                void breadth_first_traversal() {
+                        breadth_first_traversal(root);
+                }
+                /**
+                 * @brief Generates a DOT file representing the B Tree
+                 * @param filename The filename of the .dot file
+                 * @return void
+                 */
+                void graphviz(std::string filename) {
+                        std::ofstream file;
+                        unsigned long long count = 0;
+                        file.open(filename);
+                        file << "digraph {" << std::endl;
+                        file << "\t" << "node [shape=record];" << std::endl;
+                        if (root != nullptr) graphviz(file, root, &count);
+                        file << "}" << std::endl;
+                        file.close();
+                }
+                /**
+                 * @brief Removes all elements from the B Tree
+                 * @return void
+                 */
+                void clear() {
+                        clear(root);
+                        root = nullptr;
+                        node_count = 0;
+                }
+                /**
+                 * @brief Inserts a new element unless the key already exists
+                 * @param key The key for the new element
+                 * @param value The value for the new element
+                 * @return The new element or nullptr if the key already exists
+                 */
+                b_tree_pointer <key_t, value_t> insert(const key_t &key, const value_t &value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(key, value);
+                        return result.second ? result.first : nullptr;
+                }
+                b_tree_pointer <key_t, value_t> insert(const key_t &key, value_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(key, std::move(value));
+                        return result.second ? result.first : nullptr;
+                }
+                b_tree_pointer <key_t, value_t> insert(key_t &&key, const value_t &value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(std::move(key), value);
+                        return result.second ? result.first : nullptr;
+                }
+                b_tree_pointer <key_t, value_t> insert(key_t &&key, value_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(std::move(key), std::move(value));
+                        return result.second ? result.first : nullptr;
+                }
+                /**
+                 * @brief Inserts a new element whose value is constructed from arguments, unless the key already exists
+                 * @param key The key for the new element
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing element and whether the element was inserted
+                 */
+                template <typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> try_emplace(const key_t &key, args_t &&... args) {
+                        return insert_node(key, std::forward<args_t>(args)...);
+                }
+                template <typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> try_emplace(key_t &&key, args_t &&... args) {
+                        return insert_node(std::move(key), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new element constructed from arguments, unless the key already exists
+                 *
+                 * The key is constructed first since it is needed to find the position of the element.
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing element and whether the element was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> emplace(other_t &&key, args_t &&... args) {
+                        return insert_node(key_t(std::forward<other_t>(key)), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new element or assigns the value of the element with an equivalent key
+                 * @param key The key of the element
+                 * @param value The value to insert or assign
+                 * @return The element holding the value and whether the element was inserted
+                 */
+                template <typename other_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> insert_or_assign(const key_t &key, other_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(key, std::forward<other_t>(value));
+                        // The value is only consumed by insert_node when an element is created
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                template <typename other_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> insert_or_assign(key_t &&key, other_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(std::move(key), std::forward<other_t>(value));
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                /**
+                 * @brief Applies a function to the value of the element with the key specified, inserting the element first if needed
+                 * @param key The key of the element
+                 * @param function The function called with a reference to the value
+                 * @return The element holding the value
+                 */
+                template <typename function_t>
+                b_tree_pointer <key_t, value_t> upsert(const key_t &key, function_t function) {
+                        b_tree_pointer <key_t, value_t> x = insert_node(key).first;
+                        function(x->value);
+                        return x;
+                }
+                template <typename function_t>
+                b_tree_pointer <key_t, value_t> upsert(key_t &&key, function_t function) {
+                        b_tree_pointer <key_t, value_t> x = insert_node(std::move(key)).first;
+                        function(x->value);
+                        return x;
+                }
+                /**
+                 * @brief Removes the element with the key specified from the B Tree
+                 * @param key The key of the element to remove
+                 * @return true if an element was removed and false otherwise
+                 */
+                bool erase(const key_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return false;
+                        erase_element(x.first, x.second);
+                        return true;
+                }
+                /**
+                 * @brief Removes the element with the minimum key
+                 * @return true if an element was removed and false if the B Tree is empty
+                 */
+                bool pop_min() {
+                        if (root == nullptr) return false;
+                        erase_element(iterator::minimum(root), 0);
+                        return true;
+                }
+                /**
+                 * @brief Removes the element with the maximum key
+                 * @return true if an element was removed and false if the B Tree is empty
+                 */
+                bool pop_max() {
+                        if (root == nullptr) return false;
+                        b_tree_node <key_t, value_t, capacity> *x = iterator::maximum(root);
+                        erase_element(x, x->count - 1);
+                        return true;
+                }
+                /**
+                 * @brief Searches for a key starting from the root node
+                 *
+                 * The value of the element returned may be modified in place, its key must not.
+                 * @return The element with the key specified or nullptr
+                 */
+                b_tree_pointer <key_t, value_t> search(const key_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                /**
+                 * @brief Searches for a key of another type, requires a transparent comparator
+                 * @return The element with a key equivalent to the key specified or nullptr
+                 */
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                b_tree_pointer <key_t, value_t> search(const other_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                /**
+                 * @brief Searches for a key on a const tree, the element returned is read only
+                 * @return The element with the key specified or nullptr
+                 */
+                b_tree_pointer <key_t, const value_t> search(const key_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, const value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                b_tree_pointer <key_t, const value_t> search(const other_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, const value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                /**
+                 * @brief Finds the first element whose key is not less than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the element found or end() if there is none
+                 */
+                iterator lower_bound(const key_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return iterator(x.first, x.second, &root);
+                }
+                const_iterator lower_bound(const key_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return const_iterator(x.first, x.second, &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator lower_bound(const other_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return iterator(x.first, x.second, &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator lower_bound(const other_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return const_iterator(x.first, x.second, &root);
+                }
+                /**
+                 * @brief Finds the first element whose key is greater than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the element found or end() if there is none
+                 */
+                iterator upper_bound(const key_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return iterator(x.first, x.second, &root);
+                }
+                const_iterator upper_bound(const key_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return const_iterator(x.first, x.second, &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator upper_bound(const other_t &key) {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return iterator(x.first, x.second, &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator upper_bound(const other_t &key) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return const_iterator(x.first, x.second, &root);
+                }
+                /**
+                 * @brief Finds the range of elements whose key is equal to the key specified
+                 * @param key The key to compare against
+                 * @return The pair lower_bound(key), upper_bound(key)
+                 */
+                std::pair <iterator, iterator> equal_range(const key_t &key) {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                std::pair <const_iterator, const_iterator> equal_range(const key_t &key) const {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                /**
+                 * @brief Calls a function for every element whose key lies in [lo, hi)
+                 *
+                 * Descends once to the first element of the range and then walks the keys of each
+                 * node in place, so a range of k elements costs O(height + k).
+                 * @param lo The smallest key of the range
+                 * @param hi The key past the end of the range
+                 * @param function The function called with a constant b_tree_reference to each element, in key order
+                 * @return void
+                 */
+                template <typename function_t>
+                void for_each_in_range(const key_t &lo, const key_t &hi, function_t function) const {
+                        std::pair <b_tree_node <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(lo);
+                        while (x.first != nullptr && compare(x.first->key(x.second), hi)) {
+                                function(b_tree_reference <key_t, const value_t> {x.first->key(x.second), x.first->value(x.second)});
+                                const_iterator::successor(x.first, x.second);
+                        }
+                }
+                /**
+                 * @brief Copies the elements into an immutable static_search_tree, which is searched faster and may be read by many threads at once
+                 * @return The static_search_tree holding the elements of the B Tree
+                 */
+                static_search_tree <key_t, value_t, compare_t> freeze() const {
+                        return static_search_tree <key_t, value_t, compare_t> (begin(), end(), compare);
+                }
+                /**
+                 * @brief Finds the element with the minimum key
+                 * @return The element with the minimum key or nullptr
+                 */
+                b_tree_pointer <key_t, const value_t> minimum() const {
+                        if (root == nullptr) return nullptr;
+                        b_tree_node <key_t, value_t, capacity> *x = iterator::minimum(root);
+                        return b_tree_pointer <key_t, const value_t> (x->key(0), x->value(0));
+                }
+                /**
+                 * @brief Finds the element with the maximum key
+                 * @return The element with the maximum key or nullptr
+                 */
+                b_tree_pointer <key_t, const value_t> maximum() const {
+                        if (root == nullptr) return nullptr;
+                        b_tree_node <key_t, value_t, capacity> *x = iterator::maximum(root);
+                        return b_tree_pointer <key_t, const value_t> (x->key(x->count - 1), x->value(x->count - 1));
+                }
+                /**
+                 * @brief Finds the height of the b tree, the number of nodes on every path from the root to a leaf
+                 * @return The height of the b tree
+                 */
+                unsigned long long height() {
+                        unsigned long long result = 0;
+                        for (b_tree_node <key_t, value_t, capacity> *x = root; x != nullptr; x = x->leaf ? nullptr : child(x, 0)) result++;
+                        return result;
+                }
+                /**
+                 * @brief Finds the size of the b tree
+                 * @return The number of elements of the b tree
+                 */
+                unsigned long long size() const {
+                        return node_count;
+                }
+                /**
+                 * @brief Finds if the b tree is empty
+                 * @return true if the b tree is empty and false otherwise
+                 */
+                bool empty() const {
+                        if (root == nullptr) {
+                                return true;
+                        } else {
+                                return false;
+                        }
+                }
+                /**
+                 * @brief Returns the comparator used to order the keys
+                 * @return A copy of the comparator
+                 */
+                compare_t key_comp() const {
+                        return compare;
+                }
+                /**
+                 * @brief Returns an iterator to the element with the minimum key
+                 * @return An iterator to the first element in key order
+                 */
+                iterator begin() {
+                        return iterator(iterator::minimum(root), 0, &root);
+                }
+                /**
+                 * @brief Returns an iterator past the element with the maximum key
+                 * @return An iterator past the last element in key order
+                 */
+                iterator end() {
+                        return iterator(nullptr, 0, &root);
+                }
+                const_iterator begin() const {
+                        return const_iterator(iterator::minimum(root), 0, &root);
+                }
+                const_iterator end() const {
+                        return const_iterator(nullptr, 0, &root);
+                }
+                const_iterator cbegin() const {
+                        return begin();
+                }
+                const_iterator cend() const {
+                        return end();
+                }
+                /**
+                 * @brief Returns a reverse iterator to the element with the maximum key
+                 * @return A reverse iterator to the first element in descending key order
+                 */
+                reverse_iterator rbegin() {
+                        return reverse_iterator(end());
+                }
+                /**
+                 * @brief Returns a reverse iterator past the element with the minimum key
+                 * @return A reverse iterator past the last element in descending key order
+                 */
+                reverse_iterator rend() {
+                        return reverse_iterator(begin());
+                }
+                const_reverse_iterator rbegin() const {
+                        return const_reverse_iterator(end());
+                }
+                const_reverse_iterator rend() const {
+                        return const_reverse_iterator(begin());
+                }
+                const_reverse_iterator crbegin() const {
+                        return rbegin();
+                }
+                const_reverse_iterator crend() const {
+                        return rend();
+                }
+        };
+}
+
+#endif
@@ -0,0 +1,1053 @@
+/**
+ * @file bplus_tree.h
+ */
+
+#ifndef BPLUS_TREE_H
+#define BPLUS_TREE_H
+
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <queue>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "b_tree.h"
+#include "node_search.h"
+#include "static_search_tree.h"
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief A b+ tree node, the base of leaves and internal nodes, which holds the sorted keys
+         * @tparam capacity The maximum number of keys per node
+         */
+        template <typename key_t, typename value_t, std::size_t capacity>
+        struct bplus_tree_node {
+                std::uint16_t count;    ///< The number of keys of the node
+                std::uint16_t position; ///< The index of the node among the children of its parent
+                bool leaf;              ///< Whether the node is a leaf
+                bplus_tree_node *parent; ///< A pointer to the parent of the node
+                typename std::aligned_storage <sizeof(key_t), alignof(key_t)>::type key_slots[capacity]; ///< The sorted keys of the node
+                explicit bplus_tree_node(bool leaf) : count(0), position(0), leaf(leaf), parent(nullptr) {
+
+                }
+                key_t *keys() {
+                        return reinterpret_cast<key_t *>(key_slots);
+                }
+                const key_t *keys() const {
+                        return reinterpret_cast<const key_t *>(key_slots);
+                }
+                key_t &key(std::size_t i) {
+                        return keys()[i];
+                }
+                const key_t &key(std::size_t i) const {
+                        return keys()[i];
+                }
+                void construct_key(std::size_t i, key_t &&key) {
+                        ::new (static_cast<void *>(&key_slots[i])) key_t(std::move(key));
+                }
+                void destroy_key(std::size_t i) {
+                        key(i).~key_t();
+                }
+                /**
+                 * @brief Moves key i into the empty slot j of a node, leaving slot i empty
+                 */
+                void move_key(std::size_t i, bplus_tree_node *x, std::size_t j) {
+                        x->construct_key(j, std::move(key(i)));
+                        destroy_key(i);
+                }
+                /**
+                 * @brief Prints to the std::cout the keys of the node
+                 */
+                void info() const {
+                        for (std::size_t i = 0; i < count; i++) {
+                                std::cout << key(i) << (i + 1 < count ? "\t" : "");
+                        }
+                        std::cout << std::endl;
+                }
+        };
+        /**
+         * @brief A b+ tree leaf, which holds the values and is linked to its neighbours in key order
+         */
+        template <typename key_t, typename value_t, std::size_t capacity>
+        struct bplus_tree_leaf : bplus_tree_node <key_t, value_t, capacity> {
+                bplus_tree_leaf *previous; ///< A pointer to the leaf with the previous keys
+                bplus_tree_leaf *next;     ///< A pointer to the leaf with the next keys
+                typename std::aligned_storage <sizeof(value_t), alignof(value_t)>::type value_slots[capacity]; ///< The values of the leaf
+                bplus_tree_leaf() : bplus_tree_node <key_t, value_t, capacity> (true), previous(nullptr), next(nullptr) {
+
+                }
+                value_t &value(std::size_t i) {
+                        return reinterpret_cast<value_t *>(value_slots)[i];
+                }
+                const value_t &value(std::size_t i) const {
+                        return reinterpret_cast<const value_t *>(value_slots)[i];
+                }
+                void construct(std::size_t i, key_t &&key, value_t &&value) {
+                        this->construct_key(i, std::move(key));
+                        ::new (static_cast<void *>(&value_slots[i])) value_t(std::move(value));
+                }
+                void destroy(std::size_t i) {
+                        this->destroy_key(i);
+                        value(i).~value_t();
+                }
+                /**
+                 * @brief Moves element i into the empty slot j of a leaf, leaving slot i empty
+                 */
+                void move(std::size_t i, bplus_tree_leaf *x, std::size_t j) {
+                        x->construct(j, std::move(this->key(i)), std::move(value(i)));
+                        destroy(i);
+                }
+        };
+        /**
+         * @brief A b+ tree internal node, whose keys separate its children
+         *
+         * The keys of child i are less than key i, and the keys of child i + 1 are not.
+         */
+        template <typename key_t, typename value_t, std::size_t capacity>
+        struct bplus_tree_internal_node : bplus_tree_node <key_t, value_t, capacity> {
+                bplus_tree_node <key_t, value_t, capacity> *children[capacity + 1]; ///< The children of the node
+                bplus_tree_internal_node() : bplus_tree_node <key_t, value_t, capacity> (false) {
+
+                }
+        };
+        /**
+         * @brief A bidirectional iterator over the elements of a b+ tree in key order, which follows the links between leaves
+         * @tparam reference_t value_t for a mutable iterator and const value_t for a constant one
+         */
+        template <typename key_t, typename value_t, std::size_t capacity, typename reference_t>
+        class bplus_tree_iterator {
+        private:
+                template <typename, typename, std::size_t, typename> friend class bplus_tree_iterator;
+                bplus_tree_leaf <key_t, value_t, capacity> *leaf;
+                std::size_t index;
+                bplus_tree_leaf <key_t, value_t, capacity> *const *last;
+        public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef b_tree_reference <key_t, reference_t> value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef b_tree_pointer <key_t, reference_t> pointer;
+                typedef b_tree_reference <key_t, reference_t> reference;
+                bplus_tree_iterator() {
+                        leaf = nullptr;
+                        index = 0;
+                        last = nullptr;
+                }
+                bplus_tree_iterator(bplus_tree_leaf <key_t, value_t, capacity> *leaf, std::size_t index, bplus_tree_leaf <key_t, value_t, capacity> *const *last) {
+                        this->leaf = leaf;
+                        this->index = index;
+                        this->last = last;
+                }
+                /**
+                 * @brief Converts a mutable iterator into a constant one
+                 */
+                template <typename other_t, typename = typename std::enable_if <std::is_const <reference_t>::value && !std::is_const <other_t>::value>::type>
+                bplus_tree_iterator(const bplus_tree_iterator <key_t, value_t, capacity, other_t> &other) {
+                        leaf = other.leaf;
+                        index = other.index;
+                        last = other.last;
+                }
+                reference operator*() const {
+                        return reference {leaf->key(index), leaf->value(index)};
+                }
+                pointer operator->() const {
+                        return pointer(leaf->key(index), leaf->value(index));
+                }
+                bplus_tree_iterator &operator++() {
+                        if (++index == leaf->count) {
+                                leaf = leaf->next;
+                                index = 0;
+                        }
+                        return *this;
+                }
+                bplus_tree_iterator operator++(int) {
+                        bplus_tree_iterator x = *this;
+                        ++(*this);
+                        return x;
+                }
+                bplus_tree_iterator &operator--() {
+                        if (leaf == nullptr) {
+                                leaf = *last;
+                                index = leaf->count - 1;
+                        } else if (index == 0) {
+                                leaf = leaf->previous;
+                                index = leaf->count - 1;
+                        } else {
+                                index--;
+                        }
+                        return *this;
+                }
+                bplus_tree_iterator operator--(int) {
+                        bplus_tree_iterator x = *this;
+                        --(*this);
+                        return x;
+                }
+                template <typename other_t>
+                bool operator==(const bplus_tree_iterator <key_t, value_t, capacity, other_t> &other) const {
+                        return leaf == other.leaf && index == other.index;
+                }
+                template <typename other_t>
+                bool operator!=(const bplus_tree_iterator <key_t, value_t, capacity, other_t> &other) const {
+                        return !(*this == other);
+                }
+        };
+        /**
+         * @brief A b+ tree
+         *
+         * Values live only in the leaves, which are linked in key order, while internal nodes hold
+         * nothing but dense arrays of separator keys. A range scan therefore descends once and then
+         * reads the leaves one after the other, without returning to the internal nodes. Separator
+         * keys are copies of keys, so key_t must be copy constructible. Like b_tree, elements are
+         * moved as leaves split and merge, so pointers and iterators to elements are invalidated by
+         * inserting and erasing.
+         * @tparam key_t The key type
+         * @tparam value_t The value type
+         * @tparam compare_t The strict weak ordering of the keys
+         * @tparam capacity The maximum number of keys per node
+         */
+        template <typename key_t, typename value_t, typename compare_t = std::less <key_t>, std::size_t capacity = b_tree_capacity <key_t>::value>
+        class bplus_tree {
+                static_assert(capacity >= 3, "a b+ tree node must hold at least 3 keys");
+                static_assert(capacity < 65535, "the keys of a b+ tree node are counted with 16 bits");
+        private:
+                static const std::size_t min_count = (capacity - 1) / 2; ///< The minimum number of keys of a node other than the root
+                compare_t compare;
+                bplus_tree_node <key_t, value_t, capacity> *root;
+                bplus_tree_leaf <key_t, value_t, capacity> *first; ///< The leaf with the minimum key
+                bplus_tree_leaf <key_t, value_t, capacity> *last;  ///< The leaf with the maximum key
+                unsigned long long node_count;
+                static bplus_tree_leaf <key_t, value_t, capacity> *as_leaf(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        return static_cast<bplus_tree_leaf <key_t, value_t, capacity> *>(x);
+                }
+                static bplus_tree_internal_node <key_t, value_t, capacity> *as_internal(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        return static_cast<bplus_tree_internal_node <key_t, value_t, capacity> *>(x);
+                }
+                static bplus_tree_node <key_t, value_t, capacity> *child(bplus_tree_node <key_t, value_t, capacity> *x, std::size_t i) {
+                        return as_internal(x)->children[i];
+                }
+                static void set_child(bplus_tree_node <key_t, value_t, capacity> *x, std::size_t i, bplus_tree_node <key_t, value_t, capacity> *y) {
+                        as_internal(x)->children[i] = y;
+                        y->parent = x;
+                        y->position = static_cast<std::uint16_t>(i);
+                }
+                static void destroy_node(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        if (x->leaf) {
+                                delete as_leaf(x);
+                        } else {
+                                delete as_internal(x);
+                        }
+                }
+                template <typename other_t>
+                std::size_t lower_bound(const bplus_tree_node <key_t, value_t, capacity> *x, const other_t &key) const {
+                        return node_search <key_t, compare_t>::lower_bound(x->keys(), x->count, key, compare);
+                }
+                template <typename other_t>
+                std::size_t upper_bound(const bplus_tree_node <key_t, value_t, capacity> *x, const other_t &key) const {
+                        return node_search <key_t, compare_t>::upper_bound(x->keys(), x->count, key, compare);
+                }
+                /**
+                 * @brief Descends to the leaf that holds the key specified if the key exists
+                 *
+                 * Keys equal to a separator are in the subtree to its right.
+                 */
+                template <typename other_t>
+                bplus_tree_leaf <key_t, value_t, capacity> *find_leaf(const other_t &key) const {
+                        bplus_tree_node <key_t, value_t, capacity> *x = root;
+                        if (x == nullptr) return nullptr;
+                        while (!x->leaf) x = child(x, upper_bound(x, key));
+                        return as_leaf(x);
+                }
+                /**
+                 * @brief Finds the element with the key specified
+                 * @return The leaf holding the key and its index, or nullptr
+                 */
+                template <typename other_t>
+                std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> find(const other_t &key) const {
+                        bplus_tree_leaf <key_t, value_t, capacity> *x = find_leaf(key);
+                        if (x == nullptr) return std::make_pair(nullptr, 0);
+                        std::size_t i = lower_bound(x, key);
+                        if (i < x->count && !compare(key, x->key(i))) return std::make_pair(x, i);
+                        return std::make_pair(nullptr, 0);
+                }
+                /**
+                 * @brief Turns a position in a leaf into the position of the same element, moving past the end of the leaf to the next one
+                 */
+                static std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> normalize(bplus_tree_leaf <key_t, value_t, capacity> *x, std::size_t i) {
+                        if (x != nullptr && i == x->count) return std::make_pair(x->next, 0);
+                        return std::make_pair(x, i);
+                }
+                template <typename other_t>
+                std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> lower_bound_element(const other_t &key) const {
+                        bplus_tree_leaf <key_t, value_t, capacity> *x = find_leaf(key);
+                        if (x == nullptr) return std::make_pair(nullptr, 0);
+                        return normalize(x, lower_bound(x, key));
+                }
+                template <typename other_t>
+                std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> upper_bound_element(const other_t &key) const {
+                        bplus_tree_leaf <key_t, value_t, capacity> *x = find_leaf(key);
+                        if (x == nullptr) return std::make_pair(nullptr, 0);
+                        return normalize(x, upper_bound(x, key));
+                }
+                void insert_into(bplus_tree_leaf <key_t, value_t, capacity> *x, std::size_t i, key_t &&key, value_t &&value) {
+                        for (std::size_t j = x->count; j > i; j--) x->move(j - 1, x, j);
+                        x->construct(i, std::move(key), std::move(value));
+                        x->count++;
+                }
+                /**
+                 * @brief Links a new right sibling y of x into the parent of x under a separator key, splitting ancestors as needed
+                 */
+                void insert_child(bplus_tree_node <key_t, value_t, capacity> *x, key_t &&key, bplus_tree_node <key_t, value_t, capacity> *y) {
+                        if (x->parent == nullptr) {
+                                bplus_tree_internal_node <key_t, value_t, capacity> *z = new bplus_tree_internal_node <key_t, value_t, capacity> ();
+                                z->construct_key(0, std::move(key));
+                                z->count = 1;
+                                set_child(z, 0, x);
+                                set_child(z, 1, y);
+                                root = z;
+                        } else {
+                                insert_key(x->parent, x->position, std::move(key), y);
+                        }
+                }
+                /**
+                 * @brief Inserts a separator key at index i of an internal node and the child that follows it
+                 */
+                void insert_key(bplus_tree_node <key_t, value_t, capacity> *x, std::size_t i, key_t &&key, bplus_tree_node <key_t, value_t, capacity> *right) {
+                        bplus_tree_node <key_t, value_t, capacity> *target = x;
+                        if (x->count == capacity) {
+                                // The middle key moves up to the parent, the keys after it move to the new sibling
+                                const std::size_t middle = capacity / 2;
+                                bplus_tree_internal_node <key_t, value_t, capacity> *y = new bplus_tree_internal_node <key_t, value_t, capacity> ();
+                                for (std::size_t j = middle + 1; j < capacity; j++) x->move_key(j, y, j - middle - 1);
+                                for (std::size_t j = middle + 1; j <= capacity; j++) set_child(y, j - middle - 1, child(x, j));
+                                y->count = static_cast<std::uint16_t>(capacity - middle - 1);
+                                key_t middle_key(std::move(x->key(middle)));
+                                x->destroy_key(middle);
+                                x->count = static_cast<std::uint16_t>(middle);
+                                insert_child(x, std::move(middle_key), y);
+                                if (i > middle) {
+                                        target = y;
+                                        i -= middle + 1;
+                                }
+                        }
+                        for (std::size_t j = target->count; j > i; j--) target->move_key(j - 1, target, j);
+                        target->construct_key(i, std::move(key));
+                        for (std::size_t j = target->count + 1; j > i + 1; j--) set_child(target, j, child(target, j - 1));
+                        set_child(target, i + 1, right);
+                        target->count++;
+                }
+                /**
+                 * @brief Inserts an element into a leaf, splitting the leaf and its ancestors as needed
+                 * @return The leaf and the index the element ends up at
+                 */
+                std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> insert_element(bplus_tree_leaf <key_t, value_t, capacity> *x, std::size_t i, key_t &&key, value_t &&value) {
+                        if (x->count < capacity) {
+                                insert_into(x, i, std::move(key), std::move(value));
+                                return std::make_pair(x, i);
+                        }
+                        bplus_tree_leaf <key_t, value_t, capacity> *y = new bplus_tree_leaf <key_t, value_t, capacity> ();
+                        y->previous = x;
+                        y->next = x->next;
+                        if (x->next != nullptr) {
+                                x->next->previous = y;
+                        } else {
+                                last = y;
+                        }
+                        x->next = y;
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> result;
+                        if (i == capacity && y->next == nullptr) {
+                                // Appending past the maximum leaves the full leaf as it is, so increasing keys fill every leaf
+                                insert_into(y, 0, std::move(key), std::move(value));
+                                result = std::make_pair(y, 0);
+                        } else {
+                                const std::size_t middle = (capacity + 1) / 2;
+                                for (std::size_t j = middle; j < capacity; j++) x->move(j, y, j - middle);
+                                y->count = static_cast<std::uint16_t>(capacity - middle);
+                                x->count = static_cast<std::uint16_t>(middle);
+                                if (i <= middle) {
+                                        insert_into(x, i, std::move(key), std::move(value));
+                                        result = std::make_pair(x, i);
+                                } else {
+                                        insert_into(y, i - middle, std::move(key), std::move(value));
+                                        result = std::make_pair(y, i - middle);
+                                }
+                        }
+                        insert_child(x, key_t(y->key(0)), y);
+                        return result;
+                }
+                /**
+                 * @brief Inserts an element unless an element with an equivalent key exists
+                 *
+                 * The element is constructed only when the key is absent, and before the tree is modified.
+                 * @param key The key for the new element, used for the descent and then forwarded
+                 * @param args The arguments the value of the new element is constructed from
+                 * @return The new or the existing element and whether the element was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> insert_node(other_t &&key, args_t &&... args) {
+                        bplus_tree_leaf <key_t, value_t, capacity> *x = find_leaf(key);
+                        std::size_t i = 0;
+                        if (x != nullptr) {
+                                i = lower_bound(x, key);
+                                if (i < x->count && !compare(key, x->key(i))) return std::make_pair(b_tree_pointer <key_t, value_t> (x->key(i), x->value(i)), false);
+                        }
+                        key_t new_key(std::forward<other_t>(key));
+                        value_t new_value(std::forward<args_t>(args)...);
+                        node_count++;
+                        if (x == nullptr) {
+                                x = new bplus_tree_leaf <key_t, value_t, capacity> ();
+                                root = x;
+                                first = x;
+                                last = x;
+                        }
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> result = insert_element(x, i, std::move(new_key), std::move(new_value));
+                        return std::make_pair(b_tree_pointer <key_t, value_t> (result.first->key(result.second), result.first->value(result.second)), true);
+                }
+                /**
+                 * @brief Removes separator k and child k + 1 from an internal node
+                 */
+                void remove_key(bplus_tree_node <key_t, value_t, capacity> *p, std::size_t k) {
+                        p->destroy_key(k);
+                        for (std::size_t j = k + 1; j < p->count; j++) p->move_key(j, p, j - 1);
+                        for (std::size_t j = k + 2; j <= p->count; j++) set_child(p, j - 1, child(p, j));
+                        p->count--;
+                }
+                /**
+                 * @brief Merges leaf k + 1 of p into leaf k and unlinks it
+                 */
+                void merge_leaves(bplus_tree_node <key_t, value_t, capacity> *p, std::size_t k) {
+                        bplus_tree_leaf <key_t, value_t, capacity> *left = as_leaf(child(p, k));
+                        bplus_tree_leaf <key_t, value_t, capacity> *right = as_leaf(child(p, k + 1));
+                        for (std::size_t j = 0; j < right->count; j++) right->move(j, left, left->count + j);
+                        left->count = static_cast<std::uint16_t>(left->count + right->count);
+                        left->next = right->next;
+                        if (right->next != nullptr) {
+                                right->next->previous = left;
+                        } else {
+                                last = left;
+                        }
+                        remove_key(p, k);
+                        delete right;
+                }
+                /**
+                 * @brief Merges internal child k + 1 of p and the separator k into child k
+                 */
+                void merge_internal(bplus_tree_node <key_t, value_t, capacity> *p, std::size_t k) {
+                        bplus_tree_node <key_t, value_t, capacity> *left = child(p, k);
+                        bplus_tree_node <key_t, value_t, capacity> *right = child(p, k + 1);
+                        left->construct_key(left->count, key_t(p->key(k)));
+                        for (std::size_t j = 0; j < right->count; j++) right->move_key(j, left, left->count + 1 + j);
+                        for (std::size_t j = 0; j <= right->count; j++) set_child(left, left->count + 1 + j, child(right, j));
+                        left->count = static_cast<std::uint16_t>(left->count + right->count + 1);
+                        remove_key(p, k);
+                        delete as_internal(right);
+                }
+                /**
+                 * @brief Restores the minimum number of keys of an internal node and its ancestors
+                 */
+                void rebalance_internal(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        while (x != root && x->count < min_count) {
+                                bplus_tree_node <key_t, value_t, capacity> *p = x->parent;
+                                std::size_t k = x->position;
+                                if (k > 0 && child(p, k - 1)->count > min_count) {
+                                        // The separator moves down in front of x and the last key of the left sibling replaces it
+                                        bplus_tree_node <key_t, value_t, capacity> *left = child(p, k - 1);
+                                        for (std::size_t j = x->count; j > 0; j--) x->move_key(j - 1, x, j);
+                                        for (std::size_t j = x->count + 1; j > 0; j--) set_child(x, j, child(x, j - 1));
+                                        p->move_key(k - 1, x, 0);
+                                        set_child(x, 0, child(left, left->count));
+                                        left->move_key(left->count - 1, p, k - 1);
+                                        left->count--;
+                                        x->count++;
+                                        return;
+                                }
+                                if (k < p->count && child(p, k + 1)->count > min_count) {
+                                        bplus_tree_node <key_t, value_t, capacity> *right = child(p, k + 1);
+                                        p->move_key(k, x, x->count);
+                                        set_child(x, x->count + 1, child(right, 0));
+                                        right->move_key(0, p, k);
+                                        for (std::size_t j = 1; j < right->count; j++) right->move_key(j, right, j - 1);
+                                        for (std::size_t j = 1; j <= right->count; j++) set_child(right, j - 1, child(right, j));
+                                        right->count--;
+                                        x->count++;
+                                        return;
+                                }
+                                merge_internal(p, k > 0 ? k - 1 : k);
+                                x = p;
+                        }
+                        if (x == root && root->count == 0) {
+                                root = child(x, 0);
+                                root->parent = nullptr;
+                                root->position = 0;
+                                delete as_internal(x);
+                        }
+                }
+                /**
+                 * @brief Removes element i of leaf x
+                 *
+                 * Separators are left as they are: a separator that is no longer a key still separates
+                 * the keys of its children.
+                 */
+                void erase_element(bplus_tree_leaf <key_t, value_t, capacity> *x, std::size_t i) {
+                        x->destroy(i);
+                        for (std::size_t j = i + 1; j < x->count; j++) x->move(j, x, j - 1);
+                        x->count--;
+                        node_count--;
+                        if (x == root) {
+                                if (x->count == 0) {
+                                        delete x;
+                                        root = nullptr;
+                                        first = nullptr;
+                                        last = nullptr;
+                                }
+                                return;
+                        }
+                        if (x->count >= min_count) return;
+                        bplus_tree_node <key_t, value_t, capacity> *p = x->parent;
+                        std::size_t k = x->position;
+                        if (k > 0 && child(p, k - 1)->count > min_count) {
+                                bplus_tree_leaf <key_t, value_t, capacity> *left = as_leaf(child(p, k - 1));
+                                for (std::size_t j = x->count; j > 0; j--) x->move(j - 1, x, j);
+                                left->move(left->count - 1, x, 0);
+                                left->count--;
+                                x->count++;
+                                p->key(k - 1) = x->key(0);
+                                return;
+                        }
+                        if (k < p->count && child(p, k + 1)->count > min_count) {
+                                bplus_tree_leaf <key_t, value_t, capacity> *right = as_leaf(child(p, k + 1));
+                                right->move(0, x, x->count);
+                                for (std::size_t j = 1; j < right->count; j++) right->move(j, right, j - 1);
+                                right->count--;
+                                x->count++;
+                                p->key(k) = right->key(0);
+                                return;
+                        }
+                        merge_leaves(p, k > 0 ? k - 1 : k);
+                        rebalance_internal(p);
+                }
+                void pre_order_traversal(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        x->info();
+                        if (x->leaf) return;
+                        for (std::size_t i = 0; i <= x->count; i++) pre_order_traversal(child(x, i));
+                }
+                void post_order_traversal(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        if (!x->leaf) {
+                                for (std::size_t i = 0; i <= x->count; i++) post_order_traversal(child(x, i));
+                        }
+                        x->info();
+                }
+                void breadth_first_traversal(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        std::queue <bplus_tree_node <key_t, value_t, capacity> *> queue;
+                        if (x == nullptr) return;
+                        queue.push(x);
+                        while(queue.empty() == false) {
+                                bplus_tree_node <key_t, value_t, capacity> *y = queue.front();
+                                y->info();
+                                queue.pop();
+                                if (y->leaf) continue;
+                                for (std::size_t i = 0; i <= y->count; i++) queue.push(child(y, i));
+                        }
+                }
+                unsigned long long height(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        unsigned long long result = 0;
+                        for (; x != nullptr; x = x->leaf ? nullptr : child(x, 0)) result++;
+                        return result;
+                }
+                void clear(bplus_tree_node <key_t, value_t, capacity> *x) {
+                        if (x == nullptr) return;
+                        if (x->leaf) {
+                                for (std::size_t i = 0; i < x->count; i++) as_leaf(x)->destroy(i);
+                        } else {
+                                for (std::size_t i = 0; i <= x->count; i++) clear(child(x, i));
+                                for (std::size_t i = 0; i < x->count; i++) x->destroy_key(i);
+                        }
+                        destroy_node(x);
+                }
+                unsigned long long graphviz(std::ofstream &file, bplus_tree_node <key_t, value_t, capacity> *x, unsigned long long *count) {
+                        unsigned long long id = (*count)++;
+                        file << "\t" << "node" << id << " [label=\"";
+                        if (x->leaf) {
+                                for (std::size_t i = 0; i < x->count; i++) {
+                                        file << (i == 0 ? "" : "|") << x->key(i);
+                                }
+                                file << "\", style=filled, fillcolor=lightgrey];" << std::endl;
+                                return id;
+                        }
+                        for (std::size_t i = 0; i < x->count; i++) {
+                                file << "<c" << i << "> |" << x->key(i) << "|";
+                        }
+                        file << "<c" << x->count << "> \"];" << std::endl;
+                        unsigned long long previous = 0;
+                        for (std::size_t i = 0; i <= x->count; i++) {
+                                unsigned long long y = graphviz(file, child(x, i), count);
+                                file << "\t" << "node" << id << ":c" << i << " -> " << "node" << y << ";" << std::endl;
+                                if (i > 0 && child(x, i)->leaf) file << "\t" << "node" << previous << " -> " << "node" << y << " [style=dashed, constraint=false];" << std::endl;
+                                previous = y;
+                        }
+                        return id;
+                }
+        public:
+                typedef bplus_tree_iterator <key_t, value_t, capacity, value_t> iterator;
+                typedef bplus_tree_iterator <key_t, value_t, capacity, const value_t> const_iterator;
+                typedef std::reverse_iterator <iterator> reverse_iterator;
+                typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+                bplus_tree() {
+                        root = nullptr;
+                        first = nullptr;
+                        last = nullptr;
+                        node_count = 0;
+                }
+                explicit bplus_tree(const compare_t &compare) : compare(compare) {
+                        root = nullptr;
+                        first = nullptr;
+                        last = nullptr;
+                        node_count = 0;
+                }
+                bplus_tree(const bplus_tree &) = delete;
+                bplus_tree &operator=(const bplus_tree &) = delete;
+                bplus_tree(bplus_tree &&other) : compare(std::move(other.compare)) {
+                        root = other.root;
+                        first = other.first;
+                        last = other.last;
+                        node_count = other.node_count;
+                        other.root = nullptr;
+                        other.first = nullptr;
+                        other.last = nullptr;
+                        other.node_count = 0;
+                }
+                bplus_tree &operator=(bplus_tree &&other) {
+                        if (this != &other) {
+                                clear();
+                                compare = std::move(other.compare);
+                                root = other.root;
+                                first = other.first;
+                                last = other.last;
+                                node_count = other.node_count;
+                                other.root = nullptr;
+                                other.first = nullptr;
+                                other.last = nullptr;
+                                other.node_count = 0;
+                        }
+                        return *this;
+                }
+                ~bplus_tree() {
+                        clear();
+                }
+                /**
+                 * @brief Performs a Pre Order Traversal starting from the root node, printing the keys of each node
+                 * @return void
+                 */
+                void pre_order_traversal() {
+                        pre_order_traversal(root);
+                }
+                /**
+                 * @brief Performs a In Order Traversal along the leaves, printing each key
+                 * @return void
+                 */
+                void in_order_traversal() {
+                        for (bplus_tree_leaf <key_t, value_t, capacity> *x = first; x != nullptr; x = x->next) {
+                                for (std::size_t i = 0; i < x->count; i++) std::cout << x->key(i) << std::endl;
+                        }
+                }
+                /**
+                 * @brief Performs a Post Order Traversal starting from the root node, printing the keys of each node
+                 * @return void
+                 */
+                void post_order_traversal() {
+                        post_order_traversal(root);
+                }
+                /**
+                 * @brief Performs a Breadth First Traversal starting from the root node, printing the keys of each node
+                 * @return void
+                 */
+                void breadth_first_traversal() {
+                        breadth_first_traversal(root);
+                }
+                /**
+                 * @brief Generates a DOT file representing the B+ Tree, with dashed edges between neighbouring leaves
+                 * @param filename The filename of the .dot file
+                 * @return void
+                 */
+                void graphviz(std::string filename) {
+                        std::ofstream file;
+                        unsigned long long count = 0;
+                        file.open(filename);
+                        file << "digraph {" << std::endl;
+                        file << "\t" << "node [shape=record];" << std::endl;
+                        if (root != nullptr) graphviz(file, root, &count);
+                        file << "}" << std::endl;
+                        file.close();
+                }
+                /**
+                 * @brief Removes all elements from the B+ Tree
+                 * @return void
+                 */
+                void clear() {
+                        clear(root);
+                        root = nullptr;
+                        first = nullptr;
+                        last = nullptr;
+                        node_count = 0;
+                }
+                /**
+                 * @brief Inserts a new element unless the key already exists
+                 * @param key The key for the new element
+                 * @param value The value for the new element
+                 * @return The new element or nullptr if the key already exists
+                 */
+                b_tree_pointer <key_t, value_t> insert(const key_t &key, const value_t &value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(key, value);
+                        return result.second ? result.first : nullptr;
+                }
+                b_tree_pointer <key_t, value_t> insert(const key_t &key, value_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(key, std::move(value));
+                        return result.second ? result.first : nullptr;
+                }
+                b_tree_pointer <key_t, value_t> insert(key_t &&key, const value_t &value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(std::move(key), value);
+                        return result.second ? result.first : nullptr;
+                }
+                b_tree_pointer <key_t, value_t> insert(key_t &&key, value_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(std::move(key), std::move(value));
+                        return result.second ? result.first : nullptr;
+                }
+                /**
+                 * @brief Inserts a new element whose value is constructed from arguments, unless the key already exists
+                 * @param key The key for the new element
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing element and whether the element was inserted
+                 */
+                template <typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> try_emplace(const key_t &key, args_t &&... args) {
+                        return insert_node(key, std::forward<args_t>(args)...);
+                }
+                template <typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> try_emplace(key_t &&key, args_t &&... args) {
+                        return insert_node(std::move(key), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new element constructed from arguments, unless the key already exists
+                 *
+                 * The key is constructed first since it is needed to find the position of the element.
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing element and whether the element was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> emplace(other_t &&key, args_t &&... args) {
+                        return insert_node(key_t(std::forward<other_t>(key)), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new element or assigns the value of the element with an equivalent key
+                 * @param key The key of the element
+                 * @param value The value to insert or assign
+                 * @return The element holding the value and whether the element was inserted
+                 */
+                template <typename other_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> insert_or_assign(const key_t &key, other_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(key, std::forward<other_t>(value));
+                        // The value is only consumed by insert_node when an element is created
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                template <typename other_t>
+                std::pair <b_tree_pointer <key_t, value_t>, bool> insert_or_assign(key_t &&key, other_t &&value) {
+                        std::pair <b_tree_pointer <key_t, value_t>, bool> result = insert_node(std::move(key), std::forward<other_t>(value));
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                /**
+                 * @brief Applies a function to the value of the element with the key specified, inserting the element first if needed
+                 * @param key The key of the element
+                 * @param function The function called with a reference to the value
+                 * @return The element holding the value
+                 */
+                template <typename function_t>
+                b_tree_pointer <key_t, value_t> upsert(const key_t &key, function_t function) {
+                        b_tree_pointer <key_t, value_t> x = insert_node(key).first;
+                        function(x->value);
+                        return x;
+                }
+                template <typename function_t>
+                b_tree_pointer <key_t, value_t> upsert(key_t &&key, function_t function) {
+                        b_tree_pointer <key_t, value_t> x = insert_node(std::move(key)).first;
+                        function(x->value);
+                        return x;
+                }
+                /**
+                 * @brief Removes the element with the key specified from the B+ Tree
+                 * @param key The key of the element to remove
+                 * @return true if an element was removed and false otherwise
+                 */
+                bool erase(const key_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return false;
+                        erase_element(x.first, x.second);
+                        return true;
+                }
+                /**
+                 * @brief Removes the element with the minimum key
+                 * @return true if an element was removed and false if the B+ Tree is empty
+                 */
+                bool pop_min() {
+                        if (first == nullptr) return false;
+                        erase_element(first, 0);
+                        return true;
+                }
+                /**
+                 * @brief Removes the element with the maximum key
+                 * @return true if an element was removed and false if the B+ Tree is empty
+                 */
+                bool pop_max() {
+                        if (last == nullptr) return false;
+                        erase_element(last, last->count - 1);
+                        return true;
+                }
+                /**
+                 * @brief Searches for a key starting from the root node
+                 *
+                 * The value of the element returned may be modified in place, its key must not.
+                 * @return The element with the key specified or nullptr
+                 */
+                b_tree_pointer <key_t, value_t> search(const key_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                /**
+                 * @brief Searches for a key of another type, requires a transparent comparator
+                 * @return The element with a key equivalent to the key specified or nullptr
+                 */
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                b_tree_pointer <key_t, value_t> search(const other_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                /**
+                 * @brief Searches for a key on a const tree, the element returned is read only
+                 * @return The element with the key specified or nullptr
+                 */
+                b_tree_pointer <key_t, const value_t> search(const key_t &key) const {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, const value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                b_tree_pointer <key_t, const value_t> search(const other_t &key) const {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = find(key);
+                        if (x.first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, const value_t> (x.first->key(x.second), x.first->value(x.second));
+                }
+                /**
+                 * @brief Finds the first element whose key is not less than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the element found or end() if there is none
+                 */
+                iterator lower_bound(const key_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return iterator(x.first, x.second, &last);
+                }
+                const_iterator lower_bound(const key_t &key) const {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return const_iterator(x.first, x.second, &last);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator lower_bound(const other_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return iterator(x.first, x.second, &last);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator lower_bound(const other_t &key) const {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = lower_bound_element(key);
+                        return const_iterator(x.first, x.second, &last);
+                }
+                /**
+                 * @brief Finds the first element whose key is greater than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the element found or end() if there is none
+                 */
+                iterator upper_bound(const key_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return iterator(x.first, x.second, &last);
+                }
+                const_iterator upper_bound(const key_t &key) const {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return const_iterator(x.first, x.second, &last);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator upper_bound(const other_t &key) {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return iterator(x.first, x.second, &last);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator upper_bound(const other_t &key) const {
+                        std::pair <bplus_tree_leaf <key_t, value_t, capacity> *, std::size_t> x = upper_bound_element(key);
+                        return const_iterator(x.first, x.second, &last);
+                }
+                /**
+                 * @brief Finds the range of elements whose key is equal to the key specified
+                 * @param key The key to compare against
+                 * @return The pair lower_bound(key), upper_bound(key)
+                 */
+                std::pair <iterator, iterator> equal_range(const key_t &key) {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                std::pair <const_iterator, const_iterator> equal_range(const key_t &key) const {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                /**
+                 * @brief Calls a function for every element whose key lies in [lo, hi)
+                 *
+                 * Descends once to the leaf of lo and then reads the keys and values of consecutive
+                 * leaves as arrays, so a range of k elements costs O(height + k) with k / capacity
+                 * jumps between leaves.
+                 * @param lo The smallest key of the range
+                 * @param hi The key past the end of the range
+                 * @param function The function called with a constant b_tree_reference to each element, in key order
+                 * @return void
+                 */
+                template <typename function_t>
+                void for_each_in_range(const key_t &lo, const key_t &hi, function_t function) const {
+                        bplus_tree_leaf <key_t, value_t, capacity> *x = find_leaf(lo);
+                        if (x == nullptr) return;
+                        std::size_t i = lower_bound(x, lo);
+                        for (; x != nullptr; x = x->next, i = 0) {
+                                for (; i < x->count; i++) {
+                                        if (!compare(x->key(i), hi)) return;
+                                        function(b_tree_reference <key_t, const value_t> {x->key(i), x->value(i)});
+                                }
+                        }
+                }
+                /**
+                 * @brief Calls a function for every element in key order
+                 * @param function The function called with a constant b_tree_reference to each element
+                 * @return void
+                 */
+                template <typename function_t>
+                void for_each(function_t function) const {
+                        for (bplus_tree_leaf <key_t, value_t, capacity> *x = first; x != nullptr; x = x->next) {
+                                for (std::size_t i = 0; i < x->count; i++) function(b_tree_reference <key_t, const value_t> {x->key(i), x->value(i)});
+                        }
+                }
+                /**
+                 * @brief Copies the elements into an immutable static_search_tree, which is searched faster and may be read by many threads at once
+                 * @return The static_search_tree holding the elements of the B+ Tree
+                 */
+                static_search_tree <key_t, value_t, compare_t> freeze() const {
+                        return static_search_tree <key_t, value_t, compare_t> (begin(), end(), compare);
+                }
+                /**
+                 * @brief Finds the element with the minimum key
+                 * @return The element with the minimum key or nullptr
+                 */
+                b_tree_pointer <key_t, const value_t> minimum() const {
+                        if (first == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, const value_t> (first->key(0), first->value(0));
+                }
+                /**
+                 * @brief Finds the element with the maximum key
+                 * @return The element with the maximum key or nullptr
+                 */
+                b_tree_pointer <key_t, const value_t> maximum() const {
+                        if (last == nullptr) return nullptr;
+                        return b_tree_pointer <key_t, const value_t> (last->key(last->count - 1), last->value(last->count - 1));
+                }
+                /**
+                 * @brief Finds the height of the b+ tree, the number of nodes on every path from the root to a leaf
+                 * @return The height of the b+ tree
+                 */
+                unsigned long long height() {
+                        return height(root);
+                }
+                /**
+                 * @brief Finds the size of the b+ tree
+                 * @return The number of elements of the b+ tree
+                 */
+                unsigned long long size() const {
+                        return node_count;
+                }
+                /**
+                 * @brief Finds if the b+ tree is empty
+                 * @return true if the b+ tree is empty and false otherwise
+                 */
+                bool empty() const {
+                        if (root == nullptr) {
+                                return true;
+                        } else {
+                                return false;
+                        }
+                }
+                /**
+                 * @brief Returns the comparator used to order the keys
+                 * @return A copy of the comparator
+                 */
+                compare_t key_comp() const {
+                        return compare;
+                }
+                /**
+                 * @brief Returns an iterator to the element with the minimum key
+                 * @return An iterator to the first element in key order
+                 */
+                iterator begin() {
+                        return iterator(first, 0, &last);
+                }
+                /**
+                 * @brief Returns an iterator past the element with the maximum key
+                 * @return An iterator past the last element in key order
+                 */
+                iterator end() {
+                        return iterator(nullptr, 0, &last);
+                }
+                const_iterator begin() const {
+                        return const_iterator(first, 0, &last);
+                }
+                const_iterator end() const {
+                        return const_iterator(nullptr, 0, &last);
+                }
+                const_iterator cbegin() const {
+                        return begin();
+                }
+                const_iterator cend() const {
+                        return end();
+                }
+                /**
+                 * @brief Returns a reverse iterator to the element with the maximum key
+                 * @return A reverse iterator to the first element in descending key order
+                 */
+                reverse_iterator rbegin() {
+                        return reverse_iterator(end());
+                }
+                /**
+                 * @brief Returns a reverse iterator past the element with the minimum key
+                 * @return A reverse iterator past the last element in descending key order
+                 */
+                reverse_iterator rend() {
+                        return reverse_iterator(begin());
+                }
+                const_reverse_iterator rbegin() const {
+                        return const_reverse_iterator(end());
+                }
+                const_reverse_iterator rend() const {
+                        return const_reverse_iterator(begin());
+                }
+                const_reverse_iterator crbegin() const {
+                        return rbegin();
+                }
+                const_reverse_iterator crend() const {
+                        return rend();
+                }
+        };
+}
+
+#endif
@@ -0,0 +1,348 @@
+/**
+ * @file cache_oblivious_search_tree.h
+ */
+
+#ifndef CACHE_OBLIVIOUS_SEARCH_TREE_H
+#define CACHE_OBLIVIOUS_SEARCH_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "prefetch.h"
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief An element of a cache_oblivious_search_tree
+         */
+        template <typename key_t, typename value_t>
+        struct cache_oblivious_search_tree_element {
+                key_t key;     ///< The key of the element
+                value_t value; ///< The value of the element
+        };
+        /**
+         * @brief An immutable search tree whose keys are stored in van Emde Boas order
+         *
+         * The keys form an implicit perfect binary search tree of height h, which is laid out
+         * recursively: the top h / 2 levels first, then each of the subtrees hanging below
+         * them, each laid out the same way. Whatever the size of a cache line or a page, a
+         * lookup then reads O(log_B n) blocks of B keys, without tuning the layout to either.
+         * The position of a node is computed from the positions of its ancestors with a small
+         * table of one entry per level, so the array holds nothing but keys.
+         *
+         * The tree is padded to 2^h - 1 keys with copies of the maximum key, which never
+         * change the result of a search. The elements themselves are kept in a sorted array
+         * next to the keys, so in-order iteration is a sequential scan and the tree acts as an
+         * index over it.
+         * @tparam key_t The key type
+         * @tparam value_t The value type
+         * @tparam compare_t The strict weak ordering of the keys
+         */
+        template <typename key_t, typename value_t, typename compare_t = std::less <key_t> >
+        class cache_oblivious_search_tree {
+        public:
+                typedef cache_oblivious_search_tree_element <key_t, value_t> element_t;
+                typedef typename std::vector <element_t>::const_iterator const_iterator;
+                typedef const_iterator iterator;
+                typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+                typedef const_reverse_iterator reverse_iterator;
+        private:
+                static const std::size_t max_height = 64;
+                static const std::size_t search_batch_width = 16; ///< The number of searches of search_batch that descend together
+                compare_t compare;
+                std::size_t levels;
+                std::vector <element_t> elements; ///< The elements in ascending key order
+                std::vector <key_t> keys;         ///< The keys of the implicit tree in van Emde Boas order
+                /**
+                 * @brief How the nodes at one depth are placed, relative to the top tree that has them as bottom tree roots
+                 */
+                struct level {
+                        std::size_t top_depth;   ///< The depth of the root of the top tree
+                        std::size_t top_size;    ///< The size of the top tree, also the mask of the bits that pick a bottom tree
+                        std::size_t bottom_size; ///< The size of the bottom trees rooted at this depth
+                };
+                std::vector <level> placement; ///< The placement of every depth but the root
+                /**
+                 * @brief Splits the subtree of the levels top to top + height - 1 into a top and bottom trees, and those in turn
+                 */
+                void split(std::size_t top, std::size_t height) {
+                        if (height <= 1) return;
+                        std::size_t top_height = height / 2;
+                        std::size_t bottom_height = height - top_height;
+                        std::size_t d = top + top_height;
+                        placement[d].top_depth = top;
+                        placement[d].top_size = (std::size_t(1) << top_height) - 1;
+                        placement[d].bottom_size = (std::size_t(1) << bottom_height) - 1;
+                        split(top, top_height);
+                        split(d, bottom_height);
+                }
+                /**
+                 * @brief Finds the position of the node with breadth first index k at depth d > 0, given the positions of its ancestors
+                 */
+                std::size_t position(const std::size_t *positions, std::size_t d, std::size_t k) const {
+                        const level &x = placement[d];
+                        return positions[x.top_depth] + x.top_size + (k & x.top_size) * x.bottom_size;
+                }
+                /**
+                 * @brief Stores the keys of the subtree of node k at depth d, visiting it in order
+                 */
+                void layout(std::size_t *positions, std::size_t d, std::size_t k, std::size_t &rank) {
+                        if (d == levels) return;
+                        if (d > 0) positions[d] = position(positions, d, k);
+                        layout(positions, d + 1, 2 * k, rank);
+                        if (rank < elements.size()) keys[positions[d]] = elements[rank].key;
+                        rank++;
+                        layout(positions, d + 1, 2 * k + 1, rank);
+                }
+                /**
+                 * @brief The state of a descent: the breadth first index of the node reached, the positions of its ancestors and of the last node where it went left
+                 */
+                struct cursor {
+                        std::size_t k;
+                        std::size_t candidate;
+                        std::size_t positions[max_height];
+                };
+                static void start(cursor &c) {
+                        c.k = 1;
+                        c.candidate = 0;
+                        c.positions[0] = 0;
+                }
+                /**
+                 * @brief Compares the key of the node at depth d and moves to the child on the side of the key specified
+                 *
+                 * Both children are fetched while the key of the node is compared, the right one
+                 * being a bottom tree after the left one.
+                 */
+                template <typename other_t>
+                void step(cursor &c, std::size_t d, const other_t &key) const {
+                        if (d + 1 == levels) {
+                                bool right = compare(keys[c.positions[d]], key);
+                                c.candidate = right ? c.candidate : c.positions[d];
+                                c.k = 2 * c.k + static_cast<std::size_t>(right);
+                                return;
+                        }
+                        const level &x = placement[d + 1];
+                        std::size_t left = position(c.positions, d + 1, 2 * c.k);
+                        prefetch(&keys[left]);
+                        prefetch(&keys[left] + x.bottom_size);
+                        bool right = compare(keys[c.positions[d]], key);
+                        c.candidate = right ? c.candidate : c.positions[d];
+                        c.k = 2 * c.k + static_cast<std::size_t>(right);
+                        c.positions[d + 1] = left + (right ? x.bottom_size : 0);
+                }
+                /**
+                 * @brief Finds the lower bound a finished descent found
+                 *
+                 * The descent goes to the right child when the key of the node is less than the key
+                 * specified, so the breadth first index of the last node reached spells the path. The
+                 * lower bound is the last node where the descent went left, and as the tree is perfect
+                 * its rank follows from its depth and index.
+                 * @param rank Set to the rank found, or size() if every key is less than the key specified
+                 * @return The position of the key found in the van Emde Boas array, if any
+                 */
+                std::size_t finish(const cursor &c, std::size_t &rank) const {
+                        rank = elements.size();
+                        // Shift out the right turns at the bottom and the left turn above them
+                        std::size_t k = c.k;
+                        std::size_t shift = 1;
+                        while (k & 1) {
+                                k >>= 1;
+                                shift++;
+                        }
+                        k >>= 1;
+                        if (k == 0) return 0;
+                        // The node at depth levels - shift has shift - 1 levels below it, and rank (2i + 1) 2^(shift - 1) - 1 for index i in its level
+                        std::size_t depth = levels - shift;
+                        std::size_t found = ((2 * (k - (std::size_t(1) << depth)) + 1) << (shift - 1)) - 1;
+                        if (found < elements.size()) rank = found;
+                        return c.candidate;
+                }
+                /**
+                 * @brief Finds the first key that is not less than the key specified
+                 * @param rank Set to the rank found, or size() if every key is less than the key specified
+                 * @return The position of the key found in the van Emde Boas array, if any
+                 */
+                template <typename other_t>
+                std::size_t lower_bound_position(const other_t &key, std::size_t &rank) const {
+                        rank = elements.size();
+                        if (levels == 0) return 0;
+                        cursor c;
+                        start(c);
+                        for (std::size_t d = 0; d < levels; d++) step(c, d, key);
+                        return finish(c, rank);
+                }
+                template <typename other_t>
+                std::size_t lower_bound_rank(const other_t &key) const {
+                        std::size_t rank;
+                        lower_bound_position(key, rank);
+                        return rank;
+                }
+                template <typename other_t>
+                const element_t *find(const other_t &key) const {
+                        std::size_t rank;
+                        std::size_t position = lower_bound_position(key, rank);
+                        // The key is compared in the array the descent just read rather than in the elements
+                        if (rank == elements.size() || compare(key, keys[position])) return nullptr;
+                        return &elements[rank];
+                }
+        public:
+                cache_oblivious_search_tree() : levels(0) {
+
+                }
+                /**
+                 * @brief Builds a cache_oblivious_search_tree from elements in ascending key order
+                 * @param first An iterator to the first element, which has key and value members like the elements of every forest tree
+                 * @param last An iterator past the last element
+                 * @param compare The ordering the elements are sorted by
+                 */
+                template <typename iterator_t>
+                cache_oblivious_search_tree(iterator_t first, iterator_t last, const compare_t &compare = compare_t()) : compare(compare), levels(0) {
+                        elements.reserve(static_cast<std::size_t>(std::distance(first, last)));
+                        for (; first != last; ++first) {
+                                elements.push_back(element_t {(*first).key, (*first).value});
+                        }
+                        if (elements.empty()) return;
+                        while ((std::size_t(1) << levels) - 1 < elements.size()) levels++;
+                        placement.assign(levels, level());
+                        split(0, levels);
+                        keys.assign((std::size_t(1) << levels) - 1, elements.back().key);
+                        std::size_t positions[max_height];
+                        positions[0] = 0;
+                        std::size_t rank = 0;
+                        layout(positions, 0, 1, rank);
+                }
+                /**
+                 * @brief Builds a cache_oblivious_search_tree from the in-order contents of any forest tree
+                 * @param tree The tree to copy, which is left unchanged
+                 * @return The cache_oblivious_search_tree holding the elements of the tree
+                 */
+                template <typename tree_t>
+                static cache_oblivious_search_tree from_tree(const tree_t &tree) {
+                        return cache_oblivious_search_tree(tree.begin(), tree.end(), tree.key_comp());
+                }
+                /**
+                 * @brief Searches for a key
+                 * @return The element with the key specified or nullptr
+                 */
+                const element_t *search(const key_t &key) const {
+                        return find(key);
+                }
+                /**
+                 * @brief Searches for a key of another type, requires a transparent comparator
+                 * @return The element with a key equivalent to the key specified or nullptr
+                 */
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const element_t *search(const other_t &key) const {
+                        return find(key);
+                }
+                /**
+                 * @brief Searches for several keys at once, overlapping their cache misses
+                 *
+                 * Groups of search_batch_width searches descend in lockstep, one level of each search
+                 * in turn, so the loads and prefetches of the group are in flight together.
+                 * @param queries The keys to search for
+                 * @param n The number of keys
+                 * @param out Set to the element with each key, or nullptr
+                 * @return void
+                 */
+                void search_batch(const key_t *queries, std::size_t n, const element_t **out) const {
+                        for (std::size_t first = 0; first < n; first += search_batch_width) {
+                                std::size_t m = n - first < search_batch_width ? n - first : search_batch_width;
+                                if (levels == 0) {
+                                        for (std::size_t i = 0; i < m; i++) out[first + i] = nullptr;
+                                        continue;
+                                }
+                                cursor c[search_batch_width];
+                                for (std::size_t i = 0; i < m; i++) start(c[i]);
+                                for (std::size_t d = 0; d < levels; d++) {
+                                        for (std::size_t i = 0; i < m; i++) step(c[i], d, queries[first + i]);
+                                }
+                                for (std::size_t i = 0; i < m; i++) {
+                                        std::size_t rank;
+                                        std::size_t position = finish(c[i], rank);
+                                        out[first + i] = rank == elements.size() || compare(queries[first + i], keys[position]) ? nullptr : &elements[rank];
+                                }
+                        }
+                }
+                /**
+                 * @brief Finds the first element whose key is not less than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the element found or end() if there is none
+                 */
+                const_iterator lower_bound(const key_t &key) const {
+                        return elements.begin() + static_cast<std::ptrdiff_t>(lower_bound_rank(key));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator lower_bound(const other_t &key) const {
+                        return elements.begin() + static_cast<std::ptrdiff_t>(lower_bound_rank(key));
+                }
+                /**
+                 * @brief Finds the height of the implicit tree
+                 * @return The number of levels of the implicit tree
+                 */
+                unsigned long long height() const {
+                        return levels;
+                }
+                /**
+                 * @brief Finds the size of the cache_oblivious_search_tree
+                 * @return The number of elements of the cache_oblivious_search_tree
+                 */
+                unsigned long long size() const {
+                        return elements.size();
+                }
+                /**
+                 * @brief Finds if the cache_oblivious_search_tree is empty
+                 * @return true if the cache_oblivious_search_tree is empty and false otherwise
+                 */
+                bool empty() const {
+                        return elements.empty();
+                }
+                /**
+                 * @brief Returns the comparator used to order the keys
+                 * @return A copy of the comparator
+                 */
+                compare_t key_comp() const {
+                        return compare;
+                }
+                /**
+                 * @brief Returns an iterator to the element with the minimum key
+                 * @return An iterator to the first element in key order
+                 */
+                const_iterator begin() const {
+                        return elements.begin();
+                }
+                /**
+                 * @brief Returns an iterator past the element with the maximum key
+                 * @return An iterator past the last element in key order
+                 */
+                const_iterator end() const {
+                        return elements.end();
+                }
+                const_iterator cbegin() const {
+                        return begin();
+                }
+                const_iterator cend() const {
+                        return end();
+                }
+                const_reverse_iterator rbegin() const {
+                        return const_reverse_iterator(end());
+                }
+                const_reverse_iterator rend() const {
+                        return const_reverse_iterator(begin());
+                }
+                const_reverse_iterator crbegin() const {
+                        return rbegin();
+                }
+                const_reverse_iterator crend() const {
+                        return rend();
+                }
+        };
+}
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file concurrent.h
+ */
+
+#ifndef CONCURRENT_H
+#define CONCURRENT_H
+
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<shared_mutex>)
+#include <shared_mutex>
+#endif
+#endif
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief A reader writer lock for compilers without std::shared_mutex, which came with C++17
+         *
+         * Writers waiting for the lock keep new readers out, so a steady stream of readers
+         * does not starve them.
+         */
+        class reader_writer_mutex {
+        private:
+                std::mutex mutex;
+                std::condition_variable readers_turn;
+                std::condition_variable writers_turn;
+                unsigned long long readers;
+                unsigned long long waiting_writers;
+                bool writing;
+        public:
+                reader_writer_mutex() : readers(0), waiting_writers(0), writing(false) {
+
+                }
+                reader_writer_mutex(const reader_writer_mutex &) = delete;
+                reader_writer_mutex &operator=(const reader_writer_mutex &) = delete;
+                void lock() {
+                        std::unique_lock <std::mutex> guard(mutex);
+                        waiting_writers++;
+                        while (writing || readers > 0) writers_turn.wait(guard);
+                        waiting_writers--;
+                        writing = true;
+                }
+                void unlock() {
+                        std::lock_guard <std::mutex> guard(mutex);
+                        writing = false;
+                        if (waiting_writers > 0) {
+                                writers_turn.notify_one();
+                        } else {
+                                readers_turn.notify_all();
+                        }
+                }
+                void lock_shared() {
+                        std::unique_lock <std::mutex> guard(mutex);
+                        while (writing || waiting_writers > 0) readers_turn.wait(guard);
+                        readers++;
+                }
+                void unlock_shared() {
+                        std::lock_guard <std::mutex> guard(mutex);
+                        readers--;
+                        if (readers == 0 && waiting_writers > 0) writers_turn.notify_one();
+                }
+        };
+#if defined(__cpp_lib_shared_mutex)
+        typedef std::shared_mutex default_shared_mutex; ///< The reader writer lock of concurrent unless another is given
+#else
+        typedef reader_writer_mutex default_shared_mutex; ///< The reader writer lock of concurrent unless another is given
+#endif
+        /**
+         * @brief Holds the shared side of a reader writer lock for a scope, std::shared_lock being C++14
+         */
+        template <typename mutex_t>
+        class shared_lock_guard {
+        private:
+                mutex_t &mutex;
+        public:
+                explicit shared_lock_guard(mutex_t &mutex) : mutex(mutex) {
+                        mutex.lock_shared();
+                }
+                shared_lock_guard(const shared_lock_guard &) = delete;
+                shared_lock_guard &operator=(const shared_lock_guard &) = delete;
+                ~shared_lock_guard() {
+                        mutex.unlock_shared();
+                }
+        };
+        /**
+         * @brief A tree shared between threads, read under a shared lock and written under an exclusive one
+         *
+         * Nodes never leave the lock: lookups hand them to a function called while the lock is
+         * held. Reads see the tree through a const reference, so the compiler rejects a read that
+         * would change it.
+         * @tparam tree_t The tree type, e.g. forest::red_black_tree <int, int>
+         * @tparam mutex_t The reader writer lock, with lock, unlock, lock_shared and unlock_shared
+         */
+        template <typename tree_t, typename mutex_t = default_shared_mutex>
+        class concurrent {
+        private:
+                struct ignore {
+                        template <typename type_t>
+                        void operator()(const type_t &) const {
+
+                        }
+                };
+                tree_t tree;
+                mutable mutex_t mutex;
+        public:
+                template <typename... args_t>
+                explicit concurrent(args_t &&... args) : tree(std::forward<args_t>(args)...) {
+
+                }
+                concurrent(const concurrent &) = delete;
+                concurrent &operator=(const concurrent &) = delete;
+                /**
+                 * @brief Searches for a key and calls a function on the node found, under the shared lock
+                 * @param key The key to search for
+                 * @param function Called with a const reference to the node, or element, with the key
+                 * @return Whether the key was found
+                 */
+                template <typename other_t, typename function_t>
+                bool search(const other_t &key, function_t function) const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        auto x = tree.search(key);
+                        if (x == nullptr) return false;
+                        function(*x);
+                        return true;
+                }
+                /**
+                 * @brief Checks whether the tree has a key
+                 */
+                template <typename other_t>
+                bool contains(const other_t &key) const {
+                        return search(key, ignore());
+                }
+                /**
+                 * @brief Calls a function on the node, or element, with the minimum key, under the shared lock
+                 * @return Whether the tree has any keys
+                 */
+                template <typename function_t>
+                bool minimum(function_t function) const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        auto x = tree.minimum();
+                        if (x == nullptr) return false;
+                        function(*x);
+                        return true;
+                }
+                /**
+                 * @brief Calls a function on the node, or element, with the maximum key, under the shared lock
+                 * @return Whether the tree has any keys
+                 */
+                template <typename function_t>
+                bool maximum(function_t function) const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        auto x = tree.maximum();
+                        if (x == nullptr) return false;
+                        function(*x);
+                        return true;
+                }
+                /**
+                 * @brief Calls a function on every node, or element, in key order, under the shared lock
+                 */
+                template <typename function_t>
+                void for_each(function_t function) const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        for (const auto &x : tree) {
+                                function(x);
+                        }
+                }
+                /**
+                 * @brief Calls a function on every node, or element, with a key in [lo, hi), under the shared lock
+                 */
+                template <typename key_t, typename function_t>
+                void for_each_in_range(const key_t &lo, const key_t &hi, function_t function) const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        tree.for_each_in_range(lo, hi, function);
+                }
+                /**
+                 * @brief Calls a function with a const reference to the tree, under the shared lock
+                 * @return What the function returns
+                 */
+                template <typename function_t>
+                auto read(function_t function) const -> decltype(function(std::declval <const tree_t &> ())) {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        return function(tree);
+                }
+                /**
+                 * @brief Calls a function with a reference to the tree, under the exclusive lock
+                 * @return What the function returns
+                 */
+                template <typename function_t>
+                auto write(function_t function) -> decltype(function(std::declval <tree_t &> ())) {
+                        std::lock_guard <mutex_t> guard(mutex);
+                        return function(tree);
+                }
+                /**
+                 * @brief Inserts a key and a value under the exclusive lock
+                 * @return Whether the key was new
+                 */
+                template <typename key_t, typename value_t>
+                bool insert(key_t &&key, value_t &&value) {
+                        std::lock_guard <mutex_t> guard(mutex);
+                        return tree.try_emplace(std::forward<key_t>(key), std::forward<value_t>(value)).second;
+                }
+                /**
+                 * @brief Erases a key under the exclusive lock
+                 * @return Whether the key was found
+                 */
+                template <typename key_t>
+                bool erase(const key_t &key) {
+                        std::lock_guard <mutex_t> guard(mutex);
+                        return tree.erase(key);
+                }
+                /**
+                 * @brief Erases every key under the exclusive lock
+                 */
+                void clear() {
+                        std::lock_guard <mutex_t> guard(mutex);
+                        tree.clear();
+                }
+                unsigned long long size() const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        return tree.size();
+                }
+                bool empty() const {
+                        shared_lock_guard <mutex_t> guard(mutex);
+                        return tree.empty();
+                }
+        };
+}
+
+#endif
@@ -0,0 +1,292 @@
+/**
+ * @file index_storage.h
+ */
+
+#ifndef INDEX_STORAGE_H
+#define INDEX_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief A 32 bit link from a node to another node of the same array
+         *
+         * The link stores the distance from itself to the target in units of 4 bytes, and 0 for
+         * nullptr, so it behaves like a node_t * while taking half the space. Since the
+         * distance is relative, an array of linked nodes stays valid when its bytes are moved
+         * or copied as a whole, which is what node_vector does. Assigning one link to another
+         * assigns the target, like assigning pointers.
+         * @tparam node_t The node type, which must be at least 4 byte aligned
+         */
+        template <typename node_t>
+        class relative_pointer {
+        private:
+                std::int32_t offset;
+                static char *address(const void *x) {
+                        return const_cast<char *>(static_cast<const char *>(x));
+                }
+        public:
+                relative_pointer() {
+                        offset = 0;
+                }
+                relative_pointer(node_t *x) {
+                        *this = x;
+                }
+                relative_pointer(const relative_pointer &other) {
+                        *this = other.get();
+                }
+                relative_pointer &operator=(const relative_pointer &other) {
+                        return *this = other.get();
+                }
+                relative_pointer &operator=(node_t *x) {
+                        offset = x == nullptr ? 0 : static_cast<std::int32_t>((address(x) - address(this)) / 4);
+                        return *this;
+                }
+                node_t *get() const {
+                        if (offset == 0) return nullptr;
+                        return reinterpret_cast<node_t *>(address(this) + static_cast<std::ptrdiff_t>(offset) * 4);
+                }
+                operator node_t *() const {
+                        return get();
+                }
+                node_t *operator->() const {
+                        return get();
+                }
+                node_t &operator*() const {
+                        return *get();
+                }
+        };
+        /**
+         * @brief Stands in for node_vector in trees whose nodes are allocated one by one
+         */
+        struct no_node_vector {
+                no_node_vector() {
+
+                }
+                template <typename allocator_t>
+                explicit no_node_vector(const allocator_t &) {
+
+                }
+        };
+        /**
+         * @brief A contiguous array of nodes linked by relative_pointer with a free list of erased slots
+         *
+         * Growing the array moves every node at once by copying bytes, so node_t must be
+         * trivially copyable apart from its links. Growth invalidates pointers to the nodes: grow
+         * returns the distance the nodes moved so that the owner can move its own pointers too.
+         * Since links are at most 2^31 units of 4 bytes long the array is limited to 8 GiB.
+         * @tparam node_t The node type
+         * @tparam allocator_t The allocator the array is obtained from
+         */
+        template <typename node_t, typename allocator_t = std::allocator <node_t> >
+        class node_vector {
+        private:
+                typedef typename std::aligned_storage <sizeof(node_t), alignof(node_t)>::type slot_t;
+                typedef typename std::allocator_traits <allocator_t>::template rebind_alloc <slot_t> slot_allocator_t;
+                typedef std::allocator_traits <slot_allocator_t> slot_allocator_traits;
+                static_assert(sizeof(slot_t) >= sizeof(std::size_t), "a free slot must hold the index of the next free slot");
+                slot_allocator_t allocator;
+                slot_t *slots;
+                std::size_t capacity;
+                std::size_t used;      ///< The number of slots handed out at least once
+                std::size_t free_list; ///< The index of the first free slot plus one, or 0 if there is none
+                static std::size_t max_size() {
+                        return (static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()) * 4) / sizeof(slot_t);
+                }
+                void release() {
+                        if (slots != nullptr) slot_allocator_traits::deallocate(allocator, slots, capacity);
+                        slots = nullptr;
+                        capacity = 0;
+                        used = 0;
+                        free_list = 0;
+                }
+        public:
+                node_vector() {
+                        slots = nullptr;
+                        capacity = 0;
+                        used = 0;
+                        free_list = 0;
+                }
+                explicit node_vector(const allocator_t &allocator) : allocator(allocator) {
+                        slots = nullptr;
+                        capacity = 0;
+                        used = 0;
+                        free_list = 0;
+                }
+                node_vector(const node_vector &other) : allocator(slot_allocator_traits::select_on_container_copy_construction(other.allocator)) {
+                        slots = nullptr;
+                        capacity = 0;
+                        used = 0;
+                        free_list = 0;
+                        if (other.used == 0) return;
+                        slots = slot_allocator_traits::allocate(allocator, other.used);
+                        capacity = other.used;
+                        used = other.used;
+                        free_list = other.free_list;
+                        std::memcpy(static_cast<void *>(slots), static_cast<const void *>(other.slots), used * sizeof(slot_t));
+                }
+                node_vector &operator=(const node_vector &) = delete;
+                node_vector(node_vector &&other) : allocator(std::move(other.allocator)) {
+                        slots = other.slots;
+                        capacity = other.capacity;
+                        used = other.used;
+                        free_list = other.free_list;
+                        other.slots = nullptr;
+                        other.capacity = 0;
+                        other.used = 0;
+                        other.free_list = 0;
+                }
+                node_vector &operator=(node_vector &&other) {
+                        if (this != &other) {
+                                release();
+                                allocator = std::move(other.allocator);
+                                slots = other.slots;
+                                capacity = other.capacity;
+                                used = other.used;
+                                free_list = other.free_list;
+                                other.slots = nullptr;
+                                other.capacity = 0;
+                                other.used = 0;
+                                other.free_list = 0;
+                        }
+                        return *this;
+                }
+                ~node_vector() {
+                        release();
+                }
+                /**
+                 * @brief Finds whether the next allocation needs to grow the array
+                 */
+                bool full() const {
+                        return free_list == 0 && used == capacity;
+                }
+                /**
+                 * @brief Grows the array so that it holds at least n slots
+                 * @param n The number of slots
+                 * @return The number of bytes every node moved by, 0 if the nodes did not move
+                 */
+                std::ptrdiff_t reserve(std::size_t n) {
+                        if (n <= capacity) return 0;
+                        if (n > max_size()) throw std::length_error("forest::node_vector exceeds the range of its 32 bit links");
+                        slot_t *x = slot_allocator_traits::allocate(allocator, n);
+                        std::ptrdiff_t delta = 0;
+                        if (slots != nullptr) {
+                                std::memcpy(static_cast<void *>(x), static_cast<const void *>(slots), used * sizeof(slot_t));
+                                delta = reinterpret_cast<char *>(x) - reinterpret_cast<char *>(slots);
+                                slot_allocator_traits::deallocate(allocator, slots, capacity);
+                        }
+                        slots = x;
+                        capacity = n;
+                        return delta;
+                }
+                /**
+                 * @brief Makes room for one more node, doubling the array if it is full
+                 * @return The number of bytes every node moved by, 0 if the nodes did not move
+                 */
+                std::ptrdiff_t grow() {
+                        if (!full()) return 0;
+                        std::size_t n = capacity < 16 ? 16 : capacity * 2;
+                        // Past the limit reserve throws once not even one more slot fits
+                        if (n > max_size()) n = std::max(max_size(), capacity + 1);
+                        return reserve(n);
+                }
+                /**
+                 * @brief Constructs a node in a free slot, the array must not be full
+                 * @param args The arguments the node is constructed from
+                 * @return The new node
+                 */
+                template <typename... args_t>
+                node_t *allocate(args_t &&... args) {
+                        slot_t *x;
+                        if (free_list != 0) {
+                                x = slots + (free_list - 1);
+                                std::memcpy(&free_list, static_cast<const void *>(x), sizeof(free_list));
+                        } else {
+                                x = slots + used++;
+                        }
+                        return ::new (static_cast<void *>(x)) node_t(std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Returns the slot of a node to the free list
+                 * @param x A node obtained from allocate
+                 * @return void
+                 */
+                void deallocate(node_t *x) {
+                        std::size_t next = free_list;
+                        free_list = static_cast<std::size_t>(reinterpret_cast<slot_t *>(x) - slots) + 1;
+                        std::memcpy(static_cast<void *>(x), &next, sizeof(next));
+                }
+                /**
+                 * @brief Forgets every node while keeping the array
+                 * @return void
+                 */
+                void clear() {
+                        used = 0;
+                        free_list = 0;
+                }
+                /**
+                 * @brief Finds the position of a node in the array
+                 * @param x A node of the array or nullptr
+                 * @return The index of the slot of x or -1 for nullptr
+                 */
+                std::int64_t index(const node_t *x) const {
+                        if (x == nullptr) return -1;
+                        return reinterpret_cast<const slot_t *>(x) - slots;
+                }
+                /**
+                 * @brief Finds the node in a slot of the array
+                 * @param i The index of the slot or -1
+                 * @return The node in the slot or nullptr for -1
+                 */
+                node_t *at(std::int64_t i) const {
+                        if (i < 0) return nullptr;
+                        return reinterpret_cast<node_t *>(slots + i);
+                }
+                /**
+                 * @brief Finds the number of bytes the array occupies
+                 */
+                std::size_t capacity_bytes() const {
+                        return capacity * sizeof(slot_t);
+                }
+                /**
+                 * @brief Writes the slots in use as raw bytes
+                 * @param stream The binary stream to write to
+                 * @return void
+                 */
+                void write(std::ostream &stream) const {
+                        std::uint64_t header[2] = {used, free_list};
+                        stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+                        stream.write(reinterpret_cast<const char *>(slots), static_cast<std::streamsize>(used * sizeof(slot_t)));
+                }
+                /**
+                 * @brief Replaces the slots with the ones written by write
+                 * @param stream The binary stream to read from
+                 * @return void
+                 */
+                void read(std::istream &stream) {
+                        std::uint64_t header[2] = {0, 0};
+                        stream.read(reinterpret_cast<char *>(header), sizeof(header));
+                        release();
+                        if (!stream || header[0] == 0) return;
+                        reserve(static_cast<std::size_t>(header[0]));
+                        stream.read(reinterpret_cast<char *>(slots), static_cast<std::streamsize>(header[0] * sizeof(slot_t)));
+                        if (!stream) throw std::runtime_error("forest::node_vector could not read its nodes");
+                        used = static_cast<std::size_t>(header[0]);
+                        free_list = static_cast<std::size_t>(header[1]);
+                }
+        };
+}
+
+#endif
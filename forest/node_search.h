@@ -0,0 +1,283 @@
+/**
+ * @file node_search.h
+ */
+
+#ifndef NODE_SEARCH_H
+#define NODE_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief The vector operations used to compare a key against the keys of a node, for key types the target supports
+         *
+         * A specialization loads width keys at a time and returns a bit mask with bit i set when
+         * key i is less than (or not greater than) the key searched for. The instruction set is
+         * chosen when compiling: AVX2 when enabled, SSE2 otherwise, and no specialization at
+         * all on other targets, where node_search falls back to a binary search.
+         */
+        template <typename key_t>
+        struct simd_lanes {
+                static const bool available = false;
+        };
+#if defined(__AVX2__)
+        template <>
+        struct simd_lanes <std::int32_t> {
+                static const bool available = true;
+                static const std::size_t width = 8;
+                static const unsigned all = 0xff;
+                typedef __m256i vector_t;
+                static vector_t broadcast(std::int32_t key) {
+                        return _mm256_set1_epi32(key);
+                }
+                static vector_t load(const std::int32_t *keys) {
+                        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys));
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, keys))));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return all ^ static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(keys, key))));
+                }
+        };
+        template <>
+        struct simd_lanes <std::int64_t> {
+                static const bool available = true;
+                static const std::size_t width = 4;
+                static const unsigned all = 0xf;
+                typedef __m256i vector_t;
+                static vector_t broadcast(std::int64_t key) {
+                        return _mm256_set1_epi64x(key);
+                }
+                static vector_t load(const std::int64_t *keys) {
+                        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys));
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, keys))));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return all ^ static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(keys, key))));
+                }
+        };
+        template <>
+        struct simd_lanes <float> {
+                static const bool available = true;
+                static const std::size_t width = 8;
+                static const unsigned all = 0xff;
+                typedef __m256 vector_t;
+                static vector_t broadcast(float key) {
+                        return _mm256_set1_ps(key);
+                }
+                static vector_t load(const float *keys) {
+                        return _mm256_loadu_ps(keys);
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(keys, key, _CMP_LT_OQ)));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(keys, key, _CMP_LE_OQ)));
+                }
+        };
+        template <>
+        struct simd_lanes <double> {
+                static const bool available = true;
+                static const std::size_t width = 4;
+                static const unsigned all = 0xf;
+                typedef __m256d vector_t;
+                static vector_t broadcast(double key) {
+                        return _mm256_set1_pd(key);
+                }
+                static vector_t load(const double *keys) {
+                        return _mm256_loadu_pd(keys);
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(keys, key, _CMP_LT_OQ)));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(keys, key, _CMP_LE_OQ)));
+                }
+        };
+#elif defined(__SSE2__)
+        template <>
+        struct simd_lanes <std::int32_t> {
+                static const bool available = true;
+                static const std::size_t width = 4;
+                static const unsigned all = 0xf;
+                typedef __m128i vector_t;
+                static vector_t broadcast(std::int32_t key) {
+                        return _mm_set1_epi32(key);
+                }
+                static vector_t load(const std::int32_t *keys) {
+                        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys));
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, keys))));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return all ^ static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(keys, key))));
+                }
+        };
+#if defined(__SSE4_2__)
+        template <>
+        struct simd_lanes <std::int64_t> {
+                static const bool available = true;
+                static const std::size_t width = 2;
+                static const unsigned all = 0x3;
+                typedef __m128i vector_t;
+                static vector_t broadcast(std::int64_t key) {
+                        return _mm_set1_epi64x(key);
+                }
+                static vector_t load(const std::int64_t *keys) {
+                        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys));
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(key, keys))));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return all ^ static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(keys, key))));
+                }
+        };
+#endif
+        template <>
+        struct simd_lanes <float> {
+                static const bool available = true;
+                static const std::size_t width = 4;
+                static const unsigned all = 0xf;
+                typedef __m128 vector_t;
+                static vector_t broadcast(float key) {
+                        return _mm_set1_ps(key);
+                }
+                static vector_t load(const float *keys) {
+                        return _mm_loadu_ps(keys);
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(keys, key)));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(keys, key)));
+                }
+        };
+        template <>
+        struct simd_lanes <double> {
+                static const bool available = true;
+                static const std::size_t width = 2;
+                static const unsigned all = 0x3;
+                typedef __m128d vector_t;
+                static vector_t broadcast(double key) {
+                        return _mm_set1_pd(key);
+                }
+                static vector_t load(const double *keys) {
+                        return _mm_loadu_pd(keys);
+                }
+                static unsigned less(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmplt_pd(keys, key)));
+                }
+                static unsigned less_equal(vector_t keys, vector_t key) {
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmple_pd(keys, key)));
+                }
+        };
+#endif
+        /**
+         * @brief Names the instruction set node_search was compiled for
+         * @return "AVX2", "SSE2" or "scalar"
+         */
+        inline const char *node_search_instruction_set() {
+#if defined(__AVX2__)
+                return "AVX2";
+#elif defined(__SSE2__)
+                return "SSE2";
+#else
+                return "scalar";
+#endif
+        }
+        /**
+         * @brief Searches the sorted keys of a node with a binary search
+         *
+         * The wide-node trees search their nodes through this class, so key types that can be
+         * compared in vector registers get a faster search by specialization.
+         */
+        template <typename key_t, typename compare_t>
+        struct node_search {
+                /**
+                 * @brief Finds the index of the first of count keys that is not less than the key specified
+                 */
+                template <typename other_t>
+                static std::size_t lower_bound(const key_t *keys, std::size_t count, const other_t &key, const compare_t &compare) {
+                        return std::lower_bound(keys, keys + count, key, compare) - keys;
+                }
+                /**
+                 * @brief Finds the index of the first of count keys that is greater than the key specified
+                 */
+                template <typename other_t>
+                static std::size_t upper_bound(const key_t *keys, std::size_t count, const other_t &key, const compare_t &compare) {
+                        return std::upper_bound(keys, keys + count, key, compare) - keys;
+                }
+        };
+        /**
+         * @brief Searches the sorted keys of a node with vector compares when key_t has simd_lanes
+         *
+         * Larger nodes are first narrowed by binary search to a window of 8 vectors. The window is
+         * then compared a vector at a time, and as the keys are sorted the first vector that is
+         * not entirely less than the key holds the answer, which is the number of set bits of
+         * its mask. Only std::less is specialized, since any other comparator may order the keys
+         * differently from the vector compares.
+         */
+        template <typename key_t>
+        struct node_search <key_t, std::less <key_t> > {
+        private:
+                template <bool or_equal>
+                static bool before(const key_t &x, const key_t &key) {
+                        return or_equal ? !(key < x) : x < key;
+                }
+                template <bool or_equal>
+                static std::size_t count_before(const key_t *keys, std::size_t count, const key_t &key, std::true_type) {
+                        typedef simd_lanes <key_t> lanes_t;
+                        const std::size_t window = 8 * lanes_t::width;
+                        std::size_t first = 0;
+                        while (count > window) {
+                                std::size_t half = count / 2;
+                                if (before <or_equal> (keys[first + half], key)) {
+                                        first += half + 1;
+                                        count -= half + 1;
+                                } else {
+                                        count = half;
+                                }
+                        }
+                        const std::size_t last = first + count;
+                        const typename lanes_t::vector_t vector = lanes_t::broadcast(key);
+                        std::size_t i = first;
+                        for (; i + lanes_t::width <= last; i += lanes_t::width) {
+                                unsigned mask = or_equal ? lanes_t::less_equal(lanes_t::load(keys + i), vector) : lanes_t::less(lanes_t::load(keys + i), vector);
+                                if (mask != lanes_t::all) return i + static_cast<std::size_t>(__builtin_popcount(mask));
+                        }
+                        // The slots past count hold no keys, so the last few keys are compared one by one
+                        while (i < last && before <or_equal> (keys[i], key)) i++;
+                        return i;
+                }
+                template <bool or_equal>
+                static std::size_t count_before(const key_t *keys, std::size_t count, const key_t &key, std::false_type) {
+                        if (or_equal) return std::upper_bound(keys, keys + count, key) - keys;
+                        return std::lower_bound(keys, keys + count, key) - keys;
+                }
+        public:
+                static std::size_t lower_bound(const key_t *keys, std::size_t count, const key_t &key, const std::less <key_t> &) {
+                        return count_before <false> (keys, count, key, std::integral_constant <bool, simd_lanes <key_t>::available> ());
+                }
+                static std::size_t upper_bound(const key_t *keys, std::size_t count, const key_t &key, const std::less <key_t> &) {
+                        return count_before <true> (keys, count, key, std::integral_constant <bool, simd_lanes <key_t>::available> ());
+                }
+        };
+}
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file pool_allocator.h
+ */
+
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief A pool allocator that carves single objects out of large contiguous blocks
+         *
+         * Single object allocations are served from a free list of recycled slots or carved
+         * from the current block, so inserting a node costs a pointer bump instead of a call
+         * to malloc. Every block is released at once when the allocator is destroyed.
+         * Each allocator owns its own pool: copies and rebound copies start with an empty pool.
+         * @tparam T The type of the objects to allocate
+         * @tparam block_size The number of objects carved from each block
+         */
+        template <typename T, std::size_t block_size = 4096>
+        class pool_allocator {
+                static_assert(block_size > 0, "block_size must be greater than zero");
+                static_assert(alignof(T) <= alignof(std::max_align_t), "blocks come from ::operator new, which only aligns to alignof(std::max_align_t)");
+        private:
+                union slot {
+                        slot *next;
+                        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+                };
+                slot *free_list;
+                slot *cursor;
+                slot *end;
+                std::vector <slot *> blocks;
+                void grow() {
+                        slot *block = static_cast<slot *>(::operator new(block_size * sizeof(slot)));
+                        blocks.push_back(block);
+                        cursor = block;
+                        end = block + block_size;
+                }
+        public:
+                typedef T value_type;
+                typedef T *pointer;
+                typedef const T *const_pointer;
+                typedef T &reference;
+                typedef const T &const_reference;
+                typedef std::size_t size_type;
+                typedef std::ptrdiff_t difference_type;
+                template <typename U>
+                struct rebind {
+                        typedef pool_allocator <U, block_size> other;
+                };
+                pool_allocator() {
+                        free_list = nullptr;
+                        cursor = nullptr;
+                        end = nullptr;
+                }
+                pool_allocator(const pool_allocator &) : pool_allocator() {
+
+                }
+                template <typename U>
+                pool_allocator(const pool_allocator <U, block_size> &) : pool_allocator() {
+
+                }
+                pool_allocator(pool_allocator &&other) : blocks(std::move(other.blocks)) {
+                        free_list = other.free_list;
+                        cursor = other.cursor;
+                        end = other.end;
+                        other.free_list = nullptr;
+                        other.cursor = nullptr;
+                        other.end = nullptr;
+                        other.blocks.clear();
+                }
+                pool_allocator &operator=(const pool_allocator &) = delete;
+                pool_allocator &operator=(pool_allocator &&other) {
+                        if (this != &other) {
+                                for (slot *block : blocks) {
+                                        ::operator delete(block);
+                                }
+                                blocks = std::move(other.blocks);
+                                free_list = other.free_list;
+                                cursor = other.cursor;
+                                end = other.end;
+                                other.free_list = nullptr;
+                                other.cursor = nullptr;
+                                other.end = nullptr;
+                                other.blocks.clear();
+                        }
+                        return *this;
+                }
+                ~pool_allocator() {
+                        for (slot *block : blocks) {
+                                ::operator delete(block);
+                        }
+                }
+                /**
+                 * @brief Allocates uninitialized storage for n objects
+                 * @param n The number of objects
+                 * @return A pointer to the allocated storage
+                 * @throws std::bad_array_new_length If n objects take more bytes than std::size_t holds
+                 */
+                T *allocate(std::size_t n) {
+                        if (n != 1) {
+                                if (n > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+                                return static_cast<T *>(::operator new(n * sizeof(T)));
+                        }
+                        slot *x = free_list;
+                        if (x != nullptr) {
+                                free_list = x->next;
+                        } else {
+                                if (cursor == end) grow();
+                                x = cursor++;
+                        }
+                        return reinterpret_cast<T *>(x);
+                }
+                /**
+                 * @brief Returns storage obtained from allocate to the pool
+                 * @param p The pointer returned by allocate
+                 * @param n The number of objects passed to allocate
+                 * @return void
+                 */
+                void deallocate(T *p, std::size_t n) {
+                        if (n != 1) {
+                                ::operator delete(p);
+                                return;
+                        }
+                        slot *x = reinterpret_cast<slot *>(p);
+                        x->next = free_list;
+                        free_list = x;
+                }
+                /**
+                 * @brief Finds the number of blocks owned by the pool
+                 * @return The number of blocks owned by the pool
+                 */
+                std::size_t block_count() const {
+                        return blocks.size();
+                }
+                template <typename U>
+                bool operator==(const pool_allocator <U, block_size> &other) const {
+                        return static_cast<const void *>(this) == static_cast<const void *>(&other);
+                }
+                template <typename U>
+                bool operator!=(const pool_allocator <U, block_size> &other) const {
+                        return !(*this == other);
+                }
+        };
+}
+
+#endif
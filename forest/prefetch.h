@@ -0,0 +1,27 @@
+/**
+ * @file prefetch.h
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief Asks the processor to start loading the cache line of an address, without waiting for it
+         *
+         * The address may be invalid, nothing is read from it. On compilers without
+         * __builtin_prefetch this does nothing.
+         */
+        inline void prefetch(const void *address) {
+#if defined(__GNUC__)
+                __builtin_prefetch(address);
+#else
+                (void)address;
+#endif
+        }
+}
+
+#endif
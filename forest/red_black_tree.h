@@ -6,33 +6,90 @@
 #define RED_BLACK_TREE_H
 
 #include <iostream>
+#include <cstdint>
 #include <algorithm>
 #include <queue>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <memory>
+#include <type_traits>
+
+#include "index_storage.h"
+#include "prefetch.h"
+#include "static_search_tree.h"
+#include "tree_iterator.h"
 
 /**
  * @brief The forest library namespace
  */
 namespace forest {
         enum color_t {red, black}; ///< Color data type for the nodes of a red black tree.
-        template <typename key_t, typename value_t>
-        struct red_black_tree_node {
-                key_t key;     ///< The key of the node
+        /**
+         * @brief Base of a red black tree node which stores nothing unless order statistics are enabled
+         */
+        template <bool order_statistics>
+        struct red_black_tree_node_count {
+
+        };
+        template <>
+        struct red_black_tree_node_count <true> {
+        protected:
+                unsigned long long count = 1; ///< The number of nodes in the subtree rooted at the node
+        public:
+                unsigned long long get_count() const {
+                        return count;
+                }
+        };
+        /**
+         * @brief A red black tree node
+         *
+         * The links and the color are private to the tree, so a node handed out by a search or an
+         * insert exposes its neighbors for reading but cannot be relinked or recolored.
+         * @tparam compact Whether the color is kept in the lowest bit of the parent pointer, see the specialization below
+         * @tparam indexed Whether the node lives in a node_vector and links to other nodes with 32 bit relative_pointer
+         */
+        template <typename key_t, typename value_t, bool order_statistics = false, bool compact = false, bool indexed = false>
+        struct red_black_tree_node : red_black_tree_node_count <order_statistics> {
+                static_assert(!indexed || (std::is_trivially_copyable <key_t>::value && std::is_trivially_copyable <value_t>::value), "nodes in index storage are moved as raw bytes");
+                typedef typename std::conditional <indexed, relative_pointer <red_black_tree_node>, red_black_tree_node *>::type link_t;
+                const key_t key; ///< The key of the node, const so the order of the tree cannot be broken through a node
                 value_t value; ///< The value of the node
+        private:
+                template <typename, typename, typename, typename, bool, bool, bool> friend class red_black_tree;
                 color_t color; ///< The color of the node
-                red_black_tree_node *parent;  ///< A pointer to the parent of the node
-                red_black_tree_node *left;    ///< A pointer to the left child of the node
-                red_black_tree_node *right;   ///< A pointer to the right child of the node
+                link_t parent; ///< A link to the parent of the node
+                link_t left;   ///< A link to the left child of the node
+                link_t right;  ///< A link to the right child of the node
+                void set_parent(red_black_tree_node *x) {
+                        parent = x;
+                }
+                void set_color(color_t color) {
+                        this->color = color;
+                }
+        public:
                 /**
                  * @brief Constructor of a red black tree node
+                 * @param color The color of the node
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from
                  */
-                red_black_tree_node(key_t key, value_t value, color_t color) {
-                        this->key = key;
-                        this->value = value;
-                        this->color = color;
-                        this->parent = nullptr;
-                        this->left = nullptr;
-                        this->right = nullptr;
+                template <typename other_t, typename... args_t>
+                red_black_tree_node(color_t color, other_t &&key, args_t &&... args) : key(std::forward<other_t>(key)), value(std::forward<args_t>(args)...), color(color), parent(nullptr), left(nullptr), right(nullptr) {
+
+                }
+                red_black_tree_node *get_parent() const {
+                        return parent;
+                }
+                red_black_tree_node *get_left() const {
+                        return left;
+                }
+                red_black_tree_node *get_right() const {
+                        return right;
+                }
+                color_t get_color() const {
+                        return color;
                 }
                 /**
                  * @brief Prints to the std::cout information about the node
@@ -61,64 +118,422 @@ namespace forest {
                         }
                 }
         };
-        template <typename key_t, typename value_t>
+        /**
+         * @brief A red black tree node that keeps its color in the lowest bit of the parent pointer
+         *
+         * Nodes are at least pointer aligned, so the lowest bit of the address of the parent is
+         * always zero. Storing the color there saves the word that a separate color_t occupies
+         * after padding, e.g. a node with int keys and values shrinks from 40 to 32 bytes.
+         * The parent and the color are only reachable through the accessors. Nodes in index
+         * storage have no spare bit in their 32 bit links and keep a separate color instead.
+         */
+        template <typename key_t, typename value_t, bool order_statistics>
+        struct red_black_tree_node <key_t, value_t, order_statistics, true, false> : red_black_tree_node_count <order_statistics> {
+                const key_t key; ///< The key of the node, const so the order of the tree cannot be broken through a node
+                value_t value; ///< The value of the node
+        private:
+                template <typename, typename, typename, typename, bool, bool, bool> friend class red_black_tree;
+                std::uintptr_t parent_color;  ///< The address of the parent of the node with the color in the lowest bit
+                red_black_tree_node *left;    ///< A pointer to the left child of the node
+                red_black_tree_node *right;   ///< A pointer to the right child of the node
+                void set_parent(red_black_tree_node *x) {
+                        parent_color = reinterpret_cast<std::uintptr_t>(x) | (parent_color & 1);
+                }
+                void set_color(color_t color) {
+                        parent_color = (parent_color & ~static_cast<std::uintptr_t>(1)) | static_cast<std::uintptr_t>(color);
+                }
+        public:
+                /**
+                 * @brief Constructor of a compact red black tree node
+                 * @param color The color of the node
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from
+                 */
+                template <typename other_t, typename... args_t>
+                red_black_tree_node(color_t color, other_t &&key, args_t &&... args) : key(std::forward<other_t>(key)), value(std::forward<args_t>(args)...), parent_color(static_cast<std::uintptr_t>(color)), left(nullptr), right(nullptr) {
+
+                }
+                red_black_tree_node *get_parent() const {
+                        return reinterpret_cast<red_black_tree_node *>(parent_color & ~static_cast<std::uintptr_t>(1));
+                }
+                red_black_tree_node *get_left() const {
+                        return left;
+                }
+                red_black_tree_node *get_right() const {
+                        return right;
+                }
+                color_t get_color() const {
+                        return static_cast<color_t>(parent_color & 1);
+                }
+                /**
+                 * @brief Prints to the std::cout information about the node
+                 */
+                void info() const {
+                        std::cout << this->key << "\t";
+                        std::cout << (get_color() == red ? "red" : "black") << "\t";
+                        if (this->left != nullptr) {
+                                std::cout << this->left->key << "\t";
+                        } else {
+                                std::cout << "null" << "\t";
+                        }
+                        if (this->right != nullptr) {
+                                std::cout << this->right->key << "\t";
+                        } else {
+                                std::cout << "null" << "\t";
+                        }
+                        if (get_parent() != nullptr) {
+                                std::cout << get_parent()->key << std::endl;
+                        } else {
+                                std::cout << "null" << std::endl;
+                        }
+                }
+        };
+        /**
+         * @brief The layout of a red black tree node without a color, used to check that compact nodes have no overhead
+         */
+        template <typename key_t, typename value_t, bool order_statistics>
+        struct red_black_tree_node_layout : red_black_tree_node_count <order_statistics> {
+                key_t key;
+                value_t value;
+                void *parent;
+                void *left;
+                void *right;
+        };
+        /**
+         * @brief A red black tree
+         * @tparam key_t The key type
+         * @tparam value_t The value type
+         * @tparam compare_t The strict weak ordering of the keys
+         * @tparam allocator_t The allocator used for the nodes, e.g. forest::pool_allocator
+         * @tparam order_statistics Whether every node stores the size of its subtree, which enables select and rank
+         * @tparam compact Whether the nodes keep their color in the lowest bit of the parent pointer
+         * @tparam indexed Whether the nodes are stored in one node_vector and linked by 32 bit offsets instead of
+         * pointers. Such nodes take less space and the tree can be copied and saved as raw bytes, but keys and
+         * values must be trivially copyable and inserting may move every node, like growing a std::vector,
+         * unless enough nodes were reserved. compact has no effect on such nodes.
+         */
+        template <typename key_t, typename value_t, typename compare_t = std::less <key_t>, typename allocator_t = std::allocator <red_black_tree_node <key_t, value_t> >, bool order_statistics = false, bool compact = false, bool indexed = false>
         class red_black_tree {
+                static_assert(!compact || indexed || alignof(red_black_tree_node <key_t, value_t, order_statistics, true>) >= 2, "compact nodes need the lowest bit of their address to be zero");
+                static_assert(!compact || indexed || sizeof(red_black_tree_node <key_t, value_t, order_statistics, true>) == sizeof(red_black_tree_node_layout <key_t, value_t, order_statistics>), "compact nodes must not spend any space on the color");
         private:
-                red_black_tree_node <key_t, value_t> *root;
-                void pre_order_traversal(red_black_tree_node <key_t, value_t> *x) {
+                typedef typename std::allocator_traits <allocator_t>::template rebind_alloc <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> > node_allocator_t;
+                typedef std::allocator_traits <node_allocator_t> node_allocator_traits;
+                node_allocator_t allocator;
+                typedef std::integral_constant <bool, indexed> indexed_t;
+                typedef typename std::conditional <indexed, node_vector <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed>, node_allocator_t>, no_node_vector>::type storage_t;
+                compare_t compare;
+                storage_t nodes;
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *root;
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *leftmost;
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *rightmost;
+                unsigned long long node_count;
+                static const std::size_t search_batch_width = 16; ///< The number of searches of search_batch that descend together
+                template <typename... args_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *create_node(std::false_type, args_t &&... args) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = node_allocator_traits::allocate(allocator, 1);
+                        try {
+                                node_allocator_traits::construct(allocator, x, std::forward<args_t>(args)...);
+                        } catch (...) {
+                                node_allocator_traits::deallocate(allocator, x, 1);
+                                throw;
+                        }
+                        return x;
+                }
+                template <typename... args_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *create_node(std::true_type, args_t &&... args) {
+                        return nodes.allocate(std::forward<args_t>(args)...);
+                }
+                void destroy_node(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, std::false_type) {
+                        node_allocator_traits::destroy(allocator, x);
+                        node_allocator_traits::deallocate(allocator, x, 1);
+                }
+                void destroy_node(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, std::true_type) {
+                        nodes.deallocate(x);
+                }
+                static void relocate(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *&x, std::ptrdiff_t delta) {
+                        if (x != nullptr) x = reinterpret_cast<red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *>(reinterpret_cast<char *>(x) + delta);
+                }
+                void relocate(std::ptrdiff_t delta) {
+                        relocate(root, delta);
+                        relocate(leftmost, delta);
+                        relocate(rightmost, delta);
+                }
+                /**
+                 * @brief Makes room for one more node before a descent, so that the pointers taken during the descent stay valid
+                 * @return The number of bytes the nodes moved by
+                 */
+                std::ptrdiff_t reserve_node(std::true_type) {
+                        std::ptrdiff_t delta = nodes.grow();
+                        if (delta != 0) relocate(delta);
+                        return delta;
+                }
+                std::ptrdiff_t reserve_node(std::false_type) {
+                        return 0;
+                }
+                void reserve(unsigned long long n, std::true_type) {
+                        std::ptrdiff_t delta = nodes.reserve(n);
+                        if (delta != 0) relocate(delta);
+                }
+                void reserve(unsigned long long, std::false_type) {
+
+                }
+                typedef std::integral_constant <bool, order_statistics> order_statistics_t;
+                static unsigned long long subtree_size(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        if (x == nullptr) return 0;
+                        return x->count;
+                }
+                void update_count(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, std::true_type) {
+                        x->count = subtree_size(x->left) + subtree_size(x->right) + 1;
+                }
+                void update_count(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, std::false_type) {
+
+                }
+                void increment_counts(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, std::true_type) {
+                        for (; x != nullptr; x = x->get_parent()) x->count++;
+                }
+                void increment_counts(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, std::false_type) {
+
+                }
+                void decrement_counts(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, std::true_type) {
+                        for (; x != nullptr; x = x->get_parent()) x->count--;
+                }
+                void decrement_counts(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, std::false_type) {
+
+                }
+                void pre_order_traversal(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (x == nullptr) return;
                         x->info();
                         pre_order_traversal(x->left);
                         pre_order_traversal(x->right);
                 }
-                void in_order_traversal(red_black_tree_node <key_t, value_t> *x) {
+                void in_order_traversal(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (x == nullptr) return;
                         in_order_traversal(x->left);
                         x->info();
                         in_order_traversal(x->right);
                 }
-                void post_order_traversal(red_black_tree_node <key_t, value_t> *x) {
+                void post_order_traversal(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (x == nullptr) return;
                         post_order_traversal(x->left);
                         post_order_traversal(x->right);
                         x->info();
                 }
-                void breadth_first_traversal(red_black_tree_node <key_t, value_t> *x) {
-                        std::queue <red_black_tree_node <key_t, value_t> *> queue;
+                void breadth_first_traversal(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        std::queue <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *> queue;
                         if (x == nullptr) return;
                         queue.push(x);
                         while(queue.empty() == false) {
-                                red_black_tree_node <key_t, value_t> *y = queue.front();
+                                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = queue.front();
                                 y->info();
                                 queue.pop();
                                 if (y->left != nullptr) queue.push(y->left);
                                 if (y->right != nullptr) queue.push(y->right);
                         }
                 }
-                unsigned long long height(red_black_tree_node <key_t, value_t> *x) {
+                unsigned long long height(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (x == nullptr) return 0;
                         return std::max(height(x->left), height(x->right)) + 1;
                 }
-                unsigned long long size(red_black_tree_node <key_t, value_t> *x) {
-                        if (x == nullptr) return 0;
-                        return size(x->left) + size(x->right) + 1;
+                void clear(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, std::true_type) {
+                        nodes.clear();
+                }
+                void clear(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, std::false_type) {
+                        while (x != nullptr) {
+                                if (x->left != nullptr) {
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = x->left;
+                                        x->left = y->right;
+                                        y->right = x;
+                                        x = y;
+                                } else {
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = x->right;
+                                        destroy_node(x, std::false_type());
+                                        x = y;
+                                }
+                        }
                 }
-                void graphviz(std::ofstream &file, red_black_tree_node <key_t, value_t> *x, unsigned long long *count) {
+                template <typename other_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *lower_bound(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, const other_t &key) const {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = nullptr;
+                        while (x != nullptr) {
+                                if (compare(x->key, key)) {
+                                        x = x->right;
+                                } else {
+                                        y = x;
+                                        x = x->left;
+                                }
+                        }
+                        return y;
+                }
+                template <typename other_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *upper_bound(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, const other_t &key) const {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = nullptr;
+                        while (x != nullptr) {
+                                if (compare(key, x->key)) {
+                                        y = x;
+                                        x = x->left;
+                                } else {
+                                        x = x->right;
+                                }
+                        }
+                        return y;
+                }
+                /**
+                 * @brief Finds the node with the key specified using one comparison per level
+                 */
+                template <typename other_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *find(const other_t &key) const {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = lower_bound(root, key);
+                        if (x != nullptr && !compare(key, x->key)) return x;
+                        return nullptr;
+                }
+                /**
+                 * @brief Builds a perfectly balanced subtree out of the next n elements of a sorted range
+                 * @param first The next element of the range, advanced past the elements consumed
+                 * @param n The number of nodes of the subtree
+                 * @param depth The depth of the root of the subtree
+                 * @param red_depth The depth whose nodes are colored red, i.e. the incomplete bottom level
+                 */
+                template <typename iterator_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *build(iterator_t &first, unsigned long long n, unsigned long long depth, unsigned long long red_depth) {
+                        if (n == 0) return nullptr;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *left = build(first, (n - 1) / 2, depth + 1, red_depth);
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x;
+                        // A throwing copy leaves the nodes built so far unreachable from the root, so they are freed here
+                        try {
+                                x = create_node(indexed_t(), depth == red_depth ? red : black, first->first, first->second);
+                        } catch (...) {
+                                clear(left, indexed_t());
+                                throw;
+                        }
+                        x->left = left;
+                        if (left != nullptr) left->set_parent(x);
+                        try {
+                                ++first;
+                                x->right = build(first, n - 1 - (n - 1) / 2, depth + 1, red_depth);
+                        } catch (...) {
+                                clear(x, indexed_t());
+                                throw;
+                        }
+                        if (x->right != nullptr) x->right->set_parent(x);
+                        update_count(x, order_statistics_t());
+                        return x;
+                }
+                /**
+                 * @brief Inserts a node unless a node with an equivalent key exists
+                 *
+                 * The node, and therefore the value, is only constructed when the key is absent.
+                 * @param key The key for the new node, used for the descent and then forwarded
+                 * @param args The arguments the value of the new node is constructed from
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> insert_node(other_t &&key, args_t &&... args) {
+                        reserve_node(indexed_t());
+                        // Keys past the maximum, as in an increasing stream, are appended without a descent
+                        if (rightmost != nullptr && compare(rightmost->key, key)) {
+                                return std::make_pair(link_node(rightmost, false, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                        }
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *current = root;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *parent = nullptr;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *candidate = nullptr;
+                        bool left = false;
+                        // Only compare(key, current->key) is evaluated per level. If the key already
+                        // exists it is the last node on the path that is not greater than the key.
+                        while(current!=nullptr) {
+                                parent = current;
+                                left = compare(key, current->key);
+                                if (left) {
+                                        current = current->left;
+                                } else {
+                                        candidate = current;
+                                        current = current->right;
+                                }
+                        }
+                        if (candidate != nullptr && !compare(candidate->key, key)) return std::make_pair(candidate, false);
+                        return std::make_pair(link_node(parent, left, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                }
+                /**
+                 * @brief Inserts a node next to a hint, falling back to insert_node if the key does not belong there
+                 * @param hint The node the key is expected to precede, nullptr for the end of the tree
+                 * @param key The key for the new node
+                 * @param args The arguments the value of the new node is constructed from
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> insert_hint_node(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *hint, other_t &&key, args_t &&... args) {
+                        relocate(hint, reserve_node(indexed_t()));
+                        if (hint != nullptr) {
+                                if (compare(key, hint->key)) {
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *before = hint == leftmost ? nullptr : iterator::predecessor(hint);
+                                        if (before == nullptr) {
+                                                return std::make_pair(link_node(hint, true, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                                        }
+                                        if (compare(before->key, key)) {
+                                                // Either hint has no left child or before is the maximum of it
+                                                if (before->right == nullptr) return std::make_pair(link_node(before, false, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                                                return std::make_pair(link_node(hint, true, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                                        }
+                                } else if (compare(hint->key, key)) {
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *after = hint == rightmost ? nullptr : iterator::successor(hint);
+                                        if (after == nullptr) {
+                                                return std::make_pair(link_node(hint, false, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                                        }
+                                        if (compare(key, after->key)) {
+                                                if (hint->right == nullptr) return std::make_pair(link_node(hint, false, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                                                return std::make_pair(link_node(after, true, std::forward<other_t>(key), std::forward<args_t>(args)...), true);
+                                        }
+                                } else {
+                                        return std::make_pair(hint, false);
+                                }
+                        }
+                        // Hints that do not fit, and end(), fall back to a descent that tries the position after the maximum first
+                        return insert_node(std::forward<other_t>(key), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Creates a node and links it as a child of parent
+                 * @param parent The parent of the new node, which must have no child on that side
+                 * @param left Whether the new node becomes the left child
+                 * @param key The key for the new node
+                 * @param args The arguments the value of the new node is constructed from
+                 * @return The new node
+                 */
+                template <typename other_t, typename... args_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *link_node(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *parent, bool left, other_t &&key, args_t &&... args) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *current = create_node(indexed_t(), red, std::forward<other_t>(key), std::forward<args_t>(args)...);
+                        current->set_parent(parent);
+                        node_count++;
+                        if(parent == nullptr) {
+                                root = current;
+                                leftmost = current;
+                                rightmost = current;
+                        } else if (left) {
+                                parent->left = current;
+                                if (parent == leftmost) leftmost = current;
+                        } else {
+                                parent->right = current;
+                                if (parent == rightmost) rightmost = current;
+                        }
+                        increment_counts(parent, order_statistics_t());
+                        fix(current);
+                        return current;
+                }
+                void graphviz(std::ofstream &file, red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, unsigned long long *count) {
                         if (x == nullptr) return;
                         graphviz(file, x->left, count);
                         if (x->left != nullptr) {
-                                if (x->color == red) {
+                                if (x->get_color() == red) {
                                         file << "\t" << x->key << " " << "[style=filled, fontcolor=white, fillcolor=red, color=red];" << std::endl;
-                                        if (x->left->color == red) {
+                                        if (x->left->get_color() == red) {
                                                 file << "\t" << x->left->key << " " << "[style=filled, fontcolor=white, fillcolor=red, color=red]" << ";" << std::endl;
-                                        } else if (x->left->color == black) {
+                                        } else if (x->left->get_color() == black) {
                                                 file << "\t" << x->left->key << " " << "[style=filled, fontcolor=white, fillcolor=black, color=black]" << ";" << std::endl;
                                         }
-                                } else if (x->color == black) {
+                                } else if (x->get_color() == black) {
                                         file << "\t" << x->key << " " << "[style=filled, fontcolor=white, fillcolor=black, color=black];" << std::endl;
-                                        if (x->left->color == red) {
+                                        if (x->left->get_color() == red) {
                                                 file << "\t" << x->left->key << " " << "[style=filled, fontcolor=white, fillcolor=red, color=red]" << ";" << std::endl;
-                                        } else if (x->left->color == black) {
+                                        } else if (x->left->get_color() == black) {
                                                 file << "\t" << x->left->key << " " << "[style=filled, fontcolor=white, fillcolor=black, color=black]" << ";" << std::endl;
                                         }
                                 }
@@ -129,18 +544,18 @@ namespace forest {
                                 (*count)++;
                         }
                         if (x->right != nullptr) {
-                                if (x->color == red) {
+                                if (x->get_color() == red) {
                                         file << "\t" << x->key << " " << "[style=filled, fontcolor=white, fillcolor=red, color=red];" << std::endl;
-                                        if (x->right->color == red) {
+                                        if (x->right->get_color() == red) {
                                                 file << "\t" << x->right->key << " " << "[style=filled, fontcolor=white, fillcolor=red, color=red]" << ";" << std::endl;
-                                        } else if (x->right->color == black) {
+                                        } else if (x->right->get_color() == black) {
                                                 file << "\t" << x->right->key << " " << "[style=filled, fontcolor=white, fillcolor=black, color=black]" << ";" << std::endl;
                                         }
-                                } else if (x->color == black) {
+                                } else if (x->get_color() == black) {
                                         file << "\t" << x->key << " " << "[style=filled, fontcolor=white, fillcolor=black, color=black];" << std::endl;
-                                        if (x->right->color == red) {
+                                        if (x->right->get_color() == red) {
                                                 file << "\t" << x->right->key << " " << "[style=filled, fontcolor=white, fillcolor=red, color=red]" << ";" << std::endl;
-                                        } else if (x->right->color == black) {
+                                        } else if (x->right->get_color() == black) {
                                                 file << "\t" << x->right->key << " " << "[style=filled, fontcolor=white, fillcolor=black, color=black]" << ";" << std::endl;
                                         }
                                 }
@@ -152,45 +567,53 @@ namespace forest {
                         }
                         graphviz(file, x->right, count);
                 }
-                void left_rotate(red_black_tree_node <key_t, value_t> *x) {
-                        red_black_tree_node <key_t, value_t> *y = x->right;
+                void left_rotate(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = x->right;
                         if(y != nullptr) {
                                 x->right = y->left;
-                                if(y->left != nullptr) y->left->parent = x;
-                                y->parent = x->parent;
+                                if(y->left != nullptr) y->left->set_parent(x);
+                                y->set_parent(x->get_parent());
                         }
-                        if(x->parent == nullptr) {
+                        if(x->get_parent() == nullptr) {
                                 root = y;
-                        } else if (x == x->parent->left) {
-                                x->parent->left = y;
+                        } else if (x == x->get_parent()->left) {
+                                x->get_parent()->left = y;
                         } else {
-                                x->parent->right = y;
+                                x->get_parent()->right = y;
                         }
                         if(y != nullptr) {
                                 y->left = x;
                         }
-                        x->parent = y;
+                        x->set_parent(y);
+                        if (y != nullptr) {
+                                update_count(x, order_statistics_t());
+                                update_count(y, order_statistics_t());
+                        }
                 }
-                void right_rotate(red_black_tree_node <key_t, value_t> *x) {
-                        red_black_tree_node <key_t, value_t> *y = x->left;
+                void right_rotate(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = x->left;
                         if (y != nullptr) {
                                 x->left = y->right;
-                                if (y->right != nullptr) y->right->parent = x;
-                                y->parent = x->parent;
+                                if (y->right != nullptr) y->right->set_parent(x);
+                                y->set_parent(x->get_parent());
                         }
-                        if(x->parent == nullptr) {
+                        if(x->get_parent() == nullptr) {
                                 root = y;
-                        } else if (x == x->parent->left) {
-                                x->parent->left = y;
+                        } else if (x == x->get_parent()->left) {
+                                x->get_parent()->left = y;
                         } else {
-                                x->parent->right = y;
+                                x->get_parent()->right = y;
                         }
                         if(y != nullptr) {
                                 y->right = x;
                         }
-                        x->parent = y;
+                        x->set_parent(y);
+                        if (y != nullptr) {
+                                update_count(x, order_statistics_t());
+                                update_count(y, order_statistics_t());
+                        }
                 }
-                red_black_tree_node <key_t, value_t> *find_sibling(red_black_tree_node <key_t, value_t> *x) {
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *find_sibling(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (x == find_parent(x)->left) {
                                 return find_parent(x)->right;
                         } else if (x == find_parent(x)->right) {
@@ -198,39 +621,39 @@ namespace forest {
                         }
                         return nullptr;
                 }
-                red_black_tree_node <key_t, value_t> *find_parent(red_black_tree_node <key_t, value_t> *x) {
-                        return x->parent;
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *find_parent(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        return x->get_parent();
                 }
-                red_black_tree_node <key_t, value_t> *find_grand_parent(red_black_tree_node <key_t, value_t> *x) {
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *find_grand_parent(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (find_parent(x) != nullptr) {
-                                return find_parent(x)->parent;
+                                return find_parent(x)->get_parent();
                         }
                         return nullptr;
                 }
-                red_black_tree_node <key_t, value_t> *find_uncle(red_black_tree_node <key_t, value_t> *x) {
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *find_uncle(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
                         if (find_grand_parent(x) != nullptr) {
                                 return find_sibling(find_parent(x));
                         }
                         return nullptr;
                 }
-                void fix(red_black_tree_node <key_t, value_t> *x) {
-                        red_black_tree_node <key_t, value_t> *parent = NULL;
-                        red_black_tree_node <key_t, value_t> *grand_parent = NULL;
-                        while ((x != root) && (x->color != black) && (x->parent->color == red)) {
-                                parent = x->parent;
-                                grand_parent = x->parent->parent;
+                void fix(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *parent = NULL;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *grand_parent = NULL;
+                        while ((x != root) && (x->get_color() != black) && (x->get_parent()->get_color() == red)) {
+                                parent = x->get_parent();
+                                grand_parent = x->get_parent()->get_parent();
                                 /**
                                  * @brief Case A - Parent of x is left child of the grand parent of x
                                  */
                                 if (parent == grand_parent->left) {
-                                        red_black_tree_node <key_t, value_t> *uncle = grand_parent->right;
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *uncle = grand_parent->right;
                                         /**
                                          * @brief Case 1 - The uncle of x is also red. Only recoloring is required
                                          */
-                                        if (uncle != NULL && uncle->color == red) {
-                                                grand_parent->color = red;
-                                                parent->color = black;
-                                                uncle->color = black;
+                                        if (uncle != NULL && uncle->get_color() == red) {
+                                                grand_parent->set_color(red);
+                                                parent->set_color(black);
+                                                uncle->set_color(black);
                                                 x = grand_parent;
                                         } else {
                                                 /**
@@ -239,27 +662,29 @@ namespace forest {
                                                 if (x == parent->right) {
                                                         left_rotate(parent);
                                                         x = parent;
-                                                        parent = x->parent;
+                                                        parent = x->get_parent();
                                                 }
                                                 /**
                                                  * @brief Case 3 - x is left child of its parent. Right rotation is required
                                                  */
                                                 right_rotate(grand_parent);
-                                                std::swap(parent->color, grand_parent->color);
+                                                color_t color = parent->get_color();
+                                                parent->set_color(grand_parent->get_color());
+                                                grand_parent->set_color(color);
                                                 x = parent;
                                         }
                                 } else {
                                         /**
                                          * @brief Case B - Parent of x is right child of the grand parent of x
                                          */
-                                        red_black_tree_node <key_t, value_t> *uncle = grand_parent->left;
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *uncle = grand_parent->left;
                                         /**
                                          * @brief Case 1 - The uncle of x is also red. Only recoloring required
                                          */
-                                        if ((uncle != NULL) && (uncle->color == red)) {
-                                                grand_parent->color = red;
-                                                parent->color = black;
-                                                uncle->color = black;
+                                        if ((uncle != NULL) && (uncle->get_color() == red)) {
+                                                grand_parent->set_color(red);
+                                                parent->set_color(black);
+                                                uncle->set_color(black);
                                                 x = grand_parent;
                                         } else {
                                                 /**
@@ -268,25 +693,179 @@ namespace forest {
                                                 if (x == parent->left) {
                                                         right_rotate(parent);
                                                         x = parent;
-                                                        parent = x->parent;
+                                                        parent = x->get_parent();
                                                 }
                                                 /**
                                                  * @brief Case 3 - x is right child of its parent. Left rotation is required
                                                  */
                                                 left_rotate(grand_parent);
-                                                std::swap(parent->color, grand_parent->color);
+                                                color_t color = parent->get_color();
+                                                parent->set_color(grand_parent->get_color());
+                                                grand_parent->set_color(color);
                                                 x = parent;
                                         }
                                 }
                         }
-                        root->color = black;
+                        root->set_color(black);
+                }
+                void transplant(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y) {
+                        if (x->get_parent() == nullptr) {
+                                root = y;
+                        } else if (x == x->get_parent()->left) {
+                                x->get_parent()->left = y;
+                        } else {
+                                x->get_parent()->right = y;
+                        }
+                        if (y != nullptr) y->set_parent(x->get_parent());
+                }
+                bool is_black(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x) {
+                        return x == nullptr || x->get_color() == black;
+                }
+                /**
+                 * @brief Restores the red black properties after a black node was removed
+                 * @param x The node that took the place of the removed node (may be null)
+                 * @param parent The parent of x
+                 */
+                void erase_fix(red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x, red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *parent) {
+                        while (x != root && is_black(x)) {
+                                /**
+                                 * @brief Case A - x is left child of its parent
+                                 */
+                                if (x == parent->left) {
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *sibling = parent->right;
+                                        /**
+                                         * @brief Case 1 - The sibling of x is red. Left rotation turns it into one of the other cases
+                                         */
+                                        if (sibling->get_color() == red) {
+                                                sibling->set_color(black);
+                                                parent->set_color(red);
+                                                left_rotate(parent);
+                                                sibling = parent->right;
+                                        }
+                                        /**
+                                         * @brief Case 2 - Both children of the sibling are black. Only recoloring is required
+                                         */
+                                        if (is_black(sibling->left) && is_black(sibling->right)) {
+                                                sibling->set_color(red);
+                                                x = parent;
+                                                parent = x->get_parent();
+                                        } else {
+                                                /**
+                                                 * @brief Case 3 - The right child of the sibling is black. Right rotation is required
+                                                 */
+                                                if (is_black(sibling->right)) {
+                                                        sibling->left->set_color(black);
+                                                        sibling->set_color(red);
+                                                        right_rotate(sibling);
+                                                        sibling = parent->right;
+                                                }
+                                                /**
+                                                 * @brief Case 4 - The right child of the sibling is red. Left rotation is required
+                                                 */
+                                                sibling->set_color(parent->get_color());
+                                                parent->set_color(black);
+                                                sibling->right->set_color(black);
+                                                left_rotate(parent);
+                                                x = root;
+                                        }
+                                } else {
+                                        /**
+                                         * @brief Case B - x is right child of its parent
+                                         */
+                                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *sibling = parent->left;
+                                        /**
+                                         * @brief Case 1 - The sibling of x is red. Right rotation turns it into one of the other cases
+                                         */
+                                        if (sibling->get_color() == red) {
+                                                sibling->set_color(black);
+                                                parent->set_color(red);
+                                                right_rotate(parent);
+                                                sibling = parent->left;
+                                        }
+                                        /**
+                                         * @brief Case 2 - Both children of the sibling are black. Only recoloring is required
+                                         */
+                                        if (is_black(sibling->left) && is_black(sibling->right)) {
+                                                sibling->set_color(red);
+                                                x = parent;
+                                                parent = x->get_parent();
+                                        } else {
+                                                /**
+                                                 * @brief Case 3 - The left child of the sibling is black. Left rotation is required
+                                                 */
+                                                if (is_black(sibling->left)) {
+                                                        sibling->right->set_color(black);
+                                                        sibling->set_color(red);
+                                                        left_rotate(sibling);
+                                                        sibling = parent->left;
+                                                }
+                                                /**
+                                                 * @brief Case 4 - The left child of the sibling is red. Right rotation is required
+                                                 */
+                                                sibling->set_color(parent->get_color());
+                                                parent->set_color(black);
+                                                sibling->left->set_color(black);
+                                                right_rotate(parent);
+                                                x = root;
+                                        }
+                                }
+                        }
+                        if (x != nullptr) x->set_color(black);
                 }
         public:
+                typedef tree_iterator <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed>, red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> > iterator;
+                typedef tree_iterator <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed>, const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> > const_iterator;
+                typedef std::reverse_iterator <iterator> reverse_iterator;
+                typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
                 red_black_tree() {
                         root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                explicit red_black_tree(const allocator_t &allocator) : allocator(allocator), nodes(allocator) {
+                        root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                explicit red_black_tree(const compare_t &compare, const allocator_t &allocator = allocator_t()) : allocator(allocator), compare(compare), nodes(allocator) {
+                        root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                red_black_tree(const red_black_tree &) = delete;
+                red_black_tree &operator=(const red_black_tree &) = delete;
+                red_black_tree(red_black_tree &&other) : allocator(std::move(other.allocator)), compare(std::move(other.compare)), nodes(std::move(other.nodes)) {
+                        root = other.root;
+                        leftmost = other.leftmost;
+                        rightmost = other.rightmost;
+                        node_count = other.node_count;
+                        other.root = nullptr;
+                        other.leftmost = nullptr;
+                        other.rightmost = nullptr;
+                        other.node_count = 0;
+                }
+                red_black_tree &operator=(red_black_tree &&other) {
+                        if (this != &other) {
+                                clear();
+                                allocator = std::move(other.allocator);
+                                compare = std::move(other.compare);
+                                nodes = std::move(other.nodes);
+                                root = other.root;
+                                leftmost = other.leftmost;
+                                rightmost = other.rightmost;
+                                node_count = other.node_count;
+                                other.root = nullptr;
+                                other.leftmost = nullptr;
+                                other.rightmost = nullptr;
+                                other.node_count = 0;
+                        }
+                        return *this;
                 }
                 ~red_black_tree() {
-
+                        clear();
                 }
                 /**
                  * @brief Performs a Pre Order Traversal starting from the root node
@@ -330,73 +909,515 @@ namespace forest {
                         file << "}" << std::endl;
                         file.close();
                 }
+                /**
+                 * @brief Removes all nodes from the Red Black Tree
+                 * @return void
+                 */
+                void clear() {
+                        clear(root, indexed_t());
+                        root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                /**
+                 * @brief Reserves room for n nodes, so that inserting up to n nodes does not move the nodes
+                 *
+                 * Only trees with index storage reserve anything, others allocate every node on its own.
+                 * @param n The number of nodes
+                 * @return void
+                 */
+                void reserve(unsigned long long n) {
+                        reserve(n, indexed_t());
+                }
+                /**
+                 * @brief Copies a Red Black Tree with index storage by copying its node array as raw bytes
+                 * @return The copy
+                 */
+                red_black_tree clone() const {
+                        static_assert(indexed, "only a Red Black Tree with index storage can be copied as raw bytes");
+                        red_black_tree tree(compare);
+                        tree.nodes = storage_t(nodes);
+                        tree.root = tree.nodes.at(nodes.index(root));
+                        tree.leftmost = tree.nodes.at(nodes.index(leftmost));
+                        tree.rightmost = tree.nodes.at(nodes.index(rightmost));
+                        tree.node_count = node_count;
+                        return tree;
+                }
+                /**
+                 * @brief Writes a Red Black Tree with index storage to a binary stream
+                 *
+                 * The nodes are written as raw bytes, so they can only be read back by a program with
+                 * the same key, value and node layout.
+                 * @param stream The stream to write to, opened in binary mode
+                 * @return void
+                 */
+                void save(std::ostream &stream) const {
+                        static_assert(indexed, "only a Red Black Tree with index storage can be saved as raw bytes");
+                        std::int64_t header[4] = {static_cast<std::int64_t>(node_count), nodes.index(root), nodes.index(leftmost), nodes.index(rightmost)};
+                        stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+                        nodes.write(stream);
+                }
+                /**
+                 * @brief Replaces the contents of the Red Black Tree with the nodes written by save
+                 * @param stream The stream to read from, opened in binary mode
+                 * @return void
+                 */
+                void load(std::istream &stream) {
+                        static_assert(indexed, "only a Red Black Tree with index storage can be loaded from raw bytes");
+                        clear();
+                        std::int64_t header[4] = {0, -1, -1, -1};
+                        stream.read(reinterpret_cast<char *>(header), sizeof(header));
+                        if (!stream) throw std::runtime_error("forest::red_black_tree could not read its header");
+                        nodes.read(stream);
+                        node_count = static_cast<unsigned long long>(header[0]);
+                        root = nodes.at(header[1]);
+                        leftmost = nodes.at(header[2]);
+                        rightmost = nodes.at(header[3]);
+                }
+                /**
+                 * @brief Replaces the contents of the Red Black Tree with a sorted range in linear time
+                 *
+                 * The range must be sorted by key without duplicates. The nodes are linked into a
+                 * perfectly balanced tree directly, without comparisons or rebalancing.
+                 * @param first The first element of a range of std::pair <key_t, value_t>
+                 * @param last The element past the end of the range
+                 * @return void
+                 */
+                template <typename iterator_t>
+                void assign_sorted(iterator_t first, iterator_t last) {
+                        clear();
+                        unsigned long long n = std::distance(first, last);
+                        reserve(n, indexed_t());
+                        unsigned long long depth = 0;
+                        while ((2ULL << depth) - 1 < n) depth++;
+                        // A complete tree is all black, otherwise the incomplete bottom level is red
+                        unsigned long long red_depth = (2ULL << depth) - 1 == n ? depth + 1 : depth;
+                        root = build(first, n, 0, red_depth);
+                        leftmost = iterator::minimum(root);
+                        rightmost = iterator::maximum(root);
+                        node_count = n;
+                }
+                /**
+                 * @brief Creates a Red Black Tree out of a sorted range in linear time
+                 * @param first The first element of a range of std::pair <key_t, value_t> sorted by key without duplicates
+                 * @param last The element past the end of the range
+                 * @return The Red Black Tree
+                 */
+                template <typename iterator_t>
+                static red_black_tree from_sorted(iterator_t first, iterator_t last) {
+                        red_black_tree tree;
+                        tree.assign_sorted(first, last);
+                        return tree;
+                }
+                template <typename iterator_t>
+                static red_black_tree from_sorted(iterator_t first, iterator_t last, const allocator_t &allocator) {
+                        red_black_tree tree(allocator);
+                        tree.assign_sorted(first, last);
+                        return tree;
+                }
+                /**
+                 * @brief Copies the elements into an immutable static_search_tree, which is searched faster and may be read by many threads at once
+                 * @return The static_search_tree holding the elements of the Red Black Tree
+                 */
+                static_search_tree <key_t, value_t, compare_t> freeze() const {
+                        return static_search_tree <key_t, value_t, compare_t> (begin(), end(), compare);
+                }
                 /**
                  * @brief Inserts a new node into the Red Black Tree
                  * @param key The key for the new node
                  * @param value The value for the new node
-                 * @return true if the new node was inserted and false otherwise
+                 * @return The new node or nullptr if the key already exists
                  */
-                const red_black_tree_node <key_t, value_t> *insert(key_t key, value_t value) {
-                        red_black_tree_node <key_t, value_t> *current = root;
-                        red_black_tree_node <key_t, value_t> *parent = nullptr;
-                        while(current!=nullptr) {
-                                parent = current;
-                                if (key > current->key) {
-                                        current = current->right;
-                                } else if (key < current->key) {
-                                        current = current->left;
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *insert(const key_t &key, const value_t &value) {
+                        std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> result = insert_node(key, value);
+                        return result.second ? result.first : nullptr;
+                }
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *insert(const key_t &key, value_t &&value) {
+                        std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> result = insert_node(key, std::move(value));
+                        return result.second ? result.first : nullptr;
+                }
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *insert(key_t &&key, const value_t &value) {
+                        std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> result = insert_node(std::move(key), value);
+                        return result.second ? result.first : nullptr;
+                }
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *insert(key_t &&key, value_t &&value) {
+                        std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> result = insert_node(std::move(key), std::move(value));
+                        return result.second ? result.first : nullptr;
+                }
+                /**
+                 * @brief Inserts a new node, looking for its position next to a hint first
+                 *
+                 * When the key belongs right before or right after the hint the node is linked without
+                 * a descent from the root, so passing back the returned iterator, or end() for
+                 * increasing keys, inserts a sorted stream in amortized constant time.
+                 * @param hint An iterator to the node the key is expected to precede
+                 * @param key The key for the new node
+                 * @param value The value for the new node
+                 * @return An iterator to the new node or to the node that already has the key
+                 */
+                template <typename other_t>
+                iterator insert(const_iterator hint, const key_t &key, other_t &&value) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = hint == cend() ? nullptr : const_cast<red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *>(&*hint);
+                        return iterator(insert_hint_node(x, key, std::forward<other_t>(value)).first, &root);
+                }
+                template <typename other_t>
+                iterator insert(const_iterator hint, key_t &&key, other_t &&value) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = hint == cend() ? nullptr : const_cast<red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *>(&*hint);
+                        return iterator(insert_hint_node(x, std::move(key), std::forward<other_t>(value)).first, &root);
+                }
+                /**
+                 * @brief Inserts a new node whose value is constructed in place, unless the key already exists
+                 * @param key The key for the new node
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename... args_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> try_emplace(const key_t &key, args_t &&... args) {
+                        return insert_node(key, std::forward<args_t>(args)...);
+                }
+                template <typename... args_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> try_emplace(key_t &&key, args_t &&... args) {
+                        return insert_node(std::move(key), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new node constructed in place, unless the key already exists
+                 *
+                 * The key is constructed first since it is needed to find the position of the node.
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> emplace(other_t &&key, args_t &&... args) {
+                        return insert_node(key_t(std::forward<other_t>(key)), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new node or assigns the value of the node with an equivalent key
+                 * @param key The key of the node
+                 * @param value The value to insert or assign
+                 * @return The node holding the value and whether the node was inserted
+                 */
+                template <typename other_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> insert_or_assign(const key_t &key, other_t &&value) {
+                        std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> result = insert_node(key, std::forward<other_t>(value));
+                        // The value is only consumed by insert_node when a node is created
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                template <typename other_t>
+                std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> insert_or_assign(key_t &&key, other_t &&value) {
+                        std::pair <red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *, bool> result = insert_node(std::move(key), std::forward<other_t>(value));
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                /**
+                 * @brief Applies a function to the value of the node with the key specified, inserting the node first if needed
+                 *
+                 * A new node gets a value initialized value, so upsert(word, [](int &count) { count++; })
+                 * counts words with a single descent.
+                 * @param key The key of the node
+                 * @param function The function called with a reference to the value
+                 * @return The node holding the value
+                 */
+                template <typename function_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *upsert(const key_t &key, function_t function) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = insert_node(key).first;
+                        function(x->value);
+                        return x;
+                }
+                template <typename function_t>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *upsert(key_t &&key, function_t function) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = insert_node(std::move(key)).first;
+                        function(x->value);
+                        return x;
+                }
+                /**
+                 * @brief Removes the node with the key specified from the Red Black Tree
+                 * @param key The key of the node to remove
+                 * @return true if a node was removed and false otherwise
+                 */
+                bool erase(const key_t &key) {
+                        const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = search(key);
+                        if (x == nullptr) return false;
+                        erase(x);
+                        return true;
+                }
+                /**
+                 * @brief Removes a node from the Red Black Tree and returns its memory to the allocator
+                 * @param z A node of this Red Black Tree, e.g. the result of search
+                 * @return void
+                 */
+                void erase(const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *z) {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = const_cast<red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *>(z);
+                        if (x == leftmost) leftmost = iterator::successor(x);
+                        if (x == rightmost) rightmost = iterator::predecessor(x);
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y = x;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *child = nullptr;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *parent = nullptr;
+                        color_t color = y->get_color();
+                        if (x->left == nullptr) {
+                                child = x->right;
+                                parent = x->get_parent();
+                                decrement_counts(parent, order_statistics_t());
+                                transplant(x, x->right);
+                        } else if (x->right == nullptr) {
+                                child = x->left;
+                                parent = x->get_parent();
+                                decrement_counts(parent, order_statistics_t());
+                                transplant(x, x->left);
+                        } else {
+                                y = x->right;
+                                while (y->left != nullptr) y = y->left;
+                                decrement_counts(y->get_parent(), order_statistics_t());
+                                color = y->get_color();
+                                child = y->right;
+                                if (y->get_parent() == x) {
+                                        parent = y;
                                 } else {
-                                        return nullptr;
+                                        parent = y->get_parent();
+                                        transplant(y, y->right);
+                                        y->right = x->right;
+                                        y->right->set_parent(y);
                                 }
+                                transplant(x, y);
+                                y->left = x->left;
+                                y->left->set_parent(y);
+                                y->set_color(x->get_color());
+                                update_count(y, order_statistics_t());
                         }
-                        current = new red_black_tree_node <key_t, value_t> (key, value, red);
-                        current->parent = parent;
-                        if(parent == nullptr) {
-                                root = current;
-                        } else if (current->key > parent->key) {
-                                parent->right = current;
-                        } else if (current->key < parent->key) {
-                                parent->left = current;
-                        }
-                        fix(current);
-                        return current;
+                        destroy_node(x, indexed_t());
+                        node_count--;
+                        if (color == black) erase_fix(child, parent);
+                }
+                /**
+                 * @brief Removes the node with the minimum key
+                 *
+                 * The minimum has no left child, so it is unlinked with at most one child moving up and the
+                 * rebalancing that follows is amortized constant.
+                 * @return true if a node was removed and false if the Red Black Tree is empty
+                 */
+                bool pop_min() {
+                        if (leftmost == nullptr) return false;
+                        erase(leftmost);
+                        return true;
+                }
+                /**
+                 * @brief Removes the node with the maximum key
+                 *
+                 * The maximum has no right child, so it is removed as cheaply as the minimum.
+                 * @return true if a node was removed and false if the Red Black Tree is empty
+                 */
+                bool pop_max() {
+                        if (rightmost == nullptr) return false;
+                        erase(rightmost);
+                        return true;
                 }
                 /**
                  * @brief Performs a binary search starting from the root node
+                 *
+                 * The value of the node returned may be modified in place, its key must not.
                  * @return The node with the key specified
                  */
-                const red_black_tree_node <key_t, value_t> *search(key_t key) {
-                        red_black_tree_node <key_t, value_t> *x = root;
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *search(const key_t &key) {
+                        return find(key);
+                }
+                /**
+                 * @brief Performs a binary search for a key of another type, requires a transparent comparator
+                 * @return The node with a key equivalent to the key specified
+                 */
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *search(const other_t &key) {
+                        return find(key);
+                }
+                /**
+                 * @brief Performs a binary search on a const tree, the node returned is read only
+                 * @return The node with the key specified
+                 */
+                const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *search(const key_t &key) const {
+                        return find(key);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *search(const other_t &key) const {
+                        return find(key);
+                }
+                /**
+                 * @brief Performs binary searches for several keys at once, overlapping their cache misses
+                 *
+                 * Groups of search_batch_width searches descend in lockstep: each search in turn goes
+                 * down one level and prefetches the node it moves to, so by the time it is compared
+                 * again the misses of the whole group have been in flight together rather than one
+                 * after the other.
+                 * @param keys The keys to search for
+                 * @param n The number of keys
+                 * @param out Set to the node with each key, or nullptr
+                 * @return void
+                 */
+                void search_batch(const key_t *keys, std::size_t n, red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> **out) {
+                        for (std::size_t first = 0; first < n; first += search_batch_width) {
+                                std::size_t m = n - first < search_batch_width ? n - first : search_batch_width;
+                                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x[search_batch_width];
+                                red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *y[search_batch_width];
+                                for (std::size_t i = 0; i < m; i++) {
+                                        x[i] = root;
+                                        y[i] = nullptr;
+                                }
+                                for (std::size_t active = m; active > 0;) {
+                                        active = 0;
+                                        for (std::size_t i = 0; i < m; i++) {
+                                                if (x[i] == nullptr) continue;
+                                                if (compare(x[i]->key, keys[first + i])) {
+                                                        x[i] = x[i]->right;
+                                                } else {
+                                                        y[i] = x[i];
+                                                        x[i] = x[i]->left;
+                                                }
+                                                if (x[i] != nullptr) {
+                                                        prefetch(x[i]);
+                                                        active++;
+                                                }
+                                        }
+                                }
+                                for (std::size_t i = 0; i < m; i++) {
+                                        out[first + i] = y[i] != nullptr && !compare(keys[first + i], y[i]->key) ? y[i] : nullptr;
+                                }
+                        }
+                }
+                /**
+                 * @brief Finds the first node whose key is not less than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the node found or end() if there is none
+                 */
+                iterator lower_bound(const key_t &key) {
+                        return iterator(lower_bound(root, key), &root);
+                }
+                const_iterator lower_bound(const key_t &key) const {
+                        return const_iterator(lower_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator lower_bound(const other_t &key) {
+                        return iterator(lower_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator lower_bound(const other_t &key) const {
+                        return const_iterator(lower_bound(root, key), &root);
+                }
+                /**
+                 * @brief Finds the first node whose key is greater than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the node found or end() if there is none
+                 */
+                iterator upper_bound(const key_t &key) {
+                        return iterator(upper_bound(root, key), &root);
+                }
+                const_iterator upper_bound(const key_t &key) const {
+                        return const_iterator(upper_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator upper_bound(const other_t &key) {
+                        return iterator(upper_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator upper_bound(const other_t &key) const {
+                        return const_iterator(upper_bound(root, key), &root);
+                }
+                /**
+                 * @brief Finds the range of nodes whose key is equal to the key specified
+                 * @param key The key to compare against
+                 * @return The pair lower_bound(key), upper_bound(key)
+                 */
+                std::pair <iterator, iterator> equal_range(const key_t &key) {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                std::pair <const_iterator, const_iterator> equal_range(const key_t &key) const {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                std::pair <iterator, iterator> equal_range(const other_t &key) {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                std::pair <const_iterator, const_iterator> equal_range(const other_t &key) const {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                /**
+                 * @brief Calls a function for every node whose key lies in [lo, hi)
+                 *
+                 * Descends once to the first node of the range and then walks successors,
+                 * so a range of k nodes costs O(height + k).
+                 * @param lo The smallest key of the range
+                 * @param hi The key past the end of the range
+                 * @param function The function called with a const reference to each node, in key order
+                 * @return void
+                 */
+                template <typename function_t>
+                void for_each_in_range(const key_t &lo, const key_t &hi, function_t function) const {
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = lower_bound(root, lo);
+                        while (x != nullptr && compare(x->key, hi)) {
+                                function(static_cast<const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> &>(*x));
+                                x = const_iterator::successor(x);
+                        }
+                }
+                /**
+                 * @brief Finds the node with the k-th smallest key, requires order statistics
+                 * @param k The zero based position of the node in key order
+                 * @return The node found or nullptr if k is not less than the size
+                 */
+                const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *select(unsigned long long k) const {
+                        static_assert(order_statistics, "select requires a red_black_tree with order statistics");
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = root;
                         while (x != nullptr) {
-                                if (key > x->key) {
-                                        x = x->right;
-                                } else if (key < x->key) {
+                                unsigned long long left = subtree_size(x->left);
+                                if (k < left) {
                                         x = x->left;
+                                } else if (k > left) {
+                                        k -= left + 1;
+                                        x = x->right;
                                 } else {
                                         return x;
                                 }
                         }
                         return nullptr;
                 }
+                /**
+                 * @brief Finds the number of keys less than the key specified, requires order statistics
+                 * @param key The key to compare against
+                 * @return The number of keys less than key
+                 */
+                unsigned long long rank(const key_t &key) const {
+                        static_assert(order_statistics, "rank requires a red_black_tree with order statistics");
+                        unsigned long long result = 0;
+                        red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *x = root;
+                        while (x != nullptr) {
+                                if (compare(x->key, key)) {
+                                        result += subtree_size(x->left) + 1;
+                                        x = x->right;
+                                } else {
+                                        x = x->left;
+                                }
+                        }
+                        return result;
+                }
                 /**
                  * @brief Finds the node with the minimum key
                  * @return The node with the minimum key
                  */
-                const red_black_tree_node <key_t, value_t> *minimum() {
-                        red_black_tree_node <key_t, value_t> *x = root;
-                        if (x == nullptr) return nullptr;
-                        while(x->left != nullptr) x = x->left;
-                        return x;
+                const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *minimum() const {
+                        return leftmost;
                 }
                 /**
                  * @brief Finds the node with the maximum key
                  * @return The node with the maximum key
                  */
-                const red_black_tree_node <key_t, value_t> *maximum() {
-                        red_black_tree_node <key_t, value_t> *x = root;
-                        if (x == nullptr) return nullptr;
-                        while(x->right != nullptr) x = x->right;
-                        return x;
+                const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *maximum() const {
+                        return rightmost;
+                }
+                /**
+                 * @brief Returns the root node, where searches outside the tree, e.g. interleaved_search, start
+                 * @return The root node or nullptr if the tree is empty
+                 */
+                const red_black_tree_node <key_t, value_t, order_statistics, compact, indexed> *root_node() const {
+                        return root;
                 }
                 /**
                  * @brief Finds the height of the red black tree
@@ -409,20 +1430,79 @@ namespace forest {
                  * @brief Finds the size of the red black tree
                  * @return The size of the red black tree
                  */
-                unsigned long long size() {
-                        return size(root);
+                unsigned long long size() const {
+                        return node_count;
                 }
                 /**
                  * @brief Finds if the red black tree is empty
                  * @return true if the red black tree is empty and false otherwise
                  */
-                bool empty() {
+                bool empty() const {
                         if (root == nullptr) {
                                 return true;
                         } else {
                                 return false;
                         }
                 }
+                /**
+                 * @brief Returns the comparator used to order the keys
+                 * @return A copy of the comparator
+                 */
+                compare_t key_comp() const {
+                        return compare;
+                }
+                /**
+                 * @brief Returns an iterator to the node with the minimum key
+                 * @return An iterator to the first node in key order
+                 */
+                iterator begin() {
+                        return iterator(leftmost, &root);
+                }
+                /**
+                 * @brief Returns an iterator past the node with the maximum key
+                 * @return An iterator past the last node in key order
+                 */
+                iterator end() {
+                        return iterator(nullptr, &root);
+                }
+                const_iterator begin() const {
+                        return const_iterator(leftmost, &root);
+                }
+                const_iterator end() const {
+                        return const_iterator(nullptr, &root);
+                }
+                const_iterator cbegin() const {
+                        return begin();
+                }
+                const_iterator cend() const {
+                        return end();
+                }
+                /**
+                 * @brief Returns a reverse iterator to the node with the maximum key
+                 * @return A reverse iterator to the first node in descending key order
+                 */
+                reverse_iterator rbegin() {
+                        return reverse_iterator(end());
+                }
+                /**
+                 * @brief Returns a reverse iterator past the node with the minimum key
+                 * @return A reverse iterator past the last node in descending key order
+                 */
+                reverse_iterator rend() {
+                        return reverse_iterator(begin());
+                }
+                const_reverse_iterator rbegin() const {
+                        return const_reverse_iterator(end());
+                }
+                const_reverse_iterator rend() const {
+                        return const_reverse_iterator(begin());
+                }
+                const_reverse_iterator crbegin() const {
+                        return rbegin();
+                }
+                const_reverse_iterator crend() const {
+                        return rend();
+                }
         };
 }
 
@@ -9,27 +9,55 @@
 #include <algorithm>
 #include <queue>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+
+#include "index_storage.h"
+#include "static_search_tree.h"
+#include "tree_iterator.h"
 
 /**
  * @brief The forest library namespace
  */
 namespace forest {
-        template <typename key_t, typename value_t>
+        /**
+         * @brief A splay tree node
+         *
+         * The links are private to the tree, so a node handed out by a search or an insert
+         * exposes its neighbors for reading but cannot be relinked.
+         * @tparam indexed Whether the node lives in a node_vector and links to other nodes with 32 bit relative_pointer
+         */
+        template <typename key_t, typename value_t, bool indexed = false>
         struct splay_tree_node {
-                key_t key;     ///< The key of the node
+                static_assert(!indexed || (std::is_trivially_copyable <key_t>::value && std::is_trivially_copyable <value_t>::value), "nodes in index storage are moved as raw bytes");
+                typedef typename std::conditional <indexed, relative_pointer <splay_tree_node>, splay_tree_node *>::type link_t;
+                const key_t key; ///< The key of the node, const so the order of the tree cannot be broken through a node
                 value_t value; ///< The value of the node
-                splay_tree_node *parent;  ///< A pointer to the parent of the node
-                splay_tree_node *left;    ///< A pointer to the left child of the node
-                splay_tree_node *right;   ///< A pointer to the right child of the node
+        private:
+                template <typename, typename, typename, bool> friend class splay_tree;
+                link_t parent; ///< A link to the parent of the node
+                link_t left;   ///< A link to the left child of the node
+                link_t right;  ///< A link to the right child of the node
+        public:
                 /**
                  * @brief Constructor of a splay tree node
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from
                  */
-                splay_tree_node(key_t key, value_t value) {
-                        this->key = key;
-                        this->value = value;
-                        this->parent = nullptr;
-                        this->left = nullptr;
-                        this->right = nullptr;
+                template <typename other_t, typename... args_t>
+                splay_tree_node(other_t &&key, args_t &&... args) : key(std::forward<other_t>(key)), value(std::forward<args_t>(args)...), parent(nullptr), left(nullptr), right(nullptr) {
+
+                }
+                splay_tree_node *get_parent() const {
+                        return parent;
+                }
+                splay_tree_node *get_left() const {
+                        return left;
+                }
+                splay_tree_node *get_right() const {
+                        return right;
                 }
                 /**
                  * @brief Prints to the std::cout information about the node
@@ -53,49 +81,227 @@ namespace forest {
                         }
                 }
         };
-        template <typename key_t, typename value_t>
+        /**
+         * @brief A splay tree
+         * @tparam key_t The key type
+         * @tparam value_t The value type
+         * @tparam compare_t The strict weak ordering of the keys
+         * @tparam indexed Whether the nodes are stored in one node_vector and linked by 32 bit offsets instead of
+         * pointers. Such nodes take less space and the tree can be copied and saved as raw bytes, but keys and
+         * values must be trivially copyable and inserting may move every node, like growing a std::vector,
+         * unless enough nodes were reserved.
+         */
+        template <typename key_t, typename value_t, typename compare_t = std::less <key_t>, bool indexed = false>
         class splay_tree {
         private:
-                splay_tree_node <key_t, value_t> *root;
-                void pre_order_traversal(splay_tree_node <key_t, value_t> *x) {
+                typedef std::integral_constant <bool, indexed> indexed_t;
+                typedef typename std::conditional <indexed, node_vector <splay_tree_node <key_t, value_t, indexed>>, no_node_vector>::type storage_t;
+                compare_t compare;
+                storage_t nodes;
+                splay_tree_node <key_t, value_t, indexed> *root;
+                splay_tree_node <key_t, value_t, indexed> *leftmost;
+                splay_tree_node <key_t, value_t, indexed> *rightmost;
+                unsigned long long node_count;
+                template <typename... args_t>
+                splay_tree_node <key_t, value_t, indexed> *create_node(std::false_type, args_t &&... args) {
+                        return new splay_tree_node <key_t, value_t, indexed> (std::forward<args_t>(args)...);
+                }
+                template <typename... args_t>
+                splay_tree_node <key_t, value_t, indexed> *create_node(std::true_type, args_t &&... args) {
+                        return nodes.allocate(std::forward<args_t>(args)...);
+                }
+                void destroy_node(splay_tree_node <key_t, value_t, indexed> *x, std::false_type) {
+                        delete x;
+                }
+                void destroy_node(splay_tree_node <key_t, value_t, indexed> *x, std::true_type) {
+                        nodes.deallocate(x);
+                }
+                static void relocate(splay_tree_node <key_t, value_t, indexed> *&x, std::ptrdiff_t delta) {
+                        if (x != nullptr) x = reinterpret_cast<splay_tree_node <key_t, value_t, indexed> *>(reinterpret_cast<char *>(x) + delta);
+                }
+                void relocate(std::ptrdiff_t delta) {
+                        relocate(root, delta);
+                        relocate(leftmost, delta);
+                        relocate(rightmost, delta);
+                }
+                /**
+                 * @brief Makes room for one more node before a descent, so that the pointers taken during the descent stay valid
+                 * @return The number of bytes the nodes moved by
+                 */
+                std::ptrdiff_t reserve_node(std::true_type) {
+                        std::ptrdiff_t delta = nodes.grow();
+                        if (delta != 0) relocate(delta);
+                        return delta;
+                }
+                std::ptrdiff_t reserve_node(std::false_type) {
+                        return 0;
+                }
+                void reserve(unsigned long long n, std::true_type) {
+                        std::ptrdiff_t delta = nodes.reserve(n);
+                        if (delta != 0) relocate(delta);
+                }
+                void reserve(unsigned long long, std::false_type) {
+
+                }
+                void pre_order_traversal(splay_tree_node <key_t, value_t, indexed> *x) {
                         if (x == nullptr) return;
                         x->info();
                         pre_order_traversal(x->left);
                         pre_order_traversal(x->right);
                 }
-                void in_order_traversal(splay_tree_node <key_t, value_t> *x) {
+                void in_order_traversal(splay_tree_node <key_t, value_t, indexed> *x) {
                         if (x == nullptr) return;
                         in_order_traversal(x->left);
                         x->info();
                         in_order_traversal(x->right);
                 }
-                void post_order_traversal(splay_tree_node <key_t, value_t> *x) {
+                void post_order_traversal(splay_tree_node <key_t, value_t, indexed> *x) {
                         if (x == nullptr) return;
                         post_order_traversal(x->left);
                         post_order_traversal(x->right);
                         x->info();
                 }
-                void breadth_first_traversal(splay_tree_node <key_t, value_t> *x) {
-                        std::queue <splay_tree_node <key_t, value_t> *> queue;
+                void breadth_first_traversal(splay_tree_node <key_t, value_t, indexed> *x) {
+                        std::queue <splay_tree_node <key_t, value_t, indexed> *> queue;
                         if (x == nullptr) return;
                         queue.push(x);
                         while(queue.empty() == false) {
-                                splay_tree_node <key_t, value_t> *y = queue.front();
+                                splay_tree_node <key_t, value_t, indexed> *y = queue.front();
                                 y->info();
                                 queue.pop();
                                 if (y->left != nullptr) queue.push(y->left);
                                 if (y->right != nullptr) queue.push(y->right);
                         }
                 }
-                unsigned long long height(splay_tree_node <key_t, value_t> *x) {
+                unsigned long long height(splay_tree_node <key_t, value_t, indexed> *x) {
                         if (x == nullptr) return 0;
                         return std::max(height(x->left), height(x->right)) + 1;
                 }
-                unsigned long long size(splay_tree_node <key_t, value_t> *x) {
-                        if (x == nullptr) return 0;
-                        return size(x->left) + size(x->right) + 1;
+                void clear(splay_tree_node <key_t, value_t, indexed> *, std::true_type) {
+                        nodes.clear();
                 }
-                void graphviz(std::ofstream &file, splay_tree_node <key_t, value_t> *x, unsigned long long *count) {
+                void clear(splay_tree_node <key_t, value_t, indexed> *x, std::false_type) {
+                        while (x != nullptr) {
+                                if (x->left != nullptr) {
+                                        splay_tree_node <key_t, value_t, indexed> *y = x->left;
+                                        x->left = y->right;
+                                        y->right = x;
+                                        x = y;
+                                } else {
+                                        splay_tree_node <key_t, value_t, indexed> *y = x->right;
+                                        destroy_node(x, std::false_type());
+                                        x = y;
+                                }
+                        }
+                }
+                template <typename other_t>
+                splay_tree_node <key_t, value_t, indexed> *lower_bound(splay_tree_node <key_t, value_t, indexed> *x, const other_t &key) const {
+                        splay_tree_node <key_t, value_t, indexed> *y = nullptr;
+                        while (x != nullptr) {
+                                if (compare(x->key, key)) {
+                                        x = x->right;
+                                } else {
+                                        y = x;
+                                        x = x->left;
+                                }
+                        }
+                        return y;
+                }
+                template <typename other_t>
+                splay_tree_node <key_t, value_t, indexed> *upper_bound(splay_tree_node <key_t, value_t, indexed> *x, const other_t &key) const {
+                        splay_tree_node <key_t, value_t, indexed> *y = nullptr;
+                        while (x != nullptr) {
+                                if (compare(key, x->key)) {
+                                        y = x;
+                                        x = x->left;
+                                } else {
+                                        x = x->right;
+                                }
+                        }
+                        return y;
+                }
+                /**
+                 * @brief Finds the node with the key specified using one comparison per level
+                 */
+                template <typename other_t>
+                splay_tree_node <key_t, value_t, indexed> *find(const other_t &key) const {
+                        splay_tree_node <key_t, value_t, indexed> *x = lower_bound(root, key);
+                        if (x != nullptr && !compare(key, x->key)) return x;
+                        return nullptr;
+                }
+                /**
+                 * @brief Builds a perfectly balanced subtree out of the next n elements of a sorted range
+                 * @param first The next element of the range, advanced past the elements consumed
+                 * @param n The number of nodes of the subtree
+                 */
+                template <typename iterator_t>
+                splay_tree_node <key_t, value_t, indexed> *build(iterator_t &first, unsigned long long n) {
+                        if (n == 0) return nullptr;
+                        splay_tree_node <key_t, value_t, indexed> *left = build(first, (n - 1) / 2);
+                        splay_tree_node <key_t, value_t, indexed> *x;
+                        // A throwing copy leaves the nodes built so far unreachable from the root, so they are freed here
+                        try {
+                                x = create_node(indexed_t(), first->first, first->second);
+                        } catch (...) {
+                                clear(left, indexed_t());
+                                throw;
+                        }
+                        x->left = left;
+                        if (left != nullptr) left->parent = x;
+                        try {
+                                ++first;
+                                x->right = build(first, n - 1 - (n - 1) / 2);
+                        } catch (...) {
+                                clear(x, indexed_t());
+                                throw;
+                        }
+                        if (x->right != nullptr) x->right->parent = x;
+                        return x;
+                }
+                /**
+                 * @brief Inserts a node unless a node with an equivalent key exists
+                 *
+                 * The node, and therefore the value, is only constructed when the key is absent.
+                 * @param key The key for the new node, used for the descent and then forwarded
+                 * @param args The arguments the value of the new node is constructed from
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> insert_node(other_t &&key, args_t &&... args) {
+                        reserve_node(indexed_t());
+                        splay_tree_node <key_t, value_t, indexed> *current = root;
+                        splay_tree_node <key_t, value_t, indexed> *parent = nullptr;
+                        splay_tree_node <key_t, value_t, indexed> *candidate = nullptr;
+                        bool left = false;
+                        while(current!=nullptr) {
+                                parent = current;
+                                left = compare(key, current->key);
+                                if (left) {
+                                        current = current->left;
+                                } else {
+                                        candidate = current;
+                                        current = current->right;
+                                }
+                        }
+                        if (candidate != nullptr && !compare(candidate->key, key)) return std::make_pair(candidate, false);
+                        current = create_node(indexed_t(), std::forward<other_t>(key), std::forward<args_t>(args)...);
+                        current->parent = parent;
+                        node_count++;
+                        if(parent == nullptr) {
+                                root = current;
+                                leftmost = current;
+                                rightmost = current;
+                        } else if (left) {
+                                parent->left = current;
+                                if (parent == leftmost) leftmost = current;
+                        } else {
+                                parent->right = current;
+                                if (parent == rightmost) rightmost = current;
+                        }
+                        splay(current);
+                        return std::make_pair(current, true);
+                }
+                void graphviz(std::ofstream &file, splay_tree_node <key_t, value_t, indexed> *x, unsigned long long *count) {
                         if (x == nullptr) return;
                         graphviz(file, x->left, count);
                         if (x->left != nullptr) {
@@ -114,8 +320,8 @@ namespace forest {
                         }
                         graphviz(file, x->right, count);
                 }
-                void left_rotate(splay_tree_node <key_t, value_t> *x) {
-                        splay_tree_node <key_t, value_t> *y = x->right;
+                void left_rotate(splay_tree_node <key_t, value_t, indexed> *x) {
+                        splay_tree_node <key_t, value_t, indexed> *y = x->right;
                         if(y != nullptr) {
                                 x->right = y->left;
                                 if(y->left != nullptr) y->left->parent = x;
@@ -133,8 +339,8 @@ namespace forest {
                         }
                         x->parent = y;
                 }
-                void right_rotate(splay_tree_node <key_t, value_t> *x) {
-                        splay_tree_node <key_t, value_t> *y = x->left;
+                void right_rotate(splay_tree_node <key_t, value_t, indexed> *x) {
+                        splay_tree_node <key_t, value_t, indexed> *y = x->left;
                         if (y != nullptr) {
                                 x->left = y->right;
                                 if (y->right != nullptr) y->right->parent = x;
@@ -152,16 +358,16 @@ namespace forest {
                         }
                         x->parent = y;
                 }
-                splay_tree_node <key_t, value_t> *find_parent(splay_tree_node <key_t, value_t> *x) {
+                splay_tree_node <key_t, value_t, indexed> *find_parent(splay_tree_node <key_t, value_t, indexed> *x) {
                         return x->parent;
                 }
-                splay_tree_node <key_t, value_t> *find_grand_parent(splay_tree_node <key_t, value_t> *x) {
+                splay_tree_node <key_t, value_t, indexed> *find_grand_parent(splay_tree_node <key_t, value_t, indexed> *x) {
                         if (find_parent(x) != nullptr) {
                                 return find_parent(x)->parent;
                         }
                         return nullptr;
                 }
-                void splay(splay_tree_node <key_t, value_t> *x) {
+                void splay(splay_tree_node <key_t, value_t, indexed> *x) {
                         while (find_parent(x) != nullptr) {
                                 if (find_grand_parent(x) == nullptr) {
                                         if (find_parent(x)->left == x) {
@@ -185,11 +391,52 @@ namespace forest {
                         }
                 }
         public:
+                typedef tree_iterator <splay_tree_node <key_t, value_t, indexed>, splay_tree_node <key_t, value_t, indexed> > iterator;
+                typedef tree_iterator <splay_tree_node <key_t, value_t, indexed>, const splay_tree_node <key_t, value_t, indexed> > const_iterator;
+                typedef std::reverse_iterator <iterator> reverse_iterator;
+                typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
                 splay_tree() {
                         root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                explicit splay_tree(const compare_t &compare) : compare(compare) {
+                        root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                splay_tree(const splay_tree &) = delete;
+                splay_tree &operator=(const splay_tree &) = delete;
+                splay_tree(splay_tree &&other) : compare(std::move(other.compare)), nodes(std::move(other.nodes)) {
+                        root = other.root;
+                        leftmost = other.leftmost;
+                        rightmost = other.rightmost;
+                        node_count = other.node_count;
+                        other.root = nullptr;
+                        other.leftmost = nullptr;
+                        other.rightmost = nullptr;
+                        other.node_count = 0;
+                }
+                splay_tree &operator=(splay_tree &&other) {
+                        if (this != &other) {
+                                clear();
+                                compare = std::move(other.compare);
+                                nodes = std::move(other.nodes);
+                                root = other.root;
+                                leftmost = other.leftmost;
+                                rightmost = other.rightmost;
+                                node_count = other.node_count;
+                                other.root = nullptr;
+                                other.leftmost = nullptr;
+                                other.rightmost = nullptr;
+                                other.node_count = 0;
+                        }
+                        return *this;
                 }
                 ~splay_tree() {
-
+                        clear();
                 }
                 /**
                  * @brief Performs a Pre Order Traversal starting from the root node
@@ -233,73 +480,397 @@ namespace forest {
                         file << "}" << std::endl;
                         file.close();
                 }
+                /**
+                 * @brief Removes all nodes from the Splay Tree
+                 * @return void
+                 */
+                void clear() {
+                        clear(root, indexed_t());
+                        root = nullptr;
+                        leftmost = nullptr;
+                        rightmost = nullptr;
+                        node_count = 0;
+                }
+                /**
+                 * @brief Reserves room for n nodes, so that inserting up to n nodes does not move the nodes
+                 *
+                 * Only trees with index storage reserve anything, others allocate every node on its own.
+                 * @param n The number of nodes
+                 * @return void
+                 */
+                void reserve(unsigned long long n) {
+                        reserve(n, indexed_t());
+                }
+                /**
+                 * @brief Copies a Splay Tree with index storage by copying its node array as raw bytes
+                 * @return The copy
+                 */
+                splay_tree clone() const {
+                        static_assert(indexed, "only a Splay Tree with index storage can be copied as raw bytes");
+                        splay_tree tree(compare);
+                        tree.nodes = storage_t(nodes);
+                        tree.root = tree.nodes.at(nodes.index(root));
+                        tree.leftmost = tree.nodes.at(nodes.index(leftmost));
+                        tree.rightmost = tree.nodes.at(nodes.index(rightmost));
+                        tree.node_count = node_count;
+                        return tree;
+                }
+                /**
+                 * @brief Writes a Splay Tree with index storage to a binary stream
+                 *
+                 * The nodes are written as raw bytes, so they can only be read back by a program with
+                 * the same key, value and node layout.
+                 * @param stream The stream to write to, opened in binary mode
+                 * @return void
+                 */
+                void save(std::ostream &stream) const {
+                        static_assert(indexed, "only a Splay Tree with index storage can be saved as raw bytes");
+                        std::int64_t header[4] = {static_cast<std::int64_t>(node_count), nodes.index(root), nodes.index(leftmost), nodes.index(rightmost)};
+                        stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+                        nodes.write(stream);
+                }
+                /**
+                 * @brief Replaces the contents of the Splay Tree with the nodes written by save
+                 * @param stream The stream to read from, opened in binary mode
+                 * @return void
+                 */
+                void load(std::istream &stream) {
+                        static_assert(indexed, "only a Splay Tree with index storage can be loaded from raw bytes");
+                        clear();
+                        std::int64_t header[4] = {0, -1, -1, -1};
+                        stream.read(reinterpret_cast<char *>(header), sizeof(header));
+                        if (!stream) throw std::runtime_error("forest::splay_tree could not read its header");
+                        nodes.read(stream);
+                        node_count = static_cast<unsigned long long>(header[0]);
+                        root = nodes.at(header[1]);
+                        leftmost = nodes.at(header[2]);
+                        rightmost = nodes.at(header[3]);
+                }
+                /**
+                 * @brief Replaces the contents of the Splay Tree with a sorted range in linear time
+                 *
+                 * The range must be sorted by key without duplicates. The nodes are linked into a
+                 * perfectly balanced tree directly, without comparisons or rebalancing.
+                 * @param first The first element of a range of std::pair <key_t, value_t>
+                 * @param last The element past the end of the range
+                 * @return void
+                 */
+                template <typename iterator_t>
+                void assign_sorted(iterator_t first, iterator_t last) {
+                        clear();
+                        unsigned long long n = std::distance(first, last);
+                        reserve(n, indexed_t());
+                        root = build(first, n);
+                        leftmost = iterator::minimum(root);
+                        rightmost = iterator::maximum(root);
+                        node_count = n;
+                }
+                /**
+                 * @brief Creates a Splay Tree out of a sorted range in linear time
+                 * @param first The first element of a range of std::pair <key_t, value_t> sorted by key without duplicates
+                 * @param last The element past the end of the range
+                 * @return The Splay Tree
+                 */
+                template <typename iterator_t>
+                static splay_tree from_sorted(iterator_t first, iterator_t last) {
+                        splay_tree tree;
+                        tree.assign_sorted(first, last);
+                        return tree;
+                }
+                /**
+                 * @brief Copies the elements into an immutable static_search_tree, which is searched faster and may be read by many threads at once
+                 * @return The static_search_tree holding the elements of the Splay Tree
+                 */
+                static_search_tree <key_t, value_t, compare_t> freeze() const {
+                        return static_search_tree <key_t, value_t, compare_t> (begin(), end(), compare);
+                }
                 /**
                  * @brief Inserts a new node into the Splay Tree
                  * @param key The key for the new node
                  * @param value The value for the new node
-                 * @return true if the new node was inserted and false otherwise
+                 * @return The new node or the node with the key if it already exists
                  */
-                const splay_tree_node <key_t, value_t> *insert(key_t key, value_t value) {
-                        splay_tree_node <key_t, value_t> *current = root;
-                        splay_tree_node <key_t, value_t> *parent = nullptr;
-                        while(current!=nullptr) {
-                                parent = current;
-                                if (key > current->key) {
-                                        current = current->right;
-                                } else if (key < current->key) {
-                                        current = current->left;
+                splay_tree_node <key_t, value_t, indexed> *insert(const key_t &key, const value_t &value) {
+                        return insert_node(key, value).first;
+                }
+                splay_tree_node <key_t, value_t, indexed> *insert(const key_t &key, value_t &&value) {
+                        return insert_node(key, std::move(value)).first;
+                }
+                splay_tree_node <key_t, value_t, indexed> *insert(key_t &&key, const value_t &value) {
+                        return insert_node(std::move(key), value).first;
+                }
+                splay_tree_node <key_t, value_t, indexed> *insert(key_t &&key, value_t &&value) {
+                        return insert_node(std::move(key), std::move(value)).first;
+                }
+                /**
+                 * @brief Inserts a new node whose value is constructed in place, unless the key already exists
+                 * @param key The key for the new node
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename... args_t>
+                std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> try_emplace(const key_t &key, args_t &&... args) {
+                        return insert_node(key, std::forward<args_t>(args)...);
+                }
+                template <typename... args_t>
+                std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> try_emplace(key_t &&key, args_t &&... args) {
+                        return insert_node(std::move(key), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new node constructed in place, unless the key already exists
+                 *
+                 * The key is constructed first since it is needed to find the position of the node.
+                 * @param key The argument the key is constructed from
+                 * @param args The arguments the value is constructed from, only used if the key is absent
+                 * @return The new or the existing node and whether the node was inserted
+                 */
+                template <typename other_t, typename... args_t>
+                std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> emplace(other_t &&key, args_t &&... args) {
+                        return insert_node(key_t(std::forward<other_t>(key)), std::forward<args_t>(args)...);
+                }
+                /**
+                 * @brief Inserts a new node or assigns the value of the node with an equivalent key
+                 * @param key The key of the node
+                 * @param value The value to insert or assign
+                 * @return The node holding the value and whether the node was inserted
+                 */
+                template <typename other_t>
+                std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> insert_or_assign(const key_t &key, other_t &&value) {
+                        std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> result = insert_node(key, std::forward<other_t>(value));
+                        // The value is only consumed by insert_node when a node is created
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                template <typename other_t>
+                std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> insert_or_assign(key_t &&key, other_t &&value) {
+                        std::pair <splay_tree_node <key_t, value_t, indexed> *, bool> result = insert_node(std::move(key), std::forward<other_t>(value));
+                        if (!result.second) result.first->value = std::forward<other_t>(value);
+                        return result;
+                }
+                /**
+                 * @brief Applies a function to the value of the node with the key specified, inserting the node first if needed
+                 *
+                 * A new node gets a value initialized value, so upsert(word, [](int &count) { count++; })
+                 * counts words with a single descent.
+                 * @param key The key of the node
+                 * @param function The function called with a reference to the value
+                 * @return The node holding the value
+                 */
+                template <typename function_t>
+                splay_tree_node <key_t, value_t, indexed> *upsert(const key_t &key, function_t function) {
+                        splay_tree_node <key_t, value_t, indexed> *x = insert_node(key).first;
+                        function(x->value);
+                        return x;
+                }
+                template <typename function_t>
+                splay_tree_node <key_t, value_t, indexed> *upsert(key_t &&key, function_t function) {
+                        splay_tree_node <key_t, value_t, indexed> *x = insert_node(std::move(key)).first;
+                        function(x->value);
+                        return x;
+                }
+                /**
+                 * @brief Removes the node with the key specified from the Splay Tree
+                 *
+                 * If the key does not exist the last node visited is splayed instead.
+                 * @param key The key of the node to remove
+                 * @return true if a node was removed and false otherwise
+                 */
+                bool erase(const key_t &key) {
+                        splay_tree_node <key_t, value_t, indexed> *x = root;
+                        splay_tree_node <key_t, value_t, indexed> *parent = nullptr;
+                        splay_tree_node <key_t, value_t, indexed> *candidate = nullptr;
+                        while (x != nullptr) {
+                                parent = x;
+                                if (compare(x->key, key)) {
+                                        x = x->right;
                                 } else {
-                                        return current;
+                                        candidate = x;
+                                        x = x->left;
                                 }
                         }
-                        current = new splay_tree_node <key_t, value_t> (key, value);
-                        current->parent = parent;
-                        if(parent == nullptr) {
-                                root = current;
-                        } else if (current->key > parent->key) {
-                                parent->right = current;
-                        } else if (current->key < parent->key) {
-                                parent->left = current;
+                        if (candidate != nullptr && !compare(key, candidate->key)) {
+                                erase(candidate);
+                                return true;
                         }
-                        splay(current);
-                        return current;
+                        if (parent != nullptr) splay(parent);
+                        return false;
+                }
+                /**
+                 * @brief Removes a node from the Splay Tree
+                 *
+                 * The node is splayed to the root, then the maximum of its left subtree is splayed
+                 * and the right subtree is joined below it.
+                 * @param z A node of this Splay Tree, e.g. the result of search
+                 * @return void
+                 */
+                void erase(const splay_tree_node <key_t, value_t, indexed> *z) {
+                        splay_tree_node <key_t, value_t, indexed> *x = const_cast<splay_tree_node <key_t, value_t, indexed> *>(z);
+                        splay(x);
+                        splay_tree_node <key_t, value_t, indexed> *left = x->left;
+                        splay_tree_node <key_t, value_t, indexed> *right = x->right;
+                        // Rotations keep the order of the nodes, so the cached ends only change when one of them is removed
+                        if (x == leftmost) leftmost = iterator::minimum(right);
+                        if (x == rightmost) rightmost = iterator::maximum(left);
+                        if (left == nullptr) {
+                                root = right;
+                                if (right != nullptr) right->parent = nullptr;
+                        } else {
+                                left->parent = nullptr;
+                                root = left;
+                                while (left->right != nullptr) left = left->right;
+                                splay(left);
+                                left->right = right;
+                                if (right != nullptr) right->parent = left;
+                        }
+                        destroy_node(x, indexed_t());
+                        node_count--;
+                }
+                /**
+                 * @brief Removes the node with the minimum key
+                 *
+                 * The minimum is splayed to the root, where it has no left child, and its right subtree becomes
+                 * the new root.
+                 * @return true if a node was removed and false if the Splay Tree is empty
+                 */
+                bool pop_min() {
+                        if (leftmost == nullptr) return false;
+                        erase(leftmost);
+                        return true;
+                }
+                /**
+                 * @brief Removes the node with the maximum key
+                 *
+                 * The maximum is splayed to the root and its left subtree becomes the new root.
+                 * @return true if a node was removed and false if the Splay Tree is empty
+                 */
+                bool pop_max() {
+                        if (rightmost == nullptr) return false;
+                        erase(rightmost);
+                        return true;
                 }
                 /**
                  * @brief Performs a binary search starting from the root node
+                 *
+                 * The value of the node returned may be modified in place, its key must not.
                  * @return The node with the key specified
                  */
-                const splay_tree_node <key_t, value_t> *search(key_t key) {
-                        splay_tree_node <key_t, value_t> *x = root;
-                        while (x != nullptr) {
-                                if (key > x->key) {
-                                        x = x->right;
-                                } else if (key < x->key) {
-                                        x = x->left;
-                                } else {
-                                        return x;
-                                }
+                splay_tree_node <key_t, value_t, indexed> *search(const key_t &key) {
+                        return find(key);
+                }
+                /**
+                 * @brief Performs a binary search for a key of another type, requires a transparent comparator
+                 * @return The node with a key equivalent to the key specified
+                 */
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                splay_tree_node <key_t, value_t, indexed> *search(const other_t &key) {
+                        return find(key);
+                }
+                /**
+                 * @brief Performs a binary search on a const tree, the node returned is read only
+                 * @return The node with the key specified
+                 */
+                const splay_tree_node <key_t, value_t, indexed> *search(const key_t &key) const {
+                        return find(key);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const splay_tree_node <key_t, value_t, indexed> *search(const other_t &key) const {
+                        return find(key);
+                }
+                /**
+                 * @brief Finds the first node whose key is not less than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the node found or end() if there is none
+                 */
+                iterator lower_bound(const key_t &key) {
+                        return iterator(lower_bound(root, key), &root);
+                }
+                const_iterator lower_bound(const key_t &key) const {
+                        return const_iterator(lower_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator lower_bound(const other_t &key) {
+                        return iterator(lower_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator lower_bound(const other_t &key) const {
+                        return const_iterator(lower_bound(root, key), &root);
+                }
+                /**
+                 * @brief Finds the first node whose key is greater than the key specified
+                 * @param key The key to compare against
+                 * @return An iterator to the node found or end() if there is none
+                 */
+                iterator upper_bound(const key_t &key) {
+                        return iterator(upper_bound(root, key), &root);
+                }
+                const_iterator upper_bound(const key_t &key) const {
+                        return const_iterator(upper_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                iterator upper_bound(const other_t &key) {
+                        return iterator(upper_bound(root, key), &root);
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const_iterator upper_bound(const other_t &key) const {
+                        return const_iterator(upper_bound(root, key), &root);
+                }
+                /**
+                 * @brief Finds the range of nodes whose key is equal to the key specified
+                 * @param key The key to compare against
+                 * @return The pair lower_bound(key), upper_bound(key)
+                 */
+                std::pair <iterator, iterator> equal_range(const key_t &key) {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                std::pair <const_iterator, const_iterator> equal_range(const key_t &key) const {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                std::pair <iterator, iterator> equal_range(const other_t &key) {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                std::pair <const_iterator, const_iterator> equal_range(const other_t &key) const {
+                        return std::make_pair(lower_bound(key), upper_bound(key));
+                }
+                /**
+                 * @brief Calls a function for every node whose key lies in [lo, hi)
+                 *
+                 * Descends once to the first node of the range and then walks successors,
+                 * so a range of k nodes costs O(height + k).
+                 * @param lo The smallest key of the range
+                 * @param hi The key past the end of the range
+                 * @param function The function called with a const reference to each node, in key order
+                 * @return void
+                 */
+                template <typename function_t>
+                void for_each_in_range(const key_t &lo, const key_t &hi, function_t function) const {
+                        splay_tree_node <key_t, value_t, indexed> *x = lower_bound(root, lo);
+                        while (x != nullptr && compare(x->key, hi)) {
+                                function(static_cast<const splay_tree_node <key_t, value_t, indexed> &>(*x));
+                                x = const_iterator::successor(x);
                         }
-                        return nullptr;
                 }
                 /**
                  * @brief Finds the node with the minimum key
                  * @return The node with the minimum key
                  */
-                const splay_tree_node <key_t, value_t> *minimum() {
-                        splay_tree_node <key_t, value_t> *x = root;
-                        if (x == nullptr) return nullptr;
-                        while(x->left != nullptr) x = x->left;
-                        return x;
+                const splay_tree_node <key_t, value_t, indexed> *minimum() const {
+                        return leftmost;
                 }
                 /**
                  * @brief Finds the node with the maximum key
                  * @return The node with the maximum key
                  */
-                const splay_tree_node <key_t, value_t> *maximum() {
-                        splay_tree_node <key_t, value_t> *x = root;
-                        if (x == nullptr) return nullptr;
-                        while(x->right != nullptr) x = x->right;
-                        return x;
+                const splay_tree_node <key_t, value_t, indexed> *maximum() const {
+                        return rightmost;
+                }
+                /**
+                 * @brief Returns the root node, where searches outside the tree, e.g. interleaved_search, start
+                 * @return The root node or nullptr if the tree is empty
+                 */
+                const splay_tree_node <key_t, value_t, indexed> *root_node() const {
+                        return root;
                 }
                 /**
                  * @brief Finds the height of the tree
@@ -312,20 +883,79 @@ namespace forest {
                  * @brief Finds the size of the tree
                  * @return The size of the splay tree
                  */
-                unsigned long long size() {
-                        return size(root);
+                unsigned long long size() const {
+                        return node_count;
                 }
                 /**
                  * @brief Finds if the splay tree is empty
                  * @return true if the splay tree is empty and false otherwise
                  */
-                bool empty() {
+                bool empty() const {
                         if (root == nullptr) {
                                 return true;
                         } else {
                                 return false;
                         }
                 }
+                /**
+                 * @brief Returns the comparator used to order the keys
+                 * @return A copy of the comparator
+                 */
+                compare_t key_comp() const {
+                        return compare;
+                }
+                /**
+                 * @brief Returns an iterator to the node with the minimum key
+                 * @return An iterator to the first node in key order
+                 */
+                iterator begin() {
+                        return iterator(leftmost, &root);
+                }
+                /**
+                 * @brief Returns an iterator past the node with the maximum key
+                 * @return An iterator past the last node in key order
+                 */
+                iterator end() {
+                        return iterator(nullptr, &root);
+                }
+                const_iterator begin() const {
+                        return const_iterator(leftmost, &root);
+                }
+                const_iterator end() const {
+                        return const_iterator(nullptr, &root);
+                }
+                const_iterator cbegin() const {
+                        return begin();
+                }
+                const_iterator cend() const {
+                        return end();
+                }
+                /**
+                 * @brief Returns a reverse iterator to the node with the maximum key
+                 * @return A reverse iterator to the first node in descending key order
+                 */
+                reverse_iterator rbegin() {
+                        return reverse_iterator(end());
+                }
+                /**
+                 * @brief Returns a reverse iterator past the node with the minimum key
+                 * @return A reverse iterator past the last node in descending key order
+                 */
+                reverse_iterator rend() {
+                        return reverse_iterator(begin());
+                }
+                const_reverse_iterator rbegin() const {
+                        return const_reverse_iterator(end());
+                }
+                const_reverse_iterator rend() const {
+                        return const_reverse_iterator(begin());
+                }
+                const_reverse_iterator crbegin() const {
+                        return rbegin();
+                }
+                const_reverse_iterator crend() const {
+                        return rend();
+                }
         };
 }
 
@@ -0,0 +1,284 @@
+/**
+ * @file static_search_tree.h
+ */
+
+#ifndef STATIC_SEARCH_TREE_H
+#define STATIC_SEARCH_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "prefetch.h"
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief An immutable search tree whose keys are stored in Eytzinger order
+         *
+         * The keys form an implicit complete binary search tree laid out in breadth first order:
+         * the root is at index 1 and the children of index k are at 2k and 2k + 1. The top levels
+         * that every lookup reads share a few cache lines, and the 16 descendants of a node four
+         * levels down are adjacent, so they are prefetched in one go while the next levels are
+         * compared. The descent has no data dependent branches. Values are kept in a separate
+         * array in the same order, so they are only read once a key is found.
+         *
+         * A static_search_tree is built from the in-order contents of another tree, usually
+         * with its freeze() member, and never changes afterwards, so any number of threads may
+         * search it at once.
+         * @tparam key_t The key type
+         * @tparam value_t The value type
+         * @tparam compare_t The strict weak ordering of the keys
+         */
+        template <typename key_t, typename value_t, typename compare_t = std::less <key_t> >
+        class static_search_tree {
+        private:
+                static const std::size_t cache_line = 64;
+                static const std::size_t search_batch_width = 16; ///< The number of searches of search_batch that descend together
+                /**
+                 * @brief The bytes of the block of 16 great-great-grandchildren prefetched at each level, at most two cache lines
+                 */
+                static const std::size_t prefetch_bytes = 16 * sizeof(key_t) < 2 * cache_line ? 16 * sizeof(key_t) : 2 * cache_line;
+                compare_t compare;
+                std::size_t count;
+                std::unique_ptr <char[]> key_buffer;
+                std::unique_ptr <char[]> value_buffer;
+                key_t *keys;     ///< The keys at indices 1 to count, the block of index 16k starts a cache line when sizeof(key_t) divides 64
+                value_t *values; ///< The values at indices 1 to count, value k belongs to key k
+                /**
+                 * @brief Allocates uninitialized slots 0 to n, slot 0 unused, with slot 0 at the start of a cache line
+                 *
+                 * Slot 1 does not start a line. The block prefetched four levels ahead of index k
+                 * starts at slot 16k, 16k * sizeof(key_t) bytes past slot 0, so it starts a line
+                 * whenever that is a multiple of 64.
+                 */
+                template <typename type_t>
+                static type_t *allocate(std::unique_ptr <char[]> &buffer, std::size_t n) {
+                        buffer.reset(new char[(n + 1) * sizeof(type_t) + cache_line]);
+                        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(buffer.get());
+                        address = (address + cache_line - 1) / cache_line * cache_line;
+                        return reinterpret_cast<type_t *>(address);
+                }
+                /**
+                 * @brief Copies elements in ascending key order into the slots of the implicit tree of n nodes, visiting it in order
+                 */
+                template <typename iterator_t>
+                void construct(std::size_t k, std::size_t n, iterator_t &first) {
+                        if (k > n) return;
+                        construct(2 * k, n, first);
+                        ::new (static_cast<void *>(keys + k)) key_t((*first).key);
+                        try {
+                                ::new (static_cast<void *>(values + k)) value_t((*first).value);
+                        } catch (...) {
+                                keys[k].~key_t();
+                                throw;
+                        }
+                        count++;
+                        ++first;
+                        construct(2 * k + 1, n, first);
+                }
+                /**
+                 * @brief Destroys the first remaining slots in order of the implicit tree of n nodes
+                 */
+                void destroy(std::size_t k, std::size_t n, std::size_t &remaining) {
+                        if (k > n || remaining == 0) return;
+                        destroy(2 * k, n, remaining);
+                        if (remaining == 0) return;
+                        keys[k].~key_t();
+                        values[k].~value_t();
+                        remaining--;
+                        destroy(2 * k + 1, n, remaining);
+                }
+                void destroy(std::size_t n) {
+                        std::size_t remaining = count;
+                        destroy(1, n, remaining);
+                        key_buffer.reset();
+                        value_buffer.reset();
+                        keys = nullptr;
+                        values = nullptr;
+                        count = 0;
+                }
+                /**
+                 * @brief Prefetches the block of the 16 descendants of index k four levels down
+                 */
+                void prefetch_descendants(std::size_t k) const {
+                        // Addresses past the array are harmless to prefetch, they are never read
+                        std::uintptr_t block = reinterpret_cast<std::uintptr_t>(keys) + 16 * k * sizeof(key_t);
+                        for (std::size_t i = 0; i < prefetch_bytes; i += cache_line) prefetch(reinterpret_cast<const void *>(block + i));
+                }
+                /**
+                 * @brief Turns the index a descent ends at, past the leaves, into the index of the lower bound
+                 *
+                 * Each step goes to the right child when the key of the node is less than the key
+                 * specified, so the path taken spells the comparisons in binary. The lower bound is
+                 * the last node where the descent went left: shifting out the trailing right turns
+                 * and that left turn gives its index, or 0 if the descent never went left.
+                 */
+                static std::size_t lower_bound_of(std::size_t k) {
+#if defined(__GNUC__)
+                        return k >> __builtin_ffsll(static_cast<long long>(~k));
+#else
+                        while (k & 1) k >>= 1;
+                        return k >> 1;
+#endif
+                }
+                /**
+                 * @brief Finds the Eytzinger index of the first key that is not less than the key specified
+                 * @return The index found, or 0 if every key is less than the key specified
+                 */
+                template <typename other_t>
+                std::size_t lower_bound_index(const other_t &key) const {
+                        std::size_t k = 1;
+                        while (k <= count) {
+                                prefetch_descendants(k);
+                                k = 2 * k + static_cast<std::size_t>(compare(keys[k], key));
+                        }
+                        return lower_bound_of(k);
+                }
+                template <typename other_t>
+                const value_t *find(const other_t &key) const {
+                        std::size_t k = lower_bound_index(key);
+                        if (k == 0 || compare(key, keys[k])) return nullptr;
+                        return &values[k];
+                }
+        public:
+                static_search_tree() : count(0), keys(nullptr), values(nullptr) {
+
+                }
+                /**
+                 * @brief Builds a static_search_tree from elements in ascending key order
+                 * @param first An iterator to the first element, which has key and value members like the elements of every forest tree
+                 * @param last An iterator past the last element
+                 * @param compare The ordering the elements are sorted by
+                 */
+                template <typename iterator_t>
+                static_search_tree(iterator_t first, iterator_t last, const compare_t &compare = compare_t()) : compare(compare), count(0), keys(nullptr), values(nullptr) {
+                        std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+                        if (n == 0) return;
+                        keys = allocate <key_t> (key_buffer, n);
+                        values = allocate <value_t> (value_buffer, n);
+                        try {
+                                construct(1, n, first);
+                        } catch (...) {
+                                destroy(n);
+                                throw;
+                        }
+                }
+                static_search_tree(const static_search_tree &) = delete;
+                static_search_tree &operator=(const static_search_tree &) = delete;
+                static_search_tree(static_search_tree &&other) : compare(std::move(other.compare)), count(other.count), key_buffer(std::move(other.key_buffer)), value_buffer(std::move(other.value_buffer)), keys(other.keys), values(other.values) {
+                        other.count = 0;
+                        other.keys = nullptr;
+                        other.values = nullptr;
+                }
+                static_search_tree &operator=(static_search_tree &&other) {
+                        if (this != &other) {
+                                destroy(count);
+                                compare = std::move(other.compare);
+                                count = other.count;
+                                key_buffer = std::move(other.key_buffer);
+                                value_buffer = std::move(other.value_buffer);
+                                keys = other.keys;
+                                values = other.values;
+                                other.count = 0;
+                                other.keys = nullptr;
+                                other.values = nullptr;
+                        }
+                        return *this;
+                }
+                ~static_search_tree() {
+                        destroy(count);
+                }
+                /**
+                 * @brief Searches for a key
+                 * @return A pointer to the value of the key specified or nullptr
+                 */
+                const value_t *search(const key_t &key) const {
+                        return find(key);
+                }
+                /**
+                 * @brief Searches for a key of another type, requires a transparent comparator
+                 * @return A pointer to the value of a key equivalent to the key specified or nullptr
+                 */
+                template <typename other_t, typename comparator_t = compare_t, typename = typename comparator_t::is_transparent>
+                const value_t *search(const other_t &key) const {
+                        return find(key);
+                }
+                /**
+                 * @brief Searches for several keys at once, overlapping their cache misses
+                 *
+                 * Groups of search_batch_width searches descend in lockstep, one level of each search
+                 * in turn, so the loads and prefetches of the group are in flight together.
+                 * @param queries The keys to search for
+                 * @param n The number of keys
+                 * @param out Set to a pointer to the value of each key, or nullptr
+                 * @return void
+                 */
+                void search_batch(const key_t *queries, std::size_t n, const value_t **out) const {
+                        for (std::size_t first = 0; first < n; first += search_batch_width) {
+                                std::size_t m = n - first < search_batch_width ? n - first : search_batch_width;
+                                std::size_t k[search_batch_width];
+                                for (std::size_t i = 0; i < m; i++) k[i] = 1;
+                                // Every path from the root is height() or height() - 1 nodes long
+                                for (unsigned long long level = height(); level > 0; level--) {
+                                        for (std::size_t i = 0; i < m; i++) {
+                                                if (k[i] > count) continue;
+                                                prefetch_descendants(k[i]);
+                                                k[i] = 2 * k[i] + static_cast<std::size_t>(compare(keys[k[i]], queries[first + i]));
+                                        }
+                                }
+                                for (std::size_t i = 0; i < m; i++) {
+                                        std::size_t x = lower_bound_of(k[i]);
+                                        out[first + i] = x == 0 || compare(queries[first + i], keys[x]) ? nullptr : &values[x];
+                                }
+                        }
+                }
+                /**
+                 * @brief Finds the first key that is not less than the key specified
+                 * @return A pointer to the key found or nullptr if there is none
+                 */
+                const key_t *lower_bound(const key_t &key) const {
+                        std::size_t k = lower_bound_index(key);
+                        return k == 0 ? nullptr : &keys[k];
+                }
+                /**
+                 * @brief Finds the height of the implicit tree
+                 * @return The number of levels of the implicit tree
+                 */
+                unsigned long long height() const {
+                        unsigned long long result = 0;
+                        for (std::size_t n = count; n != 0; n >>= 1) result++;
+                        return result;
+                }
+                /**
+                 * @brief Finds the size of the static_search_tree
+                 * @return The number of keys of the static_search_tree
+                 */
+                unsigned long long size() const {
+                        return count;
+                }
+                /**
+                 * @brief Finds if the static_search_tree is empty
+                 * @return true if the static_search_tree is empty and false otherwise
+                 */
+                bool empty() const {
+                        return count == 0;
+                }
+                /**
+                 * @brief Returns the comparator used to order the keys
+                 * @return A copy of the comparator
+                 */
+                compare_t key_comp() const {
+                        return compare;
+                }
+        };
+}
+
+#endif
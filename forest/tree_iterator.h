@@ -0,0 +1,138 @@
+/**
+ * @file tree_iterator.h
+ */
+
+#ifndef TREE_ITERATOR_H
+#define TREE_ITERATOR_H
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * @brief The forest library namespace
+ */
+namespace forest {
+        /**
+         * @brief A bidirectional iterator over the nodes of a binary tree in key order
+         *
+         * Successors and predecessors are found by following the parent pointers, so a full
+         * scan visits every edge twice and needs no auxiliary stack. The past-the-end iterator
+         * holds a null node and a pointer to the root of the tree, which allows it to be
+         * decremented. Dereferencing yields the node itself. Its key is const, which also makes
+         * the node impossible to assign or swap, and its links are only readable, through
+         * get_parent, get_left and get_right, so algorithms may change values through a
+         * mutable iterator but cannot move nodes around.
+         * @tparam node_t The node type of the tree
+         * @tparam reference_t node_t for a mutable iterator and const node_t for a constant one
+         */
+        template <typename node_t, typename reference_t>
+        class tree_iterator {
+        private:
+                template <typename, typename> friend class tree_iterator;
+                node_t *node;
+                node_t *const *root;
+        public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef typename std::remove_const <reference_t>::type value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef reference_t *pointer;
+                typedef reference_t &reference;
+                /**
+                 * @brief Finds the node with the minimum key in the subtree rooted at x
+                 */
+                static node_t *minimum(node_t *x) {
+                        if (x == nullptr) return nullptr;
+                        while (x->get_left() != nullptr) x = x->get_left();
+                        return x;
+                }
+                /**
+                 * @brief Finds the node with the maximum key in the subtree rooted at x
+                 */
+                static node_t *maximum(node_t *x) {
+                        if (x == nullptr) return nullptr;
+                        while (x->get_right() != nullptr) x = x->get_right();
+                        return x;
+                }
+                /**
+                 * @brief Finds the in order successor of x
+                 * @return The successor of x or nullptr if x has the maximum key
+                 */
+                static node_t *successor(node_t *x) {
+                        if (x->get_right() != nullptr) return minimum(x->get_right());
+                        node_t *y = x->get_parent();
+                        while (y != nullptr && x == y->get_right()) {
+                                x = y;
+                                y = y->get_parent();
+                        }
+                        return y;
+                }
+                /**
+                 * @brief Finds the in order predecessor of x
+                 * @return The predecessor of x or nullptr if x has the minimum key
+                 */
+                static node_t *predecessor(node_t *x) {
+                        if (x->get_left() != nullptr) return maximum(x->get_left());
+                        node_t *y = x->get_parent();
+                        while (y != nullptr && x == y->get_left()) {
+                                x = y;
+                                y = y->get_parent();
+                        }
+                        return y;
+                }
+                tree_iterator() {
+                        node = nullptr;
+                        root = nullptr;
+                }
+                tree_iterator(node_t *node, node_t *const *root) {
+                        this->node = node;
+                        this->root = root;
+                }
+                /**
+                 * @brief Converts a mutable iterator into a constant one
+                 */
+                template <typename other_t, typename = typename std::enable_if <std::is_const <reference_t>::value && !std::is_const <other_t>::value>::type>
+                tree_iterator(const tree_iterator <node_t, other_t> &other) {
+                        node = other.node;
+                        root = other.root;
+                }
+                reference operator*() const {
+                        return *node;
+                }
+                pointer operator->() const {
+                        return node;
+                }
+                tree_iterator &operator++() {
+                        node = successor(node);
+                        return *this;
+                }
+                tree_iterator operator++(int) {
+                        tree_iterator x = *this;
+                        ++(*this);
+                        return x;
+                }
+                tree_iterator &operator--() {
+                        if (node == nullptr) {
+                                node = maximum(*root);
+                        } else {
+                                node = predecessor(node);
+                        }
+                        return *this;
+                }
+                tree_iterator operator--(int) {
+                        tree_iterator x = *this;
+                        --(*this);
+                        return x;
+                }
+                template <typename other_t>
+                bool operator==(const tree_iterator <node_t, other_t> &other) const {
+                        return node == other.node;
+                }
+                template <typename other_t>
+                bool operator!=(const tree_iterator <node_t, other_t> &other) const {
+                        return node != other.node;
+                }
+        };
+}
+
+#endif
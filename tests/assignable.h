@@ -0,0 +1,55 @@
+#ifndef FOREST_TESTS_ASSIGNABLE_H
+#define FOREST_TESTS_ASSIGNABLE_H
+
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Tells whether the element an iterator points to can be assigned as a whole, e.g. by std::swap or std::reverse
+ */
+template <typename iterator_t, typename = void>
+struct element_assignable : std::false_type {
+
+};
+template <typename iterator_t>
+struct element_assignable <iterator_t, decltype(void(*std::declval <iterator_t &> () = *std::declval <iterator_t &> ()))> : std::true_type {
+
+};
+
+/**
+ * @brief Tells whether the key of the element an iterator points to can be assigned
+ */
+template <typename iterator_t, typename = void>
+struct key_assignable : std::false_type {
+
+};
+template <typename iterator_t>
+struct key_assignable <iterator_t, decltype(void(std::declval <iterator_t &> ()->key = std::declval <iterator_t &> ()->key))> : std::true_type {
+
+};
+
+/**
+ * @brief Tells whether the value of the element an iterator points to can be assigned
+ */
+template <typename iterator_t, typename = void>
+struct value_assignable : std::false_type {
+
+};
+template <typename iterator_t>
+struct value_assignable <iterator_t, decltype(void(std::declval <iterator_t &> ()->value = std::declval <iterator_t &> ()->value))> : std::true_type {
+
+};
+
+/**
+ * @brief Tells whether the links of the node a pointer or an iterator points to can be assigned
+ */
+template <typename pointer_t, typename = void>
+struct links_assignable : std::false_type {
+
+};
+template <typename pointer_t>
+struct links_assignable <pointer_t, decltype(void(std::declval <pointer_t &> ()->left = std::declval <pointer_t &> ()->right))> : std::true_type {
+
+};
+
+#endif
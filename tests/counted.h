@@ -0,0 +1,61 @@
+#ifndef FOREST_TESTS_COUNTED_H
+#define FOREST_TESTS_COUNTED_H
+
+#include <stdexcept>
+
+/**
+ * @brief A value type that keeps track of how many instances are alive and how often it is copied or moved
+ *
+ * Copying throws once copies() reaches copy_limit(), which is never unless a test sets it.
+ */
+struct counted {
+        int value;
+        static long long &alive() {
+                static long long count = 0;
+                return count;
+        }
+        static long long &copies() {
+                static long long count = 0;
+                return count;
+        }
+        static long long &moves() {
+                static long long count = 0;
+                return count;
+        }
+        static long long &copy_limit() {
+                static long long count = -1;
+                return count;
+        }
+        static void reset() {
+                copies() = 0;
+                moves() = 0;
+                copy_limit() = -1;
+        }
+        counted(int value = 0) : value(value) {
+                alive()++;
+        }
+        counted(const counted &other) : value(other.value) {
+                if (copies() == copy_limit()) throw std::runtime_error("copy limit reached");
+                alive()++;
+                copies()++;
+        }
+        counted(counted &&other) : value(other.value) {
+                alive()++;
+                moves()++;
+        }
+        counted &operator=(const counted &other) {
+                value = other.value;
+                copies()++;
+                return *this;
+        }
+        counted &operator=(counted &&other) {
+                value = other.value;
+                moves()++;
+                return *this;
+        }
+        ~counted() {
+                alive()--;
+        }
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef FOREST_TESTS_STRING_LESS_H
+#define FOREST_TESTS_STRING_LESS_H
+
+#include <cstring>
+#include <string>
+
+/**
+ * @brief A transparent comparator of strings that counts how often it is called
+ */
+struct string_less {
+        typedef void is_transparent;
+        static long long &comparisons() {
+                static long long count = 0;
+                return count;
+        }
+        bool operator()(const std::string &a, const std::string &b) const {
+                comparisons()++;
+                return a < b;
+        }
+        bool operator()(const std::string &a, const char *b) const {
+                comparisons()++;
+                return a.compare(b) < 0;
+        }
+        bool operator()(const char *a, const std::string &b) const {
+                comparisons()++;
+                return b.compare(a) > 0;
+        }
+};
+
+#endif
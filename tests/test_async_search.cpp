@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include <forest/async_search.h>
+#include <forest/binary_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include "string_less.h"
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(FOREST_ASYNC_SEARCH)
+
+/**
+ * @brief Checks that interleaved_search finds what search finds, for every number of lanes up to 20
+ */
+template <typename tree_t, typename node_t>
+bool same_as_search(tree_t &tree, const std::vector <int> &keys) {
+        for (std::size_t lanes = 0; lanes <= 20; lanes++) {
+                std::vector <const node_t *> found(keys.size());
+                forest::interleaved_search(tree, keys.data(), keys.size(), found.data(), lanes);
+                for (std::size_t i = 0; i < keys.size(); i++) {
+                        if (found[i] != tree.search(keys[i])) return false;
+                }
+        }
+        return true;
+}
+
+SCENARIO("Test interleaved search") {
+        GIVEN("An empty Red Black Tree") {
+                forest::red_black_tree <int, int> red_black_tree;
+                std::vector <int> keys = {1, 2, 3};
+                THEN("Every search misses") {
+                        REQUIRE((same_as_search <forest::red_black_tree <int, int>, forest::red_black_tree_node <int, int> > (red_black_tree, keys)));
+                }
+        }
+        GIVEN("Trees with the same random keys") {
+                forest::red_black_tree <int, int> red_black_tree;
+                forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, false, true> compact_tree;
+                forest::binary_search_tree <int, int, std::less <int>, true> indexed_tree;
+                std::mt19937 random(5);
+                for (int i = 0; i < 1000; i++) {
+                        int key = static_cast<int>(random() % 2000);
+                        red_black_tree.insert(key, -key);
+                        compact_tree.insert(key, -key);
+                        indexed_tree.insert(key, -key);
+                }
+                std::vector <int> keys;
+                for (int i = 0; i < 100; i++) {
+                        keys.push_back(static_cast<int>(random() % 2100) - 50);
+                }
+                THEN("Test every number of lanes against search") {
+                        REQUIRE((same_as_search <forest::red_black_tree <int, int>, forest::red_black_tree_node <int, int> > (red_black_tree, keys)));
+                        REQUIRE((same_as_search <decltype(compact_tree), forest::red_black_tree_node <int, int, false, true> > (compact_tree, keys)));
+                        REQUIRE((same_as_search <decltype(indexed_tree), forest::binary_search_tree_node <int, int, true> > (indexed_tree, keys)));
+                }
+        }
+        GIVEN("A Binary Search Tree of descending keys, a path to the left") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                for (int i = 999; i >= 0; i--) {
+                        binary_search_tree.insert(i, -i);
+                }
+                std::vector <int> keys = {0, 999, 500, 1000, -1};
+                THEN("Test every number of lanes against search") {
+                        REQUIRE((same_as_search <forest::binary_search_tree <int, int>, forest::binary_search_tree_node <int, int> > (binary_search_tree, keys)));
+                }
+        }
+        GIVEN("A Splay Tree") {
+                forest::splay_tree <int, int> splay_tree;
+                for (int i = 0; i < 100; i++) {
+                        splay_tree.insert(i, -i);
+                }
+                std::vector <int> keys = {50, 0, 99, 100, -1};
+                std::vector <const forest::splay_tree_node <int, int> *> found(keys.size());
+                forest::interleaved_search(splay_tree, keys.data(), keys.size(), found.data());
+                THEN("The searches find the nodes") {
+                        REQUIRE(found[0]->value == -50);
+                        REQUIRE(found[1]->value == 0);
+                        REQUIRE(found[2]->value == -99);
+                        REQUIRE(found[3] == nullptr);
+                        REQUIRE(found[4] == nullptr);
+                }
+        }
+        GIVEN("A Red Black Tree of strings with a transparent comparator") {
+                forest::red_black_tree <std::string, int, string_less> red_black_tree;
+                std::vector <std::string> words = {"pear", "apple", "fig", "plum", "kiwi"};
+                for (const std::string &word : words) {
+                        red_black_tree.insert(word, static_cast<int>(word.size()));
+                }
+                const char *keys[] = {"fig", "grape", "plum"};
+                const forest::red_black_tree_node <std::string, int> *found[3];
+                forest::interleaved_search(red_black_tree, keys, 3, found);
+                THEN("Test search by string literal") {
+                        REQUIRE(found[0]->value == 3);
+                        REQUIRE(found[1] == nullptr);
+                        REQUIRE(found[2]->value == 4);
+                }
+        }
+}
+
+#endif
@@ -0,0 +1,406 @@
+#include "catch.hpp"
+#include <forest/b_tree.h>
+#include "counted.h"
+#include "string_less.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Finds the greatest height a b tree of n keys may have when every node but the root holds at least min_count keys
+ */
+unsigned long long maximum_height(unsigned long long n, unsigned long long min_count) {
+        if (n == 0) return 0;
+        return 1 + static_cast<unsigned long long>(std::floor(std::log((n + 1) / 2.0) / std::log(min_count + 1.0) + 1e-9));
+}
+
+/**
+ * @brief Checks a b tree against a std::set of the keys it should hold
+ */
+template <typename tree_t>
+bool same_keys(const tree_t &tree, const std::set <int> &reference) {
+        if (tree.size() != reference.size()) return false;
+        if (!std::equal(reference.begin(), reference.end(), tree.begin(), [](int key, const forest::b_tree_reference <int, const int> &element) {
+                return key == element.key && element.value == -key;
+        })) return false;
+        return std::equal(reference.rbegin(), reference.rend(), tree.rbegin(), [](int key, const forest::b_tree_reference <int, const int> &element) {
+                return key == element.key;
+        });
+}
+
+/**
+ * @brief Applies random inserts and erases to a b tree and a std::set and compares them along the way
+ */
+template <std::size_t capacity>
+void random_operations(unsigned seed) {
+        forest::b_tree <int, int, std::less <int>, capacity> b_tree;
+        std::set <int> reference;
+        std::mt19937 random(seed);
+        for (int i = 0; i < 20000; i++) {
+                int key = static_cast<int>(random() % 2000);
+                switch (random() % 4) {
+                case 0:
+                        REQUIRE(b_tree.erase(key) == (reference.erase(key) == 1));
+                        break;
+                case 1:
+                        REQUIRE((b_tree.search(key) != nullptr) == (reference.count(key) == 1));
+                        break;
+                default:
+                        REQUIRE((b_tree.insert(key, -key) != nullptr) == reference.insert(key).second);
+                }
+                if (i % 500 == 0) {
+                        REQUIRE(same_keys(b_tree, reference));
+                        REQUIRE(b_tree.height() <= maximum_height(reference.size(), (capacity - 1) / 2));
+                }
+        }
+        REQUIRE(same_keys(b_tree, reference));
+        for (int key = -1; key <= 2001; key += 7) {
+                auto lower = b_tree.lower_bound(key);
+                auto upper = b_tree.upper_bound(key);
+                auto expected_lower = reference.lower_bound(key);
+                auto expected_upper = reference.upper_bound(key);
+                REQUIRE((lower == b_tree.end()) == (expected_lower == reference.end()));
+                REQUIRE((upper == b_tree.end()) == (expected_upper == reference.end()));
+                if (lower != b_tree.end()) REQUIRE(lower->key == *expected_lower);
+                if (upper != b_tree.end()) REQUIRE(upper->key == *expected_upper);
+        }
+        while (!reference.empty()) {
+                REQUIRE(b_tree.erase(*reference.begin()));
+                reference.erase(reference.begin());
+        }
+        REQUIRE(b_tree.empty());
+        REQUIRE(b_tree.height() == 0);
+}
+
+SCENARIO("Test B Tree") {
+        GIVEN("A B Tree") {
+                forest::b_tree <int, int> b_tree;
+                WHEN("The B Tree is empty") {
+                        THEN("Test empty") {
+                                REQUIRE(b_tree.empty() == true);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(b_tree.size() == 0);
+                        }
+                        THEN("Test height") {
+                                REQUIRE(b_tree.height() == 0);
+                        }
+                        THEN("Test maximum") {
+                                auto max = b_tree.maximum();
+                                REQUIRE(max == nullptr);
+                        }
+                        THEN("Test minimum") {
+                                auto min = b_tree.minimum();
+                                REQUIRE(min == nullptr);
+                        }
+                        THEN("Test search for a key that does not exist") {
+                                auto result = b_tree.search(555);
+                                REQUIRE(result == nullptr);
+                        }
+                        THEN("Test iteration") {
+                                REQUIRE(b_tree.begin() == b_tree.end());
+                        }
+                }
+                WHEN("Keys are inserted in random order") {
+                        REQUIRE(b_tree.insert(4 , -10) != nullptr);
+                        REQUIRE(b_tree.insert(2 ,  30) != nullptr);
+                        REQUIRE(b_tree.insert(90, -74) != nullptr);
+                        REQUIRE(b_tree.insert(3 ,   1) != nullptr);
+                        REQUIRE(b_tree.insert(0 ,-110) != nullptr);
+                        REQUIRE(b_tree.insert(14,   0) != nullptr);
+                        REQUIRE(b_tree.insert(45,   0) != nullptr);
+                        THEN("Test empty") {
+                                REQUIRE(b_tree.empty() == false);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(b_tree.size() == 7);
+                        }
+                        THEN("Test size after inserting a key that already exists") {
+                                REQUIRE(b_tree.insert(3, 5) == nullptr);
+                                REQUIRE(b_tree.size() == 7);
+                                REQUIRE(b_tree.search(3)->value == 1);
+                        }
+                        THEN("Test height") {
+                                REQUIRE(b_tree.height() == 1);
+                        }
+                        THEN("Test maximum") {
+                                auto max = b_tree.maximum();
+                                REQUIRE(max != nullptr);
+                                REQUIRE(max->key == 90);
+                                REQUIRE(max->value == -74);
+                        }
+                        THEN("Test minimum") {
+                                auto min = b_tree.minimum();
+                                REQUIRE(min != nullptr);
+                                REQUIRE(min->key == 0);
+                                REQUIRE(min->value == -110);
+                        }
+                        THEN("Test search for a key that does not exist") {
+                                auto result = b_tree.search(1337);
+                                REQUIRE(result == nullptr);
+                        }
+                        THEN("Test search for a key that does exist") {
+                                auto result = b_tree.search(3);
+                                REQUIRE(result != nullptr);
+                                REQUIRE(result->key == 3);
+                                REQUIRE(result->value == 1);
+                                result->value = 2;
+                                REQUIRE(b_tree.search(3)->value == 2);
+                        }
+                }
+        }
+        GIVEN("A B Tree with 3 keys per node") {
+                forest::b_tree <int, int, std::less <int>, 3> b_tree;
+                WHEN("Keys are inserted in ascending order") {
+                        for (int i = 0; i < 10; i++) {
+                                REQUIRE(b_tree.insert(i, i*i) != nullptr);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(b_tree.size() == 10);
+                        }
+                        THEN("Test height") {
+                                REQUIRE(b_tree.height() == 3);
+                        }
+                        THEN("Test maximum") {
+                                auto max = b_tree.maximum();
+                                REQUIRE(max != nullptr);
+                                REQUIRE(max->key == 9);
+                                REQUIRE(max->value == 81);
+                        }
+                        THEN("Test minimum") {
+                                auto min = b_tree.minimum();
+                                REQUIRE(min != nullptr);
+                                REQUIRE(min->key == 0);
+                                REQUIRE(min->value == 0);
+                        }
+                        THEN("Test iteration in both directions") {
+                                int key = 0;
+                                for (auto it = b_tree.begin(); it != b_tree.end(); ++it) {
+                                        REQUIRE(it->key == key);
+                                        REQUIRE((*it).value == key * key);
+                                        key++;
+                                }
+                                REQUIRE(key == 10);
+                                for (auto it = b_tree.end(); it != b_tree.begin();) {
+                                        --it;
+                                        key--;
+                                        REQUIRE(it->key == key);
+                                }
+                                REQUIRE(key == 0);
+                        }
+                }
+                WHEN("Keys are inserted in descending order") {
+                        for (int i = 9; i >= 0; i--) {
+                                REQUIRE(b_tree.insert(i, i*i) != nullptr);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(b_tree.size() == 10);
+                        }
+                        THEN("Test search for a key that does exist") {
+                                auto result = b_tree.search(3);
+                                REQUIRE(result != nullptr);
+                                REQUIRE(result->key == 3);
+                                REQUIRE(result->value == 9);
+                        }
+                        THEN("Test pop_min and pop_max") {
+                                REQUIRE(b_tree.pop_min());
+                                REQUIRE(b_tree.pop_max());
+                                REQUIRE(b_tree.minimum()->key == 1);
+                                REQUIRE(b_tree.maximum()->key == 8);
+                                while (b_tree.pop_max()) {
+
+                                }
+                                REQUIRE(b_tree.empty());
+                                REQUIRE(!b_tree.pop_min());
+                        }
+                }
+        }
+}
+
+SCENARIO("Test B Tree random inserts and erases") {
+        GIVEN("B Trees of different capacities") {
+                THEN("Every capacity matches a std::set and stays balanced") {
+                        random_operations <3> (1);
+                        random_operations <4> (2);
+                        random_operations <7> (3);
+                        random_operations <16> (4);
+                        random_operations <forest::b_tree_capacity <int>::value> (5);
+                }
+        }
+}
+
+SCENARIO("Test B Tree range queries") {
+        GIVEN("A B Tree with the even keys 0 to 198") {
+                forest::b_tree <int, int, std::less <int>, 5> b_tree;
+                for (int i = 0; i < 100; i++) {
+                        b_tree.insert(i * 2, i);
+                }
+                THEN("Test equal_range") {
+                        auto range = b_tree.equal_range(10);
+                        REQUIRE(range.first->key == 10);
+                        REQUIRE(range.second->key == 12);
+                        range = b_tree.equal_range(11);
+                        REQUIRE(range.first == range.second);
+                }
+                THEN("Test for_each_in_range") {
+                        std::vector <int> keys;
+                        b_tree.for_each_in_range(15, 31, [&keys](const forest::b_tree_reference <int, const int> &element) {
+                                keys.push_back(element.key);
+                        });
+                        REQUIRE(keys == std::vector <int> ({16, 18, 20, 22, 24, 26, 28, 30}));
+                        keys.clear();
+                        b_tree.for_each_in_range(190, 1000, [&keys](const forest::b_tree_reference <int, const int> &element) {
+                                keys.push_back(element.key);
+                        });
+                        REQUIRE(keys == std::vector <int> ({190, 192, 194, 196, 198}));
+                }
+        }
+}
+
+SCENARIO("Test B Tree value construction") {
+        GIVEN("A B Tree of counted values") {
+                long long alive = counted::alive();
+                {
+                        forest::b_tree <int, counted, std::less <int>, 3> b_tree;
+                        for (int i = 0; i < 100; i++) {
+                                b_tree.insert(i, counted(i));
+                        }
+                        REQUIRE(counted::alive() == alive + 100);
+                        THEN("Test inserting a duplicate key leaves the value untouched") {
+                                counted value(50);
+                                counted::reset();
+                                REQUIRE(b_tree.insert(5, std::move(value)) == nullptr);
+                                REQUIRE(counted::copies() == 0);
+                                REQUIRE(counted::moves() == 0);
+                                REQUIRE(value.value == 50);
+                                REQUIRE(b_tree.search(5)->value.value == 5);
+                        }
+                        THEN("Test try_emplace with an existing key constructs nothing") {
+                                counted::reset();
+                                auto result = b_tree.try_emplace(5, 100);
+                                REQUIRE(!result.second);
+                                REQUIRE(result.first == b_tree.search(5));
+                                REQUIRE(counted::alive() == alive + 100);
+                                REQUIRE(counted::copies() == 0);
+                        }
+                        THEN("Test erasing destroys exactly the erased values") {
+                                for (int i = 0; i < 100; i += 2) {
+                                        REQUIRE(b_tree.erase(i));
+                                }
+                                REQUIRE(counted::alive() == alive + 50);
+                                int key = 1;
+                                for (const auto &element : b_tree) {
+                                        REQUIRE(element.value.value == key);
+                                        key += 2;
+                                }
+                        }
+                }
+                THEN("Test every value is destroyed with the B Tree") {
+                        REQUIRE(counted::alive() == alive);
+                }
+        }
+        GIVEN("A B Tree of move only values") {
+                forest::b_tree <std::string, std::unique_ptr <int>, std::less <std::string>, 3> b_tree;
+                THEN("Test insert, try_emplace, emplace and erase") {
+                        std::string key = "b";
+                        REQUIRE(b_tree.insert(std::move(key), std::unique_ptr <int> (new int(2))) != nullptr);
+                        REQUIRE(b_tree.try_emplace("a", new int(1)).second);
+                        REQUIRE(b_tree.emplace("c", new int(3)).second);
+                        REQUIRE(!b_tree.emplace("c", nullptr).second);
+                        REQUIRE(b_tree.try_emplace("d", new int(4)).second);
+                        REQUIRE(b_tree.erase("b"));
+                        REQUIRE(b_tree.size() == 3);
+                        std::vector <int> values;
+                        for (const auto &element : b_tree) {
+                                values.push_back(*element.value);
+                        }
+                        REQUIRE(values == std::vector <int> ({1, 3, 4}));
+                }
+        }
+}
+
+SCENARIO("Test B Tree upserts") {
+        GIVEN("A B Tree of word counts") {
+                forest::b_tree <std::string, int, string_less, 3> b_tree;
+                std::vector <std::string> words = {"b", "a", "c", "a", "d", "b", "a", "e", "f", "g"};
+                for (const std::string &word : words) {
+                        b_tree.upsert(word, [](int &count) {
+                                count++;
+                        });
+                }
+                THEN("Test the counts and a transparent search") {
+                        REQUIRE(b_tree.size() == 7);
+                        REQUIRE(b_tree.search("a")->value == 3);
+                        REQUIRE(b_tree.search("b")->value == 2);
+                        REQUIRE(b_tree.search("z") == nullptr);
+                        REQUIRE(b_tree.lower_bound("bb")->key == "c");
+                }
+                THEN("Test insert_or_assign") {
+                        REQUIRE(!b_tree.insert_or_assign("a", 10).second);
+                        REQUIRE(b_tree.insert_or_assign("h", 20).second);
+                        REQUIRE(b_tree.search("a")->value == 10);
+                        REQUIRE(b_tree.search("h")->value == 20);
+                }
+        }
+}
+
+/**
+ * @brief Compares node_search against std::lower_bound and std::upper_bound on sorted arrays of every length up to 200
+ */
+template <typename key_t>
+bool same_node_search(unsigned seed) {
+        std::mt19937 random(seed);
+        for (std::size_t count = 0; count <= 200; count++) {
+                std::vector <key_t> keys;
+                for (std::size_t i = 0; i < count; i++) {
+                        // Few distinct keys, so runs of equal keys cross vector boundaries
+                        keys.push_back(static_cast<key_t>(static_cast<int>(random() % 300) - 150));
+                }
+                std::sort(keys.begin(), keys.end());
+                for (int query = -160; query <= 160; query++) {
+                        key_t key = static_cast<key_t>(query);
+                        std::size_t lower = forest::node_search <key_t, std::less <key_t> >::lower_bound(keys.data(), count, key, std::less <key_t> ());
+                        std::size_t upper = forest::node_search <key_t, std::less <key_t> >::upper_bound(keys.data(), count, key, std::less <key_t> ());
+                        if (lower != static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin())) return false;
+                        if (upper != static_cast<std::size_t>(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin())) return false;
+                }
+        }
+        return true;
+}
+
+SCENARIO("Test B Tree node search") {
+        GIVEN("Sorted arrays of arithmetic keys") {
+                THEN("Test every key type agrees with a binary search") {
+                        REQUIRE(same_node_search <std::int32_t> (1));
+                        REQUIRE(same_node_search <std::int64_t> (2));
+                        REQUIRE(same_node_search <float> (3));
+                        REQUIRE(same_node_search <double> (4));
+                        REQUIRE(same_node_search <std::int16_t> (5));
+                }
+        }
+        GIVEN("B Trees of 64 bit and floating point keys") {
+                forest::b_tree <std::int64_t, int> int64_tree;
+                forest::b_tree <float, int, std::less <float>, 16> float_tree;
+                for (int i = 0; i < 1000; i++) {
+                        int64_tree.insert(static_cast<std::int64_t>(i) * 3000000000LL, i);
+                        float_tree.insert(i * 0.5f, i);
+                }
+                THEN("Test search and bounds") {
+                        for (int i = 0; i < 1000; i++) {
+                                REQUIRE(int64_tree.search(static_cast<std::int64_t>(i) * 3000000000LL)->value == i);
+                                REQUIRE(int64_tree.search(static_cast<std::int64_t>(i) * 3000000000LL + 1) == nullptr);
+                                REQUIRE(float_tree.search(i * 0.5f)->value == i);
+                                REQUIRE(float_tree.search(i * 0.5f + 0.25f) == nullptr);
+                        }
+                        REQUIRE(int64_tree.lower_bound(-1)->value == 0);
+                        REQUIRE(int64_tree.upper_bound(3000000000LL)->value == 2);
+                        REQUIRE(float_tree.lower_bound(10.1f)->value == 21);
+                        REQUIRE(float_tree.upper_bound(10.0f)->value == 21);
+                }
+        }
+}
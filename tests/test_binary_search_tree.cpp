@@ -1,5 +1,44 @@
 #include "catch.hpp"
 #include <forest/binary_search_tree.h>
+#include "assignable.h"
+#include "counted.h"
+#include "string_less.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(!element_assignable <forest::binary_search_tree <int, int>::iterator>::value, "whole nodes must not be assigned or swapped through an iterator, their links would go with them");
+static_assert(!key_assignable <forest::binary_search_tree <int, int>::iterator>::value, "keys must not be changed through an iterator");
+static_assert(value_assignable <forest::binary_search_tree <int, int>::iterator>::value, "values may be changed through an iterator");
+static_assert(!links_assignable <decltype(std::declval <forest::binary_search_tree <int, int> &> ().search(0))>::value, "a node returned by search must not be relinked");
+static_assert(!links_assignable <forest::binary_search_tree <int, int>::iterator>::value, "nodes must not be relinked through an iterator");
+
+/**
+ * @brief Checks the parent links and the ordering of the subtree rooted at x
+ */
+template <typename node_t>
+bool valid(const node_t *x) {
+        if (x == nullptr) return true;
+        if (x->get_left() != nullptr && (x->get_left()->get_parent() != x || !(x->get_left()->key < x->key))) return false;
+        if (x->get_right() != nullptr && (x->get_right()->get_parent() != x || !(x->key < x->get_right()->key))) return false;
+        return valid <node_t> (x->get_left()) && valid <node_t> (x->get_right());
+}
+
+/**
+ * @brief Finds the root of the tree containing x
+ */
+template <typename node_t>
+const node_t *find_root(const node_t *x) {
+        if (x == nullptr) return nullptr;
+        while (x->get_parent() != nullptr) x = x->get_parent();
+        return x;
+}
 
 SCENARIO("Test Binary Search Tree") {
         GIVEN("A Binary Search Tree") {
@@ -41,6 +80,10 @@ SCENARIO("Test Binary Search Tree") {
                         THEN("Test size") {
                                 REQUIRE(binary_search_tree.size() == 7);
                         }
+                        THEN("Test size after inserting a key that already exists") {
+                                binary_search_tree.insert(3, 5);
+                                REQUIRE(binary_search_tree.size() == 7);
+                        }
                         THEN("Test height") {
                                 REQUIRE(binary_search_tree.height() == 4);
                         }
@@ -141,3 +184,795 @@ SCENARIO("Test Binary Search Tree") {
                 }
         }
 }
+
+SCENARIO("Test Binary Search Tree destruction") {
+        GIVEN("A Binary Search Tree of counted values") {
+                long long alive = counted::alive();
+                WHEN("The Binary Search Tree goes out of scope") {
+                        {
+                                forest::binary_search_tree <int, counted> binary_search_tree;
+                                for (int i = 0; i < 1000; i++) {
+                                        binary_search_tree.insert((i * 7919) % 1000, counted(i));
+                                }
+                                REQUIRE(counted::alive() == alive + 1000);
+                        }
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                        }
+                }
+                WHEN("Nodes are inserted in ascending order and the Binary Search Tree goes out of scope") {
+                        {
+                                forest::binary_search_tree <int, counted> binary_search_tree;
+                                for (int i = 0; i < 10000; i++) {
+                                        binary_search_tree.insert(i, counted(i));
+                                }
+                        }
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                        }
+                }
+                WHEN("The Binary Search Tree is cleared") {
+                        forest::binary_search_tree <int, counted> binary_search_tree;
+                        for (int i = 0; i < 1000; i++) {
+                                binary_search_tree.insert(i, counted(i));
+                        }
+                        binary_search_tree.clear();
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                                REQUIRE(binary_search_tree.empty() == true);
+                                REQUIRE(binary_search_tree.size() == 0);
+                                REQUIRE(binary_search_tree.search(10) == nullptr);
+                        }
+                        THEN("The Binary Search Tree can be reused") {
+                                REQUIRE(binary_search_tree.insert(10, counted(10)) != nullptr);
+                                REQUIRE(binary_search_tree.size() == 1);
+                                REQUIRE(binary_search_tree.search(10) != nullptr);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree erase") {
+        GIVEN("A Binary Search Tree") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                binary_search_tree.insert(4 , -10);
+                binary_search_tree.insert(2 ,  30);
+                binary_search_tree.insert(90, -74);
+                binary_search_tree.insert(3 ,   1);
+                binary_search_tree.insert(0 ,-110);
+                binary_search_tree.insert(14,   0);
+                binary_search_tree.insert(45,   0);
+                WHEN("A key that does not exist is erased") {
+                        THEN("Nothing is removed") {
+                                REQUIRE(binary_search_tree.erase(1337) == false);
+                                REQUIRE(binary_search_tree.size() == 7);
+                        }
+                }
+                WHEN("A leaf is erased") {
+                        REQUIRE(binary_search_tree.erase(45) == true);
+                        THEN("The node is removed") {
+                                REQUIRE(binary_search_tree.size() == 6);
+                                REQUIRE(binary_search_tree.search(45) == nullptr);
+                                REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        }
+                }
+                WHEN("A node with one child is erased") {
+                        REQUIRE(binary_search_tree.erase(90) == true);
+                        THEN("The child takes its place") {
+                                REQUIRE(binary_search_tree.size() == 6);
+                                REQUIRE(binary_search_tree.maximum()->key == 45);
+                                REQUIRE(binary_search_tree.search(14)->get_parent()->key == 4);
+                                REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        }
+                }
+                WHEN("The root which has two children is erased") {
+                        const forest::binary_search_tree_node <int, int> *successor = binary_search_tree.search(14);
+                        REQUIRE(binary_search_tree.erase(4) == true);
+                        THEN("The successor node is relinked in its place") {
+                                REQUIRE(binary_search_tree.size() == 6);
+                                REQUIRE(binary_search_tree.search(4) == nullptr);
+                                REQUIRE(binary_search_tree.search(14) == successor);
+                                REQUIRE(find_root(successor) == successor);
+                                REQUIRE(successor->value == 0);
+                                REQUIRE(valid(successor));
+                        }
+                }
+                WHEN("Every key is erased") {
+                        for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                                REQUIRE(binary_search_tree.erase(key) == true);
+                        }
+                        THEN("The Binary Search Tree is empty") {
+                                REQUIRE(binary_search_tree.empty() == true);
+                                REQUIRE(binary_search_tree.size() == 0);
+                                REQUIRE(binary_search_tree.minimum() == nullptr);
+                        }
+                }
+        }
+        GIVEN("A Binary Search Tree under random inserts and erases") {
+                forest::binary_search_tree <int, counted> binary_search_tree;
+                std::set <int> reference;
+                std::mt19937 random(1234);
+                long long alive = counted::alive();
+                bool ok = true;
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 512);
+                        if (random() % 2 == 0) {
+                                binary_search_tree.insert(key, counted(key));
+                                reference.insert(key);
+                        } else {
+                                ok = ok && binary_search_tree.erase(key) == (reference.erase(key) == 1);
+                        }
+                }
+                THEN("The contents are preserved") {
+                        REQUIRE(ok);
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        REQUIRE(binary_search_tree.size() == reference.size());
+                        REQUIRE(counted::alive() == alive + static_cast<long long>(reference.size()));
+                        for (int key = 0; key < 512; key++) {
+                                REQUIRE((binary_search_tree.search(key) != nullptr) == (reference.count(key) == 1));
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree iterators") {
+        GIVEN("A Binary Search Tree") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                WHEN("The Binary Search Tree is empty") {
+                        THEN("begin is equal to end") {
+                                REQUIRE(binary_search_tree.begin() == binary_search_tree.end());
+                                REQUIRE(binary_search_tree.rbegin() == binary_search_tree.rend());
+                                REQUIRE(binary_search_tree.cbegin() == binary_search_tree.cend());
+                        }
+                }
+                WHEN("Nodes are inserted in random order") {
+                        for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                                binary_search_tree.insert(key, key * 10);
+                        }
+                        THEN("Test in order iteration") {
+                                std::vector <int> keys;
+                                for (auto &node : binary_search_tree) {
+                                        keys.push_back(node.key);
+                                        REQUIRE(node.value == node.key * 10);
+                                }
+                                REQUIRE(keys == std::vector <int>({0, 2, 3, 4, 14, 45, 90}));
+                        }
+                        THEN("Test reverse iteration") {
+                                std::vector <int> keys;
+                                for (auto it = binary_search_tree.rbegin(); it != binary_search_tree.rend(); ++it) {
+                                        keys.push_back(it->key);
+                                }
+                                REQUIRE(keys == std::vector <int>({90, 45, 14, 4, 3, 2, 0}));
+                        }
+                        THEN("Test decrementing end") {
+                                auto it = binary_search_tree.end();
+                                --it;
+                                REQUIRE(it->key == 90);
+                                it--;
+                                REQUIRE(it->key == 45);
+                        }
+                        THEN("Test algorithms") {
+                                REQUIRE(std::distance(binary_search_tree.begin(), binary_search_tree.end()) == 7);
+                                auto it = std::find_if(binary_search_tree.begin(), binary_search_tree.end(), [](const forest::binary_search_tree_node <int, int> &node) {
+                                        return node.key > 10;
+                                });
+                                REQUIRE(it != binary_search_tree.end());
+                                REQUIRE(it->key == 14);
+                        }
+                        THEN("Test constant iteration") {
+                                const forest::binary_search_tree <int, int> &tree = binary_search_tree;
+                                forest::binary_search_tree <int, int>::const_iterator it = binary_search_tree.begin();
+                                REQUIRE(it == tree.begin());
+                                int sum = 0;
+                                for (const auto &node : tree) {
+                                        sum += node.key;
+                                }
+                                REQUIRE(sum == 158);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree range queries") {
+        GIVEN("A Binary Search Tree with the even keys from 0 to 98") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                for (int i = 0; i < 50; i++) {
+                        binary_search_tree.insert((i * 17) % 50 * 2, i);
+                }
+                THEN("Test lower_bound") {
+                        REQUIRE(binary_search_tree.lower_bound(-5)->key == 0);
+                        REQUIRE(binary_search_tree.lower_bound(10)->key == 10);
+                        REQUIRE(binary_search_tree.lower_bound(11)->key == 12);
+                        REQUIRE(binary_search_tree.lower_bound(98)->key == 98);
+                        REQUIRE(binary_search_tree.lower_bound(99) == binary_search_tree.end());
+                }
+                THEN("Test upper_bound") {
+                        REQUIRE(binary_search_tree.upper_bound(-5)->key == 0);
+                        REQUIRE(binary_search_tree.upper_bound(10)->key == 12);
+                        REQUIRE(binary_search_tree.upper_bound(11)->key == 12);
+                        REQUIRE(binary_search_tree.upper_bound(98) == binary_search_tree.end());
+                }
+                THEN("Test equal_range") {
+                        auto found = binary_search_tree.equal_range(20);
+                        REQUIRE(std::distance(found.first, found.second) == 1);
+                        REQUIRE(found.first->key == 20);
+                        auto missing = binary_search_tree.equal_range(21);
+                        REQUIRE(missing.first == missing.second);
+                        REQUIRE(missing.first->key == 22);
+                }
+                THEN("Test for_each_in_range") {
+                        std::vector <int> keys;
+                        binary_search_tree.for_each_in_range(15, 25, [&keys](const forest::binary_search_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys == std::vector <int>({16, 18, 20, 22, 24}));
+                        keys.clear();
+                        binary_search_tree.for_each_in_range(90, 1000, [&keys](const forest::binary_search_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys == std::vector <int>({90, 92, 94, 96, 98}));
+                        keys.clear();
+                        binary_search_tree.for_each_in_range(31, 32, [&keys](const forest::binary_search_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys.empty());
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree bulk loading") {
+        GIVEN("Sorted ranges of every size up to 100") {
+                THEN("from_sorted creates a perfectly balanced Binary Search Tree containing the range") {
+                        for (int n = 0; n <= 100; n++) {
+                                std::vector <std::pair <int, int> > pairs;
+                                for (int i = 0; i < n; i++) {
+                                        pairs.push_back(std::make_pair(i * 3, -i));
+                                }
+                                auto binary_search_tree = forest::binary_search_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+                                unsigned long long height = 0;
+                                while ((1ULL << height) - 1 < static_cast<unsigned long long>(n)) height++;
+                                REQUIRE(binary_search_tree.size() == static_cast<unsigned long long>(n));
+                                REQUIRE(binary_search_tree.height() == height);
+                                REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                                std::vector <std::pair <int, int> > contents;
+                                for (const auto &node : binary_search_tree) {
+                                        contents.push_back(std::make_pair(node.key, node.value));
+                                }
+                                REQUIRE(contents == pairs);
+                        }
+                }
+        }
+        GIVEN("A Binary Search Tree with nodes") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                for (int i = 0; i < 10; i++) {
+                        binary_search_tree.insert(i, i);
+                }
+                WHEN("A sorted range is assigned") {
+                        std::vector <std::pair <int, int> > pairs;
+                        for (int i = 100; i < 200; i += 2) {
+                                pairs.push_back(std::make_pair(i, i));
+                        }
+                        binary_search_tree.assign_sorted(pairs.begin(), pairs.end());
+                        THEN("The old nodes are replaced") {
+                                REQUIRE(binary_search_tree.size() == 50);
+                                REQUIRE(binary_search_tree.search(5) == nullptr);
+                                REQUIRE(binary_search_tree.minimum()->key == 100);
+                                REQUIRE(binary_search_tree.maximum()->key == 198);
+                        }
+                        THEN("The Binary Search Tree can still be modified") {
+                                REQUIRE(binary_search_tree.insert(101, 0) != nullptr);
+                                REQUIRE(binary_search_tree.erase(100) == true);
+                                REQUIRE(binary_search_tree.size() == 50);
+                                REQUIRE(binary_search_tree.minimum()->key == 101);
+                                REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        }
+                }
+        }
+        GIVEN("A Binary Search Tree of counted values and a sorted range whose values throw when copied") {
+                forest::binary_search_tree <int, counted> binary_search_tree;
+                for (int i = 0; i < 10; i++) {
+                        binary_search_tree.insert(i, counted(i));
+                }
+                std::vector <std::pair <int, counted> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i, counted(i)));
+                }
+                long long alive = counted::alive() - 10;
+                THEN("Every node built before the throw is freed and the Binary Search Tree is left empty") {
+                        bool ok = true;
+                        for (long long limit = 0; limit < 100; limit++) {
+                                counted::reset();
+                                counted::copy_limit() = limit;
+                                bool thrown = false;
+                                try {
+                                        binary_search_tree.assign_sorted(pairs.begin(), pairs.end());
+                                } catch (const std::runtime_error &) {
+                                        thrown = true;
+                                }
+                                ok = ok && thrown && counted::alive() == alive && binary_search_tree.empty() && binary_search_tree.size() == 0;
+                                ok = ok && binary_search_tree.minimum() == nullptr && binary_search_tree.begin() == binary_search_tree.end();
+                        }
+                        counted::reset();
+                        REQUIRE(ok);
+                }
+                THEN("The Binary Search Tree can be bulk loaded again") {
+                        counted::reset();
+                        counted::copy_limit() = 50;
+                        REQUIRE_THROWS_AS(binary_search_tree.assign_sorted(pairs.begin(), pairs.end()), std::runtime_error);
+                        counted::reset();
+                        binary_search_tree.assign_sorted(pairs.begin(), pairs.end());
+                        REQUIRE(binary_search_tree.size() == 100);
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        REQUIRE(counted::alive() == alive + 100);
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree comparators") {
+        GIVEN("A Binary Search Tree ordered by std::greater") {
+                forest::binary_search_tree <int, int, std::greater <int> > binary_search_tree;
+                for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                        binary_search_tree.insert(key, key);
+                }
+                THEN("The keys are in descending order") {
+                        std::vector <int> keys;
+                        for (const auto &node : binary_search_tree) {
+                                keys.push_back(node.key);
+                        }
+                        REQUIRE(keys == std::vector <int>({90, 45, 14, 4, 3, 2, 0}));
+                        REQUIRE(binary_search_tree.minimum()->key == 90);
+                        REQUIRE(binary_search_tree.maximum()->key == 0);
+                        REQUIRE(binary_search_tree.search(14) != nullptr);
+                        REQUIRE(binary_search_tree.search(15) == nullptr);
+                        REQUIRE(binary_search_tree.lower_bound(15)->key == 14);
+                        REQUIRE(binary_search_tree.insert(14, 0) == nullptr);
+                        REQUIRE(binary_search_tree.size() == 7);
+                }
+        }
+        GIVEN("A Binary Search Tree of strings with a transparent comparator") {
+                forest::binary_search_tree <std::string, int, string_less> binary_search_tree;
+                const char *words[] = {"pear", "apple", "fig", "banana", "cherry", "kiwi", "grape", "lemon"};
+                for (int i = 0; i < 8; i++) {
+                        binary_search_tree.insert(words[i], i);
+                }
+                THEN("Test search with a const char *") {
+                        auto result = binary_search_tree.search("banana");
+                        REQUIRE(result != nullptr);
+                        REQUIRE(result->value == 3);
+                        REQUIRE(binary_search_tree.search("mango") == nullptr);
+                }
+                THEN("Test bounds with a const char *") {
+                        REQUIRE(binary_search_tree.lower_bound("c")->key == "cherry");
+                        REQUIRE(binary_search_tree.upper_bound("fig")->key == "grape");
+                        auto range = binary_search_tree.equal_range("kiwi");
+                        REQUIRE(std::distance(range.first, range.second) == 1);
+                }
+                THEN("Test one comparison per level") {
+                        unsigned long long height = binary_search_tree.height();
+                        for (int i = 0; i < 8; i++) {
+                                long long comparisons = string_less::comparisons();
+                                REQUIRE(binary_search_tree.search(words[i]) != nullptr);
+                                REQUIRE(string_less::comparisons() - comparisons <= static_cast<long long>(height) + 1);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree value construction") {
+        GIVEN("A Binary Search Tree of counted values") {
+                forest::binary_search_tree <int, counted> binary_search_tree;
+                for (int i = 0; i < 10; i++) {
+                        binary_search_tree.insert(i, counted(i));
+                }
+                THEN("Test inserting an rvalue moves the value") {
+                        counted::reset();
+                        REQUIRE(binary_search_tree.insert(10, counted(10)) != nullptr);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 1);
+                }
+                THEN("Test inserting an lvalue copies the value once") {
+                        counted value(10);
+                        counted::reset();
+                        REQUIRE(binary_search_tree.insert(10, value) != nullptr);
+                        REQUIRE(counted::copies() == 1);
+                        REQUIRE(counted::moves() == 0);
+                }
+                THEN("Test inserting a duplicate key leaves the value untouched") {
+                        counted value(50);
+                        counted::reset();
+                        REQUIRE(binary_search_tree.insert(5, std::move(value)) == nullptr);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 0);
+                        REQUIRE(value.value == 50);
+                        REQUIRE(binary_search_tree.search(5)->value.value == 5);
+                }
+                THEN("Test try_emplace constructs the value in place") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        auto result = binary_search_tree.try_emplace(10, 100);
+                        REQUIRE(result.second);
+                        REQUIRE(result.first->key == 10);
+                        REQUIRE(result.first->value.value == 100);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 0);
+                        REQUIRE(counted::alive() == alive + 1);
+                }
+                THEN("Test try_emplace with an existing key constructs nothing") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        auto result = binary_search_tree.try_emplace(5, 100);
+                        REQUIRE(!result.second);
+                        REQUIRE(result.first == binary_search_tree.search(5));
+                        REQUIRE(result.first->value.value == 5);
+                        REQUIRE(counted::alive() == alive);
+                        REQUIRE(binary_search_tree.size() == 10);
+                }
+        }
+        GIVEN("A Binary Search Tree of move only values") {
+                forest::binary_search_tree <std::string, std::unique_ptr <int> > binary_search_tree;
+                THEN("Test insert, try_emplace and emplace") {
+                        std::string key = "b";
+                        REQUIRE(binary_search_tree.insert(std::move(key), std::unique_ptr <int> (new int(2))) != nullptr);
+                        REQUIRE(binary_search_tree.try_emplace("a", new int(1)).second);
+                        REQUIRE(binary_search_tree.emplace("c", new int(3)).second);
+                        REQUIRE(!binary_search_tree.emplace("c", nullptr).second);
+                        REQUIRE(binary_search_tree.size() == 3);
+                        int expected = 1;
+                        for (const auto &node : binary_search_tree) {
+                                REQUIRE(*node.value == expected++);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree upserts") {
+        GIVEN("A Binary Search Tree of word counts") {
+                forest::binary_search_tree <std::string, int> binary_search_tree;
+                const char *words[] = {"to", "be", "or", "not", "to", "be", "that", "is", "the", "question", "to"};
+                for (const char *word : words) {
+                        binary_search_tree.upsert(word, [](int &count) { count++; });
+                }
+                THEN("Test every word is counted once per occurrence") {
+                        REQUIRE(binary_search_tree.size() == 8);
+                        REQUIRE(binary_search_tree.search("to")->value == 3);
+                        REQUIRE(binary_search_tree.search("be")->value == 2);
+                        REQUIRE(binary_search_tree.search("question")->value == 1);
+                        int total = 0;
+                        for (const auto &node : binary_search_tree) {
+                                total += node.value;
+                        }
+                        REQUIRE(total == 11);
+                }
+                THEN("Test insert_or_assign inserts new keys") {
+                        auto result = binary_search_tree.insert_or_assign("whether", 7);
+                        REQUIRE(result.second);
+                        REQUIRE(result.first->key == "whether");
+                        REQUIRE(result.first->value == 7);
+                        REQUIRE(binary_search_tree.size() == 9);
+                }
+                THEN("Test insert_or_assign assigns existing keys") {
+                        auto result = binary_search_tree.insert_or_assign("be", 10);
+                        REQUIRE(!result.second);
+                        REQUIRE(result.first == binary_search_tree.search("be"));
+                        REQUIRE(result.first->value == 10);
+                        REQUIRE(binary_search_tree.size() == 8);
+                }
+                THEN("Test values can be modified through returned nodes") {
+                        binary_search_tree.search("or")->value = 42;
+                        binary_search_tree.try_emplace("not").first->value += 5;
+                        REQUIRE(binary_search_tree.search("or")->value == 42);
+                        REQUIRE(binary_search_tree.search("not")->value == 6);
+                        REQUIRE(binary_search_tree.upsert("is", [](int &count) { count *= 3; })->value == 3);
+                }
+        }
+        GIVEN("A Binary Search Tree of counted values") {
+                forest::binary_search_tree <int, counted> binary_search_tree;
+                binary_search_tree.insert(1, counted(1));
+                THEN("Test insert_or_assign moves into the existing value") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        REQUIRE(!binary_search_tree.insert_or_assign(1, counted(2)).second);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 1);
+                        REQUIRE(counted::alive() == alive);
+                        REQUIRE(binary_search_tree.search(1)->value.value == 2);
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree hinted insertion") {
+        GIVEN("An empty Binary Search Tree") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                THEN("Test increasing keys inserted at end()") {
+                        for (int i = 0; i < 1000; i++) {
+                                auto x = binary_search_tree.insert(binary_search_tree.end(), i, i * 2);
+                                REQUIRE(x->key == i);
+                        }
+                        REQUIRE(binary_search_tree.size() == 1000);
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        int expected = 0;
+                        for (const auto &node : binary_search_tree) {
+                                REQUIRE(node.key == expected);
+                                REQUIRE(node.value == expected * 2);
+                                expected++;
+                        }
+                }
+                THEN("Test decreasing keys inserted before the previous node") {
+                        auto hint = binary_search_tree.end();
+                        for (int i = 999; i >= 0; i--) {
+                                hint = binary_search_tree.insert(hint, i, i);
+                                REQUIRE(hint->key == i);
+                        }
+                        REQUIRE(binary_search_tree.size() == 1000);
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        REQUIRE(binary_search_tree.minimum()->key == 0);
+                        REQUIRE(binary_search_tree.maximum()->key == 999);
+                }
+                THEN("Test duplicate keys return the existing node") {
+                        binary_search_tree.insert(5, 50);
+                        auto x = binary_search_tree.insert(binary_search_tree.begin(), 5, 60);
+                        REQUIRE(x == binary_search_tree.begin());
+                        REQUIRE(x->value == 50);
+                        REQUIRE(binary_search_tree.insert(binary_search_tree.end(), 5, 70)->value == 50);
+                        REQUIRE(binary_search_tree.size() == 1);
+                }
+                THEN("Test the append path after the maximum is erased") {
+                        for (int i = 0; i < 100; i++) {
+                                binary_search_tree.insert(i, i);
+                        }
+                        for (int i = 99; i >= 50; i--) {
+                                REQUIRE(binary_search_tree.erase(i));
+                        }
+                        binary_search_tree.insert(60, 60);
+                        binary_search_tree.insert(55, 55);
+                        binary_search_tree.insert(binary_search_tree.end(), 70, 70);
+                        REQUIRE(binary_search_tree.maximum()->key == 70);
+                        REQUIRE(binary_search_tree.size() == 53);
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        std::vector <int> keys;
+                        for (const auto &node : binary_search_tree) {
+                                keys.push_back(node.key);
+                        }
+                        REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+                }
+        }
+        GIVEN("A Binary Search Tree filled with random keys and random hints") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                std::set <int> reference;
+                std::mt19937 random(11);
+                for (int i = 0; i < 2000; i++) {
+                        int key = static_cast<int>(random() % 1000);
+                        auto hint = binary_search_tree.lower_bound(static_cast<int>(random() % 1000));
+                        auto x = binary_search_tree.insert(hint, key, key);
+                        reference.insert(key);
+                        REQUIRE(x->key == key);
+                }
+                THEN("The tree holds the same keys as a std::set") {
+                        REQUIRE(binary_search_tree.size() == reference.size());
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        REQUIRE(std::equal(reference.begin(), reference.end(), binary_search_tree.begin(), [](int key, const forest::binary_search_tree_node <int, int> &node) {
+                                return key == node.key;
+                        }));
+                        REQUIRE(binary_search_tree.maximum()->key == *reference.rbegin());
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree minimum and maximum") {
+        GIVEN("An empty Binary Search Tree") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                THEN("There is no minimum or maximum to remove") {
+                        REQUIRE(binary_search_tree.minimum() == nullptr);
+                        REQUIRE(binary_search_tree.maximum() == nullptr);
+                        REQUIRE(!binary_search_tree.pop_min());
+                        REQUIRE(!binary_search_tree.pop_max());
+                }
+        }
+        GIVEN("A Binary Search Tree changed by random inserts and erases") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                std::set <int> reference;
+                std::mt19937 random(5);
+                THEN("The minimum and maximum always match a std::set") {
+                        for (int i = 0; i < 5000; i++) {
+                                int key = static_cast<int>(random() % 500);
+                                switch (random() % 4) {
+                                case 0:
+                                        REQUIRE(binary_search_tree.erase(key) == (reference.erase(key) == 1));
+                                        break;
+                                case 1:
+                                        REQUIRE(binary_search_tree.pop_min() == !reference.empty());
+                                        if (!reference.empty()) reference.erase(reference.begin());
+                                        break;
+                                default:
+                                        binary_search_tree.insert(key, key);
+                                        reference.insert(key);
+                                }
+                                if (reference.empty()) {
+                                        REQUIRE(binary_search_tree.minimum() == nullptr);
+                                        REQUIRE(binary_search_tree.maximum() == nullptr);
+                                } else {
+                                        REQUIRE(binary_search_tree.minimum()->key == *reference.begin());
+                                        REQUIRE(binary_search_tree.maximum()->key == *reference.rbegin());
+                                        REQUIRE(binary_search_tree.begin()->key == *reference.begin());
+                                }
+                        }
+                }
+        }
+        GIVEN("A Binary Search Tree with the keys 0 to 99") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                for (int key : {50, 20, 80, 10, 30, 70, 90}) {
+                        binary_search_tree.insert(key, key);
+                }
+                for (int i = 0; i < 100; i++) {
+                        binary_search_tree.insert(i, i);
+                }
+                THEN("Test pop_min removes the keys in increasing order") {
+                        for (int i = 0; i < 100; i++) {
+                                REQUIRE(binary_search_tree.minimum()->key == i);
+                                REQUIRE(binary_search_tree.pop_min());
+                        }
+                        REQUIRE(binary_search_tree.empty());
+                        REQUIRE(!binary_search_tree.pop_min());
+                }
+                THEN("Test pop_max removes the keys in decreasing order") {
+                        for (int i = 99; i >= 0; i--) {
+                                REQUIRE(binary_search_tree.maximum()->key == i);
+                                REQUIRE(binary_search_tree.pop_max());
+                        }
+                        REQUIRE(binary_search_tree.empty());
+                        REQUIRE(binary_search_tree.begin() == binary_search_tree.end());
+                }
+                THEN("Test popping from both ends") {
+                        for (int i = 0; i < 50; i++) {
+                                REQUIRE(binary_search_tree.pop_min());
+                                REQUIRE(binary_search_tree.pop_max());
+                        }
+                        REQUIRE(binary_search_tree.empty());
+                        binary_search_tree.insert(7, 7);
+                        REQUIRE(binary_search_tree.minimum() == binary_search_tree.maximum());
+                }
+        }
+        GIVEN("A bulk loaded Binary Search Tree") {
+                std::vector <std::pair <int, int> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i * 2, i));
+                }
+                forest::binary_search_tree <int, int> binary_search_tree = forest::binary_search_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+                THEN("The minimum and maximum are known") {
+                        REQUIRE(binary_search_tree.minimum()->key == 0);
+                        REQUIRE(binary_search_tree.maximum()->key == 198);
+                        forest::binary_search_tree <int, int> moved(std::move(binary_search_tree));
+                        REQUIRE(binary_search_tree.minimum() == nullptr);
+                        REQUIRE(moved.minimum()->key == 0);
+                        REQUIRE(moved.maximum()->key == 198);
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree index storage") {
+        typedef forest::binary_search_tree <int, int, std::less <int>, true> indexed_tree;
+        GIVEN("The node layouts") {
+                THEN("Links take 4 bytes each") {
+                        REQUIRE(sizeof(forest::binary_search_tree_node <int, int, true>) == 4 + 4 + 3 * 4);
+                        REQUIRE(sizeof(forest::binary_search_tree_node <int, int, true>) < sizeof(forest::binary_search_tree_node <int, int>));
+                }
+        }
+        GIVEN("An indexed Binary Search Tree under random inserts and erases") {
+                indexed_tree binary_search_tree;
+                std::set <int> reference;
+                std::mt19937 random(29);
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 1024);
+                        if (random() % 3 != 0) {
+                                binary_search_tree.insert(key, key);
+                                reference.insert(key);
+                        } else {
+                                REQUIRE(binary_search_tree.erase(key) == (reference.erase(key) == 1));
+                        }
+                }
+                THEN("The tree holds the same keys as a std::set") {
+                        REQUIRE(binary_search_tree.size() == reference.size());
+                        REQUIRE(std::equal(reference.begin(), reference.end(), binary_search_tree.begin(), [](int key, const forest::binary_search_tree_node <int, int, true> &node) {
+                                return key == node.key;
+                        }));
+                        REQUIRE(std::equal(reference.rbegin(), reference.rend(), binary_search_tree.rbegin(), [](int key, const forest::binary_search_tree_node <int, int, true> &node) {
+                                return key == node.key;
+                        }));
+                }
+                WHEN("The tree is cloned and the original is cleared") {
+                        indexed_tree copy = binary_search_tree.clone();
+                        binary_search_tree.clear();
+                        THEN("The clone keeps every node") {
+                                REQUIRE(copy.size() == reference.size());
+                                REQUIRE(copy.minimum()->key == *reference.begin());
+                                REQUIRE(copy.maximum()->key == *reference.rbegin());
+                                REQUIRE(std::equal(reference.begin(), reference.end(), copy.begin(), [](int key, const forest::binary_search_tree_node <int, int, true> &node) {
+                                        return key == node.key;
+                                }));
+                        }
+                }
+                WHEN("The tree is saved and loaded into another tree") {
+                        std::stringstream stream;
+                        binary_search_tree.save(stream);
+                        indexed_tree loaded;
+                        loaded.insert(-1, -1);
+                        loaded.load(stream);
+                        THEN("The loaded tree holds the same keys and accepts new ones") {
+                                REQUIRE(loaded.size() == reference.size());
+                                REQUIRE(std::equal(reference.begin(), reference.end(), loaded.begin(), [](int key, const forest::binary_search_tree_node <int, int, true> &node) {
+                                        return key == node.key;
+                                }));
+                                for (int i = 2000; i < 3000; i++) {
+                                        loaded.insert(i, i);
+                                }
+                                REQUIRE(loaded.size() == reference.size() + 1000);
+                                REQUIRE(loaded.search(2500)->value == 2500);
+                        }
+                }
+        }
+        GIVEN("An indexed Binary Search Tree filled through hints") {
+                indexed_tree binary_search_tree;
+                for (int i = 0; i < 1000; i++) {
+                        binary_search_tree.insert(binary_search_tree.end(), i * 2, i);
+                }
+                for (int i = 0; i < 1000; i++) {
+                        binary_search_tree.insert(binary_search_tree.lower_bound(i * 2 + 1), i * 2 + 1, i);
+                }
+                THEN("The hints survive the nodes moving as the array grows") {
+                        REQUIRE(valid(find_root(binary_search_tree.minimum())));
+                        REQUIRE(binary_search_tree.size() == 2000);
+                        int key = 0;
+                        for (const auto &node : binary_search_tree) {
+                                REQUIRE(node.key == key++);
+                        }
+                }
+        }
+        GIVEN("An indexed Binary Search Tree with reserved nodes") {
+                indexed_tree binary_search_tree;
+                binary_search_tree.reserve(1000);
+                binary_search_tree.insert(0, 0);
+                const forest::binary_search_tree_node <int, int, true> *first = binary_search_tree.search(0);
+                for (int i = 1; i < 1000; i++) {
+                        binary_search_tree.insert(i, i);
+                }
+                THEN("Nodes do not move") {
+                        REQUIRE(binary_search_tree.search(0) == first);
+                        REQUIRE(binary_search_tree.size() == 1000);
+                }
+        }
+}
+
+SCENARIO("Test Binary Search Tree batched search") {
+        GIVEN("An empty Binary Search Tree") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                forest::binary_search_tree <int, int> other;
+                other.insert(1, 1);
+                std::vector <int> keys = {1, 2, 3};
+                std::vector <forest::binary_search_tree_node <int, int> *> found(keys.size(), other.search(1));
+                binary_search_tree.search_batch(keys.data(), keys.size(), found.data());
+                THEN("Every search misses") {
+                        REQUIRE(std::count(found.begin(), found.end(), nullptr) == 3);
+                }
+        }
+        GIVEN("A Binary Search Tree with random keys") {
+                forest::binary_search_tree <int, int> binary_search_tree;
+                std::mt19937 random(99);
+                for (int i = 0; i < 1000; i++) {
+                        int key = static_cast<int>(random() % 2000);
+                        binary_search_tree.insert(key, -key);
+                }
+                THEN("Batches of every size up to 40 find what search finds") {
+                        for (std::size_t n = 0; n <= 40; n++) {
+                                std::vector <int> keys;
+                                for (std::size_t i = 0; i < n; i++) {
+                                        keys.push_back(static_cast<int>(random() % 2100) - 50);
+                                }
+                                std::vector <forest::binary_search_tree_node <int, int> *> found(n);
+                                binary_search_tree.search_batch(keys.data(), n, found.data());
+                                for (std::size_t i = 0; i < n; i++) {
+                                        REQUIRE(found[i] == binary_search_tree.search(keys[i]));
+                                }
+                        }
+                }
+        }
+}
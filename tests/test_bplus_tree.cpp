@@ -0,0 +1,352 @@
+#include "catch.hpp"
+#include <forest/bplus_tree.h>
+#include "counted.h"
+#include "string_less.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Finds the greatest height a b+ tree of n keys may have when every node but the root and the last leaf holds at least min_count keys
+ */
+unsigned long long bplus_maximum_height(unsigned long long n, unsigned long long min_count) {
+        if (n == 0) return 0;
+        unsigned long long leaves = n / min_count + 1;
+        if (leaves < 2) return 1;
+        return 2 + static_cast<unsigned long long>(std::floor(std::log(leaves / 2.0) / std::log(min_count + 1.0) + 1e-9));
+}
+
+/**
+ * @brief Checks a b+ tree against a std::set of the keys it should hold, walking the leaves in both directions
+ */
+template <typename tree_t>
+bool same_leaf_keys(const tree_t &tree, const std::set <int> &reference) {
+        if (tree.size() != reference.size()) return false;
+        if (!std::equal(reference.begin(), reference.end(), tree.begin(), [](int key, const forest::b_tree_reference <int, const int> &element) {
+                return key == element.key && element.value == -key;
+        })) return false;
+        if (std::distance(tree.begin(), tree.end()) != static_cast<std::ptrdiff_t>(reference.size())) return false;
+        return std::equal(reference.rbegin(), reference.rend(), tree.rbegin(), [](int key, const forest::b_tree_reference <int, const int> &element) {
+                return key == element.key;
+        });
+}
+
+/**
+ * @brief Applies random inserts and erases to a b+ tree and a std::set and compares them along the way
+ */
+template <std::size_t capacity>
+void random_bplus_operations(unsigned seed) {
+        forest::bplus_tree <int, int, std::less <int>, capacity> bplus_tree;
+        std::set <int> reference;
+        std::mt19937 random(seed);
+        for (int i = 0; i < 20000; i++) {
+                int key = static_cast<int>(random() % 2000);
+                switch (random() % 4) {
+                case 0:
+                        REQUIRE(bplus_tree.erase(key) == (reference.erase(key) == 1));
+                        break;
+                case 1:
+                        REQUIRE((bplus_tree.search(key) != nullptr) == (reference.count(key) == 1));
+                        break;
+                default:
+                        REQUIRE((bplus_tree.insert(key, -key) != nullptr) == reference.insert(key).second);
+                }
+                if (i % 500 == 0) {
+                        REQUIRE(same_leaf_keys(bplus_tree, reference));
+                        REQUIRE(bplus_tree.height() <= bplus_maximum_height(reference.size(), (capacity - 1) / 2));
+                }
+        }
+        REQUIRE(same_leaf_keys(bplus_tree, reference));
+        for (int key = -1; key <= 2001; key += 7) {
+                auto lower = bplus_tree.lower_bound(key);
+                auto upper = bplus_tree.upper_bound(key);
+                auto expected_lower = reference.lower_bound(key);
+                auto expected_upper = reference.upper_bound(key);
+                REQUIRE((lower == bplus_tree.end()) == (expected_lower == reference.end()));
+                REQUIRE((upper == bplus_tree.end()) == (expected_upper == reference.end()));
+                if (lower != bplus_tree.end()) REQUIRE(lower->key == *expected_lower);
+                if (upper != bplus_tree.end()) REQUIRE(upper->key == *expected_upper);
+                std::vector <int> keys;
+                bplus_tree.for_each_in_range(key, key + 50, [&keys](const forest::b_tree_reference <int, const int> &element) {
+                        keys.push_back(element.key);
+                });
+                REQUIRE(keys == std::vector <int> (expected_lower, reference.lower_bound(key + 50)));
+        }
+        while (!reference.empty()) {
+                REQUIRE(bplus_tree.erase(*reference.begin()));
+                reference.erase(reference.begin());
+        }
+        REQUIRE(bplus_tree.empty());
+        REQUIRE(bplus_tree.height() == 0);
+        REQUIRE(bplus_tree.begin() == bplus_tree.end());
+}
+
+SCENARIO("Test B+ Tree") {
+        GIVEN("A B+ Tree") {
+                forest::bplus_tree <int, int> bplus_tree;
+                WHEN("The B+ Tree is empty") {
+                        THEN("Test empty") {
+                                REQUIRE(bplus_tree.empty() == true);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(bplus_tree.size() == 0);
+                        }
+                        THEN("Test height") {
+                                REQUIRE(bplus_tree.height() == 0);
+                        }
+                        THEN("Test maximum") {
+                                auto max = bplus_tree.maximum();
+                                REQUIRE(max == nullptr);
+                        }
+                        THEN("Test minimum") {
+                                auto min = bplus_tree.minimum();
+                                REQUIRE(min == nullptr);
+                        }
+                        THEN("Test search for a key that does not exist") {
+                                auto result = bplus_tree.search(555);
+                                REQUIRE(result == nullptr);
+                        }
+                        THEN("Test iteration") {
+                                REQUIRE(bplus_tree.begin() == bplus_tree.end());
+                        }
+                }
+                WHEN("Keys are inserted in random order") {
+                        REQUIRE(bplus_tree.insert(4 , -10) != nullptr);
+                        REQUIRE(bplus_tree.insert(2 ,  30) != nullptr);
+                        REQUIRE(bplus_tree.insert(90, -74) != nullptr);
+                        REQUIRE(bplus_tree.insert(3 ,   1) != nullptr);
+                        REQUIRE(bplus_tree.insert(0 ,-110) != nullptr);
+                        REQUIRE(bplus_tree.insert(14,   0) != nullptr);
+                        REQUIRE(bplus_tree.insert(45,   0) != nullptr);
+                        THEN("Test empty") {
+                                REQUIRE(bplus_tree.empty() == false);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(bplus_tree.size() == 7);
+                        }
+                        THEN("Test size after inserting a key that already exists") {
+                                REQUIRE(bplus_tree.insert(3, 5) == nullptr);
+                                REQUIRE(bplus_tree.size() == 7);
+                                REQUIRE(bplus_tree.search(3)->value == 1);
+                        }
+                        THEN("Test height") {
+                                REQUIRE(bplus_tree.height() == 1);
+                        }
+                        THEN("Test maximum") {
+                                auto max = bplus_tree.maximum();
+                                REQUIRE(max != nullptr);
+                                REQUIRE(max->key == 90);
+                                REQUIRE(max->value == -74);
+                        }
+                        THEN("Test minimum") {
+                                auto min = bplus_tree.minimum();
+                                REQUIRE(min != nullptr);
+                                REQUIRE(min->key == 0);
+                                REQUIRE(min->value == -110);
+                        }
+                        THEN("Test search for a key that does exist") {
+                                auto result = bplus_tree.search(3);
+                                REQUIRE(result != nullptr);
+                                REQUIRE(result->key == 3);
+                                REQUIRE(result->value == 1);
+                                result->value = 2;
+                                REQUIRE(bplus_tree.search(3)->value == 2);
+                        }
+                }
+        }
+        GIVEN("A B+ Tree with 3 keys per node") {
+                forest::bplus_tree <int, int, std::less <int>, 3> bplus_tree;
+                WHEN("Keys are inserted in ascending order") {
+                        for (int i = 0; i < 10; i++) {
+                                REQUIRE(bplus_tree.insert(i, i*i) != nullptr);
+                        }
+                        THEN("Test size") {
+                                REQUIRE(bplus_tree.size() == 10);
+                        }
+                        THEN("Test height") {
+                                // Appending keeps every leaf full, so the 4 leaves fit under the root
+                                REQUIRE(bplus_tree.height() == 2);
+                        }
+                        THEN("Test maximum") {
+                                auto max = bplus_tree.maximum();
+                                REQUIRE(max != nullptr);
+                                REQUIRE(max->key == 9);
+                                REQUIRE(max->value == 81);
+                        }
+                        THEN("Test iteration in both directions") {
+                                int key = 0;
+                                for (auto it = bplus_tree.begin(); it != bplus_tree.end(); ++it) {
+                                        REQUIRE(it->key == key);
+                                        REQUIRE((*it).value == key * key);
+                                        key++;
+                                }
+                                REQUIRE(key == 10);
+                                for (auto it = bplus_tree.end(); it != bplus_tree.begin();) {
+                                        --it;
+                                        key--;
+                                        REQUIRE(it->key == key);
+                                }
+                                REQUIRE(key == 0);
+                        }
+                }
+                WHEN("Keys are inserted in descending order") {
+                        for (int i = 9; i >= 0; i--) {
+                                REQUIRE(bplus_tree.insert(i, i*i) != nullptr);
+                        }
+                        THEN("Test search for a key that does exist") {
+                                auto result = bplus_tree.search(3);
+                                REQUIRE(result != nullptr);
+                                REQUIRE(result->key == 3);
+                                REQUIRE(result->value == 9);
+                        }
+                        THEN("Test pop_min and pop_max") {
+                                REQUIRE(bplus_tree.pop_min());
+                                REQUIRE(bplus_tree.pop_max());
+                                REQUIRE(bplus_tree.minimum()->key == 1);
+                                REQUIRE(bplus_tree.maximum()->key == 8);
+                                while (bplus_tree.pop_max()) {
+
+                                }
+                                REQUIRE(bplus_tree.empty());
+                                REQUIRE(!bplus_tree.pop_min());
+                        }
+                }
+        }
+}
+
+SCENARIO("Test B+ Tree random inserts and erases") {
+        GIVEN("B+ Trees of different capacities") {
+                THEN("Every capacity matches a std::set and stays balanced") {
+                        random_bplus_operations <3> (1);
+                        random_bplus_operations <4> (2);
+                        random_bplus_operations <7> (3);
+                        random_bplus_operations <16> (4);
+                        random_bplus_operations <forest::b_tree_capacity <int>::value> (5);
+                }
+        }
+}
+
+SCENARIO("Test B+ Tree range queries") {
+        GIVEN("A B+ Tree with the even keys 0 to 198") {
+                forest::bplus_tree <int, int, std::less <int>, 5> bplus_tree;
+                for (int i = 0; i < 100; i++) {
+                        bplus_tree.insert(i * 2, i);
+                }
+                THEN("Test equal_range") {
+                        auto range = bplus_tree.equal_range(10);
+                        REQUIRE(range.first->key == 10);
+                        REQUIRE(range.second->key == 12);
+                        range = bplus_tree.equal_range(11);
+                        REQUIRE(range.first == range.second);
+                }
+                THEN("Test for_each_in_range across leaves") {
+                        std::vector <int> keys;
+                        bplus_tree.for_each_in_range(15, 31, [&keys](const forest::b_tree_reference <int, const int> &element) {
+                                keys.push_back(element.key);
+                        });
+                        REQUIRE(keys == std::vector <int> ({16, 18, 20, 22, 24, 26, 28, 30}));
+                        keys.clear();
+                        bplus_tree.for_each_in_range(190, 1000, [&keys](const forest::b_tree_reference <int, const int> &element) {
+                                keys.push_back(element.key);
+                        });
+                        REQUIRE(keys == std::vector <int> ({190, 192, 194, 196, 198}));
+                        keys.clear();
+                        bplus_tree.for_each_in_range(1000, 2000, [&keys](const forest::b_tree_reference <int, const int> &element) {
+                                keys.push_back(element.key);
+                        });
+                        REQUIRE(keys.empty());
+                }
+                THEN("Test for_each visits every element in key order") {
+                        int key = 0;
+                        bplus_tree.for_each([&key](const forest::b_tree_reference <int, const int> &element) {
+                                REQUIRE(element.key == key);
+                                key += 2;
+                        });
+                        REQUIRE(key == 200);
+                }
+        }
+}
+
+SCENARIO("Test B+ Tree value construction") {
+        GIVEN("A B+ Tree of counted values") {
+                long long alive = counted::alive();
+                {
+                        forest::bplus_tree <int, counted, std::less <int>, 3> bplus_tree;
+                        for (int i = 0; i < 100; i++) {
+                                bplus_tree.insert(i, counted(i));
+                        }
+                        REQUIRE(counted::alive() == alive + 100);
+                        THEN("Test inserting a duplicate key leaves the value untouched") {
+                                counted value(50);
+                                counted::reset();
+                                REQUIRE(bplus_tree.insert(5, std::move(value)) == nullptr);
+                                REQUIRE(counted::copies() == 0);
+                                REQUIRE(counted::moves() == 0);
+                                REQUIRE(value.value == 50);
+                                REQUIRE(bplus_tree.search(5)->value.value == 5);
+                        }
+                        THEN("Test erasing destroys exactly the erased values") {
+                                for (int i = 0; i < 100; i += 2) {
+                                        REQUIRE(bplus_tree.erase(i));
+                                }
+                                REQUIRE(counted::alive() == alive + 50);
+                                int key = 1;
+                                for (const auto &element : bplus_tree) {
+                                        REQUIRE(element.value.value == key);
+                                        key += 2;
+                                }
+                        }
+                }
+                THEN("Test every value is destroyed with the B+ Tree") {
+                        REQUIRE(counted::alive() == alive);
+                }
+        }
+        GIVEN("A B+ Tree of move only values") {
+                forest::bplus_tree <std::string, std::unique_ptr <int>, std::less <std::string>, 3> bplus_tree;
+                THEN("Test insert, try_emplace, emplace and erase") {
+                        std::string key = "b";
+                        REQUIRE(bplus_tree.insert(std::move(key), std::unique_ptr <int> (new int(2))) != nullptr);
+                        REQUIRE(bplus_tree.try_emplace("a", new int(1)).second);
+                        REQUIRE(bplus_tree.emplace("c", new int(3)).second);
+                        REQUIRE(!bplus_tree.emplace("c", nullptr).second);
+                        REQUIRE(bplus_tree.try_emplace("d", new int(4)).second);
+                        REQUIRE(bplus_tree.erase("b"));
+                        REQUIRE(bplus_tree.size() == 3);
+                        std::vector <int> values;
+                        for (const auto &element : bplus_tree) {
+                                values.push_back(*element.value);
+                        }
+                        REQUIRE(values == std::vector <int> ({1, 3, 4}));
+                }
+        }
+}
+
+SCENARIO("Test B+ Tree upserts") {
+        GIVEN("A B+ Tree of word counts") {
+                forest::bplus_tree <std::string, int, string_less, 3> bplus_tree;
+                std::vector <std::string> words = {"b", "a", "c", "a", "d", "b", "a", "e", "f", "g"};
+                for (const std::string &word : words) {
+                        bplus_tree.upsert(word, [](int &count) {
+                                count++;
+                        });
+                }
+                THEN("Test the counts and a transparent search") {
+                        REQUIRE(bplus_tree.size() == 7);
+                        REQUIRE(bplus_tree.search("a")->value == 3);
+                        REQUIRE(bplus_tree.search("b")->value == 2);
+                        REQUIRE(bplus_tree.search("z") == nullptr);
+                        REQUIRE(bplus_tree.lower_bound("bb")->key == "c");
+                }
+                THEN("Test insert_or_assign") {
+                        REQUIRE(!bplus_tree.insert_or_assign("a", 10).second);
+                        REQUIRE(bplus_tree.insert_or_assign("h", 20).second);
+                        REQUIRE(bplus_tree.search("a")->value == 10);
+                        REQUIRE(bplus_tree.search("h")->value == 20);
+                }
+        }
+}
@@ -0,0 +1,121 @@
+#include "catch.hpp"
+#include <forest/b_tree.h>
+#include <forest/bplus_tree.h>
+#include <forest/cache_oblivious_search_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include "string_less.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks every key of a cache oblivious search tree built from the odd keys 1 to 2n - 1, and the gaps between them
+ */
+bool same_cache_oblivious_keys(const forest::cache_oblivious_search_tree <int, int> &tree, int n) {
+        if (tree.size() != static_cast<unsigned long long>(n)) return false;
+        for (int key = 0; key <= 2 * n; key++) {
+                auto element = tree.search(key);
+                auto lower = tree.lower_bound(key);
+                if (key % 2 == 1) {
+                        if (element == nullptr || element->key != key || element->value != -key) return false;
+                        if (lower == tree.end() || lower->key != key) return false;
+                } else {
+                        if (element != nullptr) return false;
+                        if (key == 2 * n ? lower != tree.end() : lower == tree.end() || lower->key != key + 1) return false;
+                }
+        }
+        int key = 1;
+        for (const auto &element : tree) {
+                if (element.key != key) return false;
+                key += 2;
+        }
+        return key == 2 * n + 1;
+}
+
+SCENARIO("Test Cache Oblivious Search Tree") {
+        GIVEN("An empty Cache Oblivious Search Tree") {
+                forest::cache_oblivious_search_tree <int, int> tree;
+                THEN("Test empty") {
+                        REQUIRE(tree.empty() == true);
+                        REQUIRE(tree.size() == 0);
+                        REQUIRE(tree.height() == 0);
+                        REQUIRE(tree.search(1) == nullptr);
+                        REQUIRE(tree.lower_bound(1) == tree.end());
+                        REQUIRE(tree.begin() == tree.end());
+                }
+        }
+        GIVEN("Red Black Trees of every size up to 300") {
+                THEN("Test every key and gap of the van Emde Boas layout") {
+                        for (int n = 0; n <= 300; n++) {
+                                forest::red_black_tree <int, int> red_black_tree;
+                                for (int i = 0; i < n; i++) {
+                                        red_black_tree.insert(2 * i + 1, -(2 * i + 1));
+                                }
+                                auto tree = forest::cache_oblivious_search_tree <int, int>::from_tree(red_black_tree);
+                                REQUIRE(same_cache_oblivious_keys(tree, n));
+                        }
+                }
+        }
+        GIVEN("Other kinds of trees with the same keys") {
+                forest::splay_tree <int, int> splay_tree;
+                forest::b_tree <int, int, std::less <int>, 5> b_tree;
+                forest::bplus_tree <int, int, std::less <int>, 5> bplus_tree;
+                for (int i = 0; i < 1000; i++) {
+                        int key = 2 * ((i * 7919) % 1000) + 1;
+                        splay_tree.insert(key, -key);
+                        b_tree.insert(key, -key);
+                        bplus_tree.insert(key, -key);
+                }
+                THEN("Test building from every tree") {
+                        REQUIRE(same_cache_oblivious_keys(forest::cache_oblivious_search_tree <int, int>::from_tree(splay_tree), 1000));
+                        REQUIRE(same_cache_oblivious_keys(forest::cache_oblivious_search_tree <int, int>::from_tree(b_tree), 1000));
+                        REQUIRE(same_cache_oblivious_keys(forest::cache_oblivious_search_tree <int, int>::from_tree(bplus_tree), 1000));
+                        auto tree = forest::cache_oblivious_search_tree <int, int>::from_tree(b_tree);
+                        REQUIRE(tree.height() == 10);
+                }
+        }
+        GIVEN("A Red Black Tree of strings with a transparent comparator") {
+                forest::red_black_tree <std::string, int, string_less> red_black_tree;
+                std::vector <std::string> words = {"pear", "apple", "fig", "plum", "kiwi"};
+                for (const std::string &word : words) {
+                        red_black_tree.insert(word, static_cast<int>(word.size()));
+                }
+                auto tree = forest::cache_oblivious_search_tree <std::string, int, string_less>::from_tree(red_black_tree);
+                THEN("Test search by string literal and reverse iteration") {
+                        REQUIRE(tree.search("apple")->value == 5);
+                        REQUIRE(tree.search("grape") == nullptr);
+                        REQUIRE(tree.lower_bound("grape")->key == "kiwi");
+                        REQUIRE(tree.lower_bound("zebra") == tree.end());
+                        std::vector <std::string> keys;
+                        for (auto it = tree.rbegin(); it != tree.rend(); ++it) {
+                                keys.push_back(it->key);
+                        }
+                        REQUIRE(keys == std::vector <std::string> ({"plum", "pear", "kiwi", "fig", "apple"}));
+                }
+        }
+}
+
+SCENARIO("Test Cache Oblivious Search Tree batched search") {
+        GIVEN("Red Black Trees of every size up to 100") {
+                THEN("Batches of every size up to 40 find what search finds") {
+                        for (int n = 0; n <= 100; n++) {
+                                forest::red_black_tree <int, int> red_black_tree;
+                                for (int i = 0; i < n; i++) {
+                                        red_black_tree.insert(2 * i + 1, -(2 * i + 1));
+                                }
+                                auto tree = forest::cache_oblivious_search_tree <int, int>::from_tree(red_black_tree);
+                                for (std::size_t m = 0; m <= 40; m++) {
+                                        std::vector <int> keys;
+                                        for (std::size_t i = 0; i < m; i++) {
+                                                keys.push_back(static_cast<int>((i * 37 + m) % (2 * n + 3)) - 1);
+                                        }
+                                        std::vector <const forest::cache_oblivious_search_tree_element <int, int> *> found(m);
+                                        tree.search_batch(keys.data(), m, found.data());
+                                        for (std::size_t i = 0; i < m; i++) {
+                                                REQUIRE(found[i] == tree.search(keys[i]));
+                                        }
+                                }
+                        }
+                }
+        }
+}
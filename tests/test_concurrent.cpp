@@ -0,0 +1,149 @@
+#include "catch.hpp"
+#include <forest/b_tree.h>
+#include <forest/binary_search_tree.h>
+#include <forest/concurrent.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+static_assert(std::is_same <decltype(std::declval <const forest::red_black_tree <int, int> &> ().search(0)), const forest::red_black_tree_node <int, int> *>::value, "red black trees are searched through a const reference");
+static_assert(std::is_same <decltype(std::declval <const forest::splay_tree <int, int> &> ().search(0)), const forest::splay_tree_node <int, int> *>::value, "splay trees are searched through a const reference, their searches do not splay");
+
+/**
+ * @brief Checks that a node, or element, found for a key holds the value written with it
+ */
+struct check_value {
+        int key;
+        std::atomic <bool> *ok;
+        template <typename node_t>
+        void operator()(const node_t &x) const {
+                if (x.key != key || x.value != -key) *ok = false;
+        }
+};
+
+/**
+ * @brief Checks that the nodes, or elements, visited in order are the ones left by survives_threads
+ */
+struct check_order {
+        int *expected;
+        std::atomic <bool> *ok;
+        template <typename node_t>
+        void operator()(const node_t &x) const {
+                if (x.key != *expected || x.value != -*expected) *ok = false;
+                *expected += *expected % 4 == 1 ? 3 : 1;
+        }
+};
+
+/**
+ * @brief Inserts and erases keys from some threads while others search, then checks the keys left
+ */
+template <typename concurrent_t>
+bool survives_threads(concurrent_t &tree) {
+        const int writers = 2;
+        const int readers = 4;
+        const int keys = 2000;
+        std::atomic <bool> ok(true);
+        std::vector <std::thread> threads;
+        for (int w = 0; w < writers; w++) {
+                threads.emplace_back([&tree, &ok, w]() {
+                        // Writer w owns the keys equal to w modulo writers, and erases those equal to 2 and 3 modulo 4 again
+                        for (int key = w; key < keys; key += writers) {
+                                if (!tree.insert(key, -key)) ok = false;
+                        }
+                        for (int key = w; key < keys; key += writers) {
+                                if (key % 4 >= 2 && !tree.erase(key)) ok = false;
+                        }
+                });
+        }
+        for (int r = 0; r < readers; r++) {
+                threads.emplace_back([&tree, &ok, r]() {
+                        for (int i = 0; i < 5000; i++) {
+                                int key = (i * 7 + r) % keys;
+                                tree.search(key, check_value {key, &ok});
+                        }
+                });
+        }
+        for (std::thread &thread : threads) {
+                thread.join();
+        }
+        if (!ok || tree.size() != keys / 2) return false;
+        int expected = 0;
+        tree.for_each(check_order {&expected, &ok});
+        return ok && expected == keys;
+}
+
+SCENARIO("Test concurrent trees") {
+        GIVEN("A concurrent Red Black Tree") {
+                forest::concurrent <forest::red_black_tree <int, int> > tree;
+                for (int i = 0; i < 10; i++) {
+                        tree.insert(i, i * i);
+                }
+                THEN("Test reads and writes") {
+                        int value = 0;
+                        REQUIRE(tree.search(3, [&value](const forest::red_black_tree_node <int, int> &x) { value = x.value; }));
+                        REQUIRE(value == 9);
+                        REQUIRE(tree.contains(9) == true);
+                        REQUIRE(tree.contains(10) == false);
+                        REQUIRE(tree.insert(3, 0) == false);
+                        REQUIRE(tree.erase(3) == true);
+                        REQUIRE(tree.erase(3) == false);
+                        REQUIRE(tree.size() == 9);
+                        int minimum = -1;
+                        int maximum = -1;
+                        REQUIRE(tree.minimum([&minimum](const forest::red_black_tree_node <int, int> &x) { minimum = x.key; }));
+                        REQUIRE(tree.maximum([&maximum](const forest::red_black_tree_node <int, int> &x) { maximum = x.key; }));
+                        REQUIRE(minimum == 0);
+                        REQUIRE(maximum == 9);
+                        std::vector <int> keys;
+                        tree.for_each_in_range(2, 5, [&keys](const forest::red_black_tree_node <int, int> &x) { keys.push_back(x.key); });
+                        REQUIRE(keys == std::vector <int> ({2, 4}));
+                        REQUIRE(tree.read([](const forest::red_black_tree <int, int> &x) { return x.search(4)->value; }) == 16);
+                        tree.write([](forest::red_black_tree <int, int> &x) { x.search(4)->value = 0; });
+                        REQUIRE(tree.read([](const forest::red_black_tree <int, int> &x) { return x.search(4)->value; }) == 0);
+                        tree.clear();
+                        REQUIRE(tree.empty() == true);
+                        REQUIRE(tree.minimum([](const forest::red_black_tree_node <int, int> &) {}) == false);
+                }
+        }
+        GIVEN("Concurrent trees of other kinds") {
+                forest::concurrent <forest::splay_tree <int, int> > splay_tree;
+                forest::concurrent <forest::binary_search_tree <int, int> > binary_search_tree;
+                forest::concurrent <forest::b_tree <int, int, std::less <int>, 5> > b_tree;
+                THEN("Inserting a key that exists fails and keeps the old value") {
+                        REQUIRE(splay_tree.insert(3, 9) == true);
+                        REQUIRE(splay_tree.insert(3, 0) == false);
+                        REQUIRE(binary_search_tree.insert(3, 9) == true);
+                        REQUIRE(binary_search_tree.insert(3, 0) == false);
+                        REQUIRE(b_tree.insert(3, 9) == true);
+                        REQUIRE(b_tree.insert(3, 0) == false);
+                        int value = 0;
+                        REQUIRE(splay_tree.search(3, [&value](const forest::splay_tree_node <int, int> &x) { value = x.value; }));
+                        REQUIRE(value == 9);
+                        REQUIRE(binary_search_tree.search(3, [&value](const forest::binary_search_tree_node <int, int> &x) { value = -x.value; }));
+                        REQUIRE(value == -9);
+                        REQUIRE(splay_tree.size() == 1);
+                        REQUIRE(binary_search_tree.size() == 1);
+                        REQUIRE(b_tree.size() == 1);
+                }
+        }
+        GIVEN("Concurrent trees of every kind written and read by several threads") {
+                forest::concurrent <forest::red_black_tree <int, int> > red_black_tree;
+                forest::concurrent <forest::splay_tree <int, int> > splay_tree;
+                forest::concurrent <forest::b_tree <int, int, std::less <int>, 5> > b_tree;
+                THEN("Every write is seen and every read is consistent") {
+                        REQUIRE(survives_threads(red_black_tree));
+                        REQUIRE(survives_threads(splay_tree));
+                        REQUIRE(survives_threads(b_tree));
+                }
+        }
+        GIVEN("A concurrent Red Black Tree with the C++11 reader writer lock") {
+                forest::concurrent <forest::red_black_tree <int, int>, forest::reader_writer_mutex> tree;
+                THEN("Every write is seen and every read is consistent") {
+                        REQUIRE(survives_threads(tree));
+                }
+        }
+}
@@ -1,5 +1,67 @@
 #include "catch.hpp"
+#include <forest/pool_allocator.h>
 #include <forest/red_black_tree.h>
+#include "assignable.h"
+#include "counted.h"
+#include "string_less.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(!element_assignable <forest::red_black_tree <int, int>::iterator>::value, "whole nodes must not be assigned or swapped through an iterator, their links would go with them");
+static_assert(!key_assignable <forest::red_black_tree <int, int>::iterator>::value, "keys must not be changed through an iterator");
+static_assert(value_assignable <forest::red_black_tree <int, int>::iterator>::value, "values may be changed through an iterator");
+static_assert(!links_assignable <decltype(std::declval <forest::red_black_tree <int, int> &> ().search(0))>::value, "a node returned by search must not be relinked");
+static_assert(!links_assignable <forest::red_black_tree <int, int>::iterator>::value, "nodes must not be relinked through an iterator");
+
+/**
+ * @brief Checks the red black and binary search tree properties of the subtree rooted at x
+ * @return The black height of the subtree or -1 if a property is violated
+ */
+template <typename node_t>
+int black_height(const node_t *x) {
+        if (x == nullptr) return 1;
+        if (x->get_left() != nullptr && (x->get_left()->get_parent() != x || !(x->get_left()->key < x->key))) return -1;
+        if (x->get_right() != nullptr && (x->get_right()->get_parent() != x || !(x->key < x->get_right()->key))) return -1;
+        if (x->get_color() == forest::red) {
+                if (x->get_left() != nullptr && x->get_left()->get_color() == forest::red) return -1;
+                if (x->get_right() != nullptr && x->get_right()->get_color() == forest::red) return -1;
+        }
+        int left = black_height <node_t> (x->get_left());
+        int right = black_height <node_t> (x->get_right());
+        if (left == -1 || right == -1 || left != right) return -1;
+        return left + (x->get_color() == forest::black ? 1 : 0);
+}
+
+/**
+ * @brief Checks the subtree sizes stored in the subtree rooted at x
+ * @return The size of the subtree or -1 if a stored size is wrong
+ */
+template <typename node_t>
+long long subtree_size(const node_t *x) {
+        if (x == nullptr) return 0;
+        long long left = subtree_size <node_t> (x->get_left());
+        long long right = subtree_size <node_t> (x->get_right());
+        if (left == -1 || right == -1 || static_cast<long long>(x->get_count()) != left + right + 1) return -1;
+        return left + right + 1;
+}
+
+/**
+ * @brief Checks that the red black tree containing x is valid
+ */
+template <typename node_t>
+bool valid(const node_t *x) {
+        if (x == nullptr) return true;
+        while (x->get_parent() != nullptr) x = x->get_parent();
+        return x->get_color() == forest::black && black_height(x) != -1;
+}
 
 SCENARIO("Test Red Black Tree") {
         GIVEN("A Red Black Tree") {
@@ -41,6 +103,10 @@ SCENARIO("Test Red Black Tree") {
                         THEN("Test size") {
                                 REQUIRE(red_black_tree.size() == 7);
                         }
+                        THEN("Test size after inserting a key that already exists") {
+                                red_black_tree.insert(3, 5);
+                                REQUIRE(red_black_tree.size() == 7);
+                        }
                         THEN("Test height") {
                                 REQUIRE(red_black_tree.height() == 3);
                         }
@@ -141,3 +207,965 @@ SCENARIO("Test Red Black Tree") {
                 }
         }
 }
+
+SCENARIO("Test Red Black Tree destruction") {
+        GIVEN("A Red Black Tree of counted values") {
+                long long alive = counted::alive();
+                WHEN("The Red Black Tree goes out of scope") {
+                        {
+                                forest::red_black_tree <int, counted> red_black_tree;
+                                for (int i = 0; i < 1000; i++) {
+                                        red_black_tree.insert((i * 7919) % 1000, counted(i));
+                                }
+                                REQUIRE(counted::alive() == alive + 1000);
+                        }
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                        }
+                }
+                WHEN("Nodes are inserted in ascending order and the Red Black Tree goes out of scope") {
+                        {
+                                forest::red_black_tree <int, counted> red_black_tree;
+                                for (int i = 0; i < 10000; i++) {
+                                        red_black_tree.insert(i, counted(i));
+                                }
+                        }
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                        }
+                }
+                WHEN("The Red Black Tree is cleared") {
+                        forest::red_black_tree <int, counted> red_black_tree;
+                        for (int i = 0; i < 1000; i++) {
+                                red_black_tree.insert(i, counted(i));
+                        }
+                        red_black_tree.clear();
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                                REQUIRE(red_black_tree.empty() == true);
+                                REQUIRE(red_black_tree.size() == 0);
+                                REQUIRE(red_black_tree.search(10) == nullptr);
+                        }
+                        THEN("The Red Black Tree can be reused") {
+                                REQUIRE(red_black_tree.insert(10, counted(10)) != nullptr);
+                                REQUIRE(red_black_tree.size() == 1);
+                                REQUIRE(red_black_tree.search(10) != nullptr);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree erase") {
+        GIVEN("A Red Black Tree") {
+                forest::red_black_tree <int, int> red_black_tree;
+                for (int i = 0; i < 10; i++) {
+                        red_black_tree.insert(i, i*i);
+                }
+                WHEN("A key that does not exist is erased") {
+                        THEN("Nothing is removed") {
+                                REQUIRE(red_black_tree.erase(1337) == false);
+                                REQUIRE(red_black_tree.size() == 10);
+                        }
+                }
+                WHEN("A key that does exist is erased") {
+                        REQUIRE(red_black_tree.erase(3) == true);
+                        THEN("The node is removed") {
+                                REQUIRE(red_black_tree.size() == 9);
+                                REQUIRE(red_black_tree.search(3) == nullptr);
+                                REQUIRE(red_black_tree.search(4) != nullptr);
+                                REQUIRE(red_black_tree.search(4)->value == 16);
+                                REQUIRE(valid(red_black_tree.minimum()));
+                        }
+                }
+                WHEN("A node returned by search is erased") {
+                        red_black_tree.erase(red_black_tree.search(0));
+                        THEN("The node is removed") {
+                                REQUIRE(red_black_tree.size() == 9);
+                                REQUIRE(red_black_tree.minimum()->key == 1);
+                                REQUIRE(valid(red_black_tree.minimum()));
+                        }
+                }
+                WHEN("Every key is erased") {
+                        for (int i = 0; i < 10; i++) {
+                                REQUIRE(red_black_tree.erase(i) == true);
+                                REQUIRE(valid(red_black_tree.minimum()));
+                        }
+                        THEN("The Red Black Tree is empty") {
+                                REQUIRE(red_black_tree.empty() == true);
+                                REQUIRE(red_black_tree.size() == 0);
+                                REQUIRE(red_black_tree.minimum() == nullptr);
+                        }
+                }
+        }
+        GIVEN("A Red Black Tree under random inserts and erases") {
+                forest::red_black_tree <int, counted> red_black_tree;
+                std::set <int> reference;
+                std::mt19937 random(1234);
+                long long alive = counted::alive();
+                bool ok = true;
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 512);
+                        if (random() % 2 == 0) {
+                                red_black_tree.insert(key, counted(key));
+                                reference.insert(key);
+                        } else {
+                                ok = ok && red_black_tree.erase(key) == (reference.erase(key) == 1);
+                        }
+                        if (i % 64 == 0) ok = ok && valid(red_black_tree.minimum());
+                }
+                THEN("The red black properties and the contents are preserved") {
+                        REQUIRE(ok);
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(red_black_tree.size() == reference.size());
+                        REQUIRE(counted::alive() == alive + static_cast<long long>(reference.size()));
+                        for (int key = 0; key < 512; key++) {
+                                REQUIRE((red_black_tree.search(key) != nullptr) == (reference.count(key) == 1));
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree iterators") {
+        GIVEN("A Red Black Tree") {
+                forest::red_black_tree <int, int> red_black_tree;
+                WHEN("The Red Black Tree is empty") {
+                        THEN("begin is equal to end") {
+                                REQUIRE(red_black_tree.begin() == red_black_tree.end());
+                                REQUIRE(red_black_tree.rbegin() == red_black_tree.rend());
+                                REQUIRE(red_black_tree.cbegin() == red_black_tree.cend());
+                        }
+                }
+                WHEN("Nodes are inserted in random order") {
+                        for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                                red_black_tree.insert(key, key * 10);
+                        }
+                        THEN("Test in order iteration") {
+                                std::vector <int> keys;
+                                for (auto &node : red_black_tree) {
+                                        keys.push_back(node.key);
+                                        REQUIRE(node.value == node.key * 10);
+                                }
+                                REQUIRE(keys == std::vector <int>({0, 2, 3, 4, 14, 45, 90}));
+                        }
+                        THEN("Test reverse iteration") {
+                                std::vector <int> keys;
+                                for (auto it = red_black_tree.rbegin(); it != red_black_tree.rend(); ++it) {
+                                        keys.push_back(it->key);
+                                }
+                                REQUIRE(keys == std::vector <int>({90, 45, 14, 4, 3, 2, 0}));
+                        }
+                        THEN("Test decrementing end") {
+                                auto it = red_black_tree.end();
+                                --it;
+                                REQUIRE(it->key == 90);
+                                it--;
+                                REQUIRE(it->key == 45);
+                        }
+                        THEN("Test algorithms") {
+                                REQUIRE(std::distance(red_black_tree.begin(), red_black_tree.end()) == 7);
+                                auto it = std::find_if(red_black_tree.begin(), red_black_tree.end(), [](const forest::red_black_tree_node <int, int> &node) {
+                                        return node.key > 10;
+                                });
+                                REQUIRE(it != red_black_tree.end());
+                                REQUIRE(it->key == 14);
+                        }
+                        THEN("Test constant iteration") {
+                                const forest::red_black_tree <int, int> &tree = red_black_tree;
+                                forest::red_black_tree <int, int>::const_iterator it = red_black_tree.begin();
+                                REQUIRE(it == tree.begin());
+                                int sum = 0;
+                                for (const auto &node : tree) {
+                                        sum += node.key;
+                                }
+                                REQUIRE(sum == 158);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree range queries") {
+        GIVEN("A Red Black Tree with the even keys from 0 to 98") {
+                forest::red_black_tree <int, int> red_black_tree;
+                for (int i = 0; i < 50; i++) {
+                        red_black_tree.insert((i * 17) % 50 * 2, i);
+                }
+                THEN("Test lower_bound") {
+                        REQUIRE(red_black_tree.lower_bound(-5)->key == 0);
+                        REQUIRE(red_black_tree.lower_bound(10)->key == 10);
+                        REQUIRE(red_black_tree.lower_bound(11)->key == 12);
+                        REQUIRE(red_black_tree.lower_bound(98)->key == 98);
+                        REQUIRE(red_black_tree.lower_bound(99) == red_black_tree.end());
+                }
+                THEN("Test upper_bound") {
+                        REQUIRE(red_black_tree.upper_bound(-5)->key == 0);
+                        REQUIRE(red_black_tree.upper_bound(10)->key == 12);
+                        REQUIRE(red_black_tree.upper_bound(11)->key == 12);
+                        REQUIRE(red_black_tree.upper_bound(98) == red_black_tree.end());
+                }
+                THEN("Test equal_range") {
+                        auto found = red_black_tree.equal_range(20);
+                        REQUIRE(std::distance(found.first, found.second) == 1);
+                        REQUIRE(found.first->key == 20);
+                        auto missing = red_black_tree.equal_range(21);
+                        REQUIRE(missing.first == missing.second);
+                        REQUIRE(missing.first->key == 22);
+                }
+                THEN("Test for_each_in_range") {
+                        std::vector <int> keys;
+                        red_black_tree.for_each_in_range(15, 25, [&keys](const forest::red_black_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys == std::vector <int>({16, 18, 20, 22, 24}));
+                        keys.clear();
+                        red_black_tree.for_each_in_range(90, 1000, [&keys](const forest::red_black_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys == std::vector <int>({90, 92, 94, 96, 98}));
+                        keys.clear();
+                        red_black_tree.for_each_in_range(31, 32, [&keys](const forest::red_black_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys.empty());
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree order statistics") {
+        typedef forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, true> order_statistic_tree;
+        GIVEN("A Red Black Tree with order statistics") {
+                order_statistic_tree red_black_tree;
+                WHEN("The Red Black Tree is empty") {
+                        THEN("Test select and rank") {
+                                REQUIRE(red_black_tree.select(0) == nullptr);
+                                REQUIRE(red_black_tree.rank(10) == 0);
+                        }
+                }
+                WHEN("Nodes are inserted in random order") {
+                        for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                                red_black_tree.insert(key, -key);
+                        }
+                        THEN("Test select") {
+                                REQUIRE(red_black_tree.select(0)->key == 0);
+                                REQUIRE(red_black_tree.select(3)->key == 4);
+                                REQUIRE(red_black_tree.select(3)->value == -4);
+                                REQUIRE(red_black_tree.select(6)->key == 90);
+                                REQUIRE(red_black_tree.select(7) == nullptr);
+                        }
+                        THEN("Test rank") {
+                                REQUIRE(red_black_tree.rank(-1) == 0);
+                                REQUIRE(red_black_tree.rank(0) == 0);
+                                REQUIRE(red_black_tree.rank(4) == 3);
+                                REQUIRE(red_black_tree.rank(5) == 4);
+                                REQUIRE(red_black_tree.rank(1000) == 7);
+                        }
+                }
+        }
+        GIVEN("A Red Black Tree with order statistics under random inserts and erases") {
+                order_statistic_tree red_black_tree;
+                std::set <int> reference;
+                std::mt19937 random(99);
+                bool ok = true;
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 512);
+                        if (random() % 3 != 0) {
+                                red_black_tree.insert(key, key);
+                                reference.insert(key);
+                        } else {
+                                red_black_tree.erase(key);
+                                reference.erase(key);
+                        }
+                        if (i % 64 == 0) {
+                                const forest::red_black_tree_node <int, int, true> *root = red_black_tree.minimum();
+                                while (root != nullptr && root->get_parent() != nullptr) root = root->get_parent();
+                                ok = ok && valid(root) && subtree_size(root) == static_cast<long long>(reference.size());
+                        }
+                }
+                WHEN("It is bulk loaded") {
+                        std::vector <std::pair <int, int> > pairs;
+                        for (int key : reference) {
+                                pairs.push_back(std::make_pair(key, key));
+                        }
+                        red_black_tree.assign_sorted(pairs.begin(), pairs.end());
+                        THEN("The subtree sizes are correct") {
+                                const forest::red_black_tree_node <int, int, true> *root = red_black_tree.minimum();
+                                while (root->get_parent() != nullptr) root = root->get_parent();
+                                REQUIRE(valid(root));
+                                REQUIRE(subtree_size(root) == static_cast<long long>(reference.size()));
+                                REQUIRE(red_black_tree.rank(pairs[10].first) == 10);
+                        }
+                }
+                THEN("select and rank agree with the sorted keys") {
+                        REQUIRE(ok);
+                        std::vector <int> keys(reference.begin(), reference.end());
+                        for (unsigned long long k = 0; k < keys.size(); k++) {
+                                REQUIRE(red_black_tree.select(k)->key == keys[k]);
+                                REQUIRE(red_black_tree.rank(keys[k]) == k);
+                        }
+                        REQUIRE(red_black_tree.select(keys.size()) == nullptr);
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree bulk loading") {
+        GIVEN("Sorted ranges of every size up to 100") {
+                THEN("from_sorted creates a perfectly balanced Red Black Tree containing the range") {
+                        for (int n = 0; n <= 100; n++) {
+                                std::vector <std::pair <int, int> > pairs;
+                                for (int i = 0; i < n; i++) {
+                                        pairs.push_back(std::make_pair(i * 3, -i));
+                                }
+                                auto red_black_tree = forest::red_black_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+                                unsigned long long height = 0;
+                                while ((1ULL << height) - 1 < static_cast<unsigned long long>(n)) height++;
+                                REQUIRE(red_black_tree.size() == static_cast<unsigned long long>(n));
+                                REQUIRE(red_black_tree.height() == height);
+                                REQUIRE(valid(red_black_tree.minimum()));
+                                std::vector <std::pair <int, int> > contents;
+                                for (const auto &node : red_black_tree) {
+                                        contents.push_back(std::make_pair(node.key, node.value));
+                                }
+                                REQUIRE(contents == pairs);
+                        }
+                }
+        }
+        GIVEN("A Red Black Tree with nodes") {
+                forest::red_black_tree <int, int> red_black_tree;
+                for (int i = 0; i < 10; i++) {
+                        red_black_tree.insert(i, i);
+                }
+                WHEN("A sorted range is assigned") {
+                        std::vector <std::pair <int, int> > pairs;
+                        for (int i = 100; i < 200; i += 2) {
+                                pairs.push_back(std::make_pair(i, i));
+                        }
+                        red_black_tree.assign_sorted(pairs.begin(), pairs.end());
+                        THEN("The old nodes are replaced") {
+                                REQUIRE(red_black_tree.size() == 50);
+                                REQUIRE(red_black_tree.search(5) == nullptr);
+                                REQUIRE(red_black_tree.minimum()->key == 100);
+                                REQUIRE(red_black_tree.maximum()->key == 198);
+                        }
+                        THEN("The Red Black Tree can still be modified") {
+                                REQUIRE(red_black_tree.insert(101, 0) != nullptr);
+                                REQUIRE(red_black_tree.erase(100) == true);
+                                REQUIRE(red_black_tree.size() == 50);
+                                REQUIRE(red_black_tree.minimum()->key == 101);
+                                REQUIRE(valid(red_black_tree.minimum()));
+                        }
+                }
+        }
+        GIVEN("A Red Black Tree of counted values and a sorted range whose values throw when copied") {
+                forest::red_black_tree <int, counted> red_black_tree;
+                for (int i = 0; i < 10; i++) {
+                        red_black_tree.insert(i, counted(i));
+                }
+                std::vector <std::pair <int, counted> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i, counted(i)));
+                }
+                long long alive = counted::alive() - 10;
+                THEN("Every node built before the throw is freed and the Red Black Tree is left empty") {
+                        bool ok = true;
+                        for (long long limit = 0; limit < 100; limit++) {
+                                counted::reset();
+                                counted::copy_limit() = limit;
+                                bool thrown = false;
+                                try {
+                                        red_black_tree.assign_sorted(pairs.begin(), pairs.end());
+                                } catch (const std::runtime_error &) {
+                                        thrown = true;
+                                }
+                                ok = ok && thrown && counted::alive() == alive && red_black_tree.empty() && red_black_tree.size() == 0;
+                                ok = ok && red_black_tree.minimum() == nullptr && red_black_tree.begin() == red_black_tree.end();
+                        }
+                        counted::reset();
+                        REQUIRE(ok);
+                }
+                THEN("The Red Black Tree can be bulk loaded again") {
+                        counted::reset();
+                        counted::copy_limit() = 50;
+                        REQUIRE_THROWS_AS(red_black_tree.assign_sorted(pairs.begin(), pairs.end()), std::runtime_error);
+                        counted::reset();
+                        red_black_tree.assign_sorted(pairs.begin(), pairs.end());
+                        REQUIRE(red_black_tree.size() == 100);
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(counted::alive() == alive + 100);
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree comparators") {
+        GIVEN("A Red Black Tree ordered by std::greater") {
+                forest::red_black_tree <int, int, std::greater <int> > red_black_tree;
+                for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                        red_black_tree.insert(key, key);
+                }
+                THEN("The keys are in descending order") {
+                        std::vector <int> keys;
+                        for (const auto &node : red_black_tree) {
+                                keys.push_back(node.key);
+                        }
+                        REQUIRE(keys == std::vector <int>({90, 45, 14, 4, 3, 2, 0}));
+                        REQUIRE(red_black_tree.minimum()->key == 90);
+                        REQUIRE(red_black_tree.maximum()->key == 0);
+                        REQUIRE(red_black_tree.search(14) != nullptr);
+                        REQUIRE(red_black_tree.search(15) == nullptr);
+                        REQUIRE(red_black_tree.lower_bound(15)->key == 14);
+                        REQUIRE(red_black_tree.insert(14, 0) == nullptr);
+                        REQUIRE(red_black_tree.size() == 7);
+                }
+        }
+        GIVEN("A Red Black Tree of strings with a transparent comparator") {
+                forest::red_black_tree <std::string, int, string_less> red_black_tree;
+                const char *words[] = {"pear", "apple", "fig", "banana", "cherry", "kiwi", "grape", "lemon"};
+                for (int i = 0; i < 8; i++) {
+                        red_black_tree.insert(words[i], i);
+                }
+                THEN("Test search with a const char *") {
+                        auto result = red_black_tree.search("banana");
+                        REQUIRE(result != nullptr);
+                        REQUIRE(result->value == 3);
+                        REQUIRE(red_black_tree.search("mango") == nullptr);
+                }
+                THEN("Test bounds with a const char *") {
+                        REQUIRE(red_black_tree.lower_bound("c")->key == "cherry");
+                        REQUIRE(red_black_tree.upper_bound("fig")->key == "grape");
+                        auto range = red_black_tree.equal_range("kiwi");
+                        REQUIRE(std::distance(range.first, range.second) == 1);
+                }
+                THEN("Test one comparison per level") {
+                        unsigned long long height = red_black_tree.height();
+                        for (int i = 0; i < 8; i++) {
+                                long long comparisons = string_less::comparisons();
+                                REQUIRE(red_black_tree.search(words[i]) != nullptr);
+                                REQUIRE(string_less::comparisons() - comparisons <= static_cast<long long>(height) + 1);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree value construction") {
+        GIVEN("A Red Black Tree of counted values") {
+                forest::red_black_tree <int, counted> red_black_tree;
+                for (int i = 0; i < 10; i++) {
+                        red_black_tree.insert(i, counted(i));
+                }
+                THEN("Test inserting an rvalue moves the value") {
+                        counted::reset();
+                        REQUIRE(red_black_tree.insert(10, counted(10)) != nullptr);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 1);
+                }
+                THEN("Test inserting an lvalue copies the value once") {
+                        counted value(10);
+                        counted::reset();
+                        REQUIRE(red_black_tree.insert(10, value) != nullptr);
+                        REQUIRE(counted::copies() == 1);
+                        REQUIRE(counted::moves() == 0);
+                }
+                THEN("Test inserting a duplicate key leaves the value untouched") {
+                        counted value(50);
+                        counted::reset();
+                        REQUIRE(red_black_tree.insert(5, std::move(value)) == nullptr);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 0);
+                        REQUIRE(value.value == 50);
+                        REQUIRE(red_black_tree.search(5)->value.value == 5);
+                }
+                THEN("Test try_emplace constructs the value in place") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        auto result = red_black_tree.try_emplace(10, 100);
+                        REQUIRE(result.second);
+                        REQUIRE(result.first->key == 10);
+                        REQUIRE(result.first->value.value == 100);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 0);
+                        REQUIRE(counted::alive() == alive + 1);
+                }
+                THEN("Test try_emplace with an existing key constructs nothing") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        auto result = red_black_tree.try_emplace(5, 100);
+                        REQUIRE(!result.second);
+                        REQUIRE(result.first == red_black_tree.search(5));
+                        REQUIRE(result.first->value.value == 5);
+                        REQUIRE(counted::alive() == alive);
+                        REQUIRE(red_black_tree.size() == 10);
+                }
+        }
+        GIVEN("A Red Black Tree of move only values") {
+                forest::red_black_tree <std::string, std::unique_ptr <int> > red_black_tree;
+                THEN("Test insert, try_emplace and emplace") {
+                        std::string key = "b";
+                        REQUIRE(red_black_tree.insert(std::move(key), std::unique_ptr <int> (new int(2))) != nullptr);
+                        REQUIRE(red_black_tree.try_emplace("a", new int(1)).second);
+                        REQUIRE(red_black_tree.emplace("c", new int(3)).second);
+                        REQUIRE(!red_black_tree.emplace("c", nullptr).second);
+                        REQUIRE(red_black_tree.size() == 3);
+                        int expected = 1;
+                        for (const auto &node : red_black_tree) {
+                                REQUIRE(*node.value == expected++);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree upserts") {
+        GIVEN("A Red Black Tree of word counts") {
+                forest::red_black_tree <std::string, int> red_black_tree;
+                const char *words[] = {"to", "be", "or", "not", "to", "be", "that", "is", "the", "question", "to"};
+                for (const char *word : words) {
+                        red_black_tree.upsert(word, [](int &count) { count++; });
+                }
+                THEN("Test every word is counted once per occurrence") {
+                        REQUIRE(red_black_tree.size() == 8);
+                        REQUIRE(red_black_tree.search("to")->value == 3);
+                        REQUIRE(red_black_tree.search("be")->value == 2);
+                        REQUIRE(red_black_tree.search("question")->value == 1);
+                        int total = 0;
+                        for (const auto &node : red_black_tree) {
+                                total += node.value;
+                        }
+                        REQUIRE(total == 11);
+                }
+                THEN("Test insert_or_assign inserts new keys") {
+                        auto result = red_black_tree.insert_or_assign("whether", 7);
+                        REQUIRE(result.second);
+                        REQUIRE(result.first->key == "whether");
+                        REQUIRE(result.first->value == 7);
+                        REQUIRE(red_black_tree.size() == 9);
+                }
+                THEN("Test insert_or_assign assigns existing keys") {
+                        auto result = red_black_tree.insert_or_assign("be", 10);
+                        REQUIRE(!result.second);
+                        REQUIRE(result.first == red_black_tree.search("be"));
+                        REQUIRE(result.first->value == 10);
+                        REQUIRE(red_black_tree.size() == 8);
+                }
+                THEN("Test values can be modified through returned nodes") {
+                        red_black_tree.search("or")->value = 42;
+                        red_black_tree.try_emplace("not").first->value += 5;
+                        REQUIRE(red_black_tree.search("or")->value == 42);
+                        REQUIRE(red_black_tree.search("not")->value == 6);
+                        REQUIRE(red_black_tree.upsert("is", [](int &count) { count *= 3; })->value == 3);
+                }
+        }
+        GIVEN("A Red Black Tree of counted values") {
+                forest::red_black_tree <int, counted> red_black_tree;
+                red_black_tree.insert(1, counted(1));
+                THEN("Test insert_or_assign moves into the existing value") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        REQUIRE(!red_black_tree.insert_or_assign(1, counted(2)).second);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 1);
+                        REQUIRE(counted::alive() == alive);
+                        REQUIRE(red_black_tree.search(1)->value.value == 2);
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree hinted insertion") {
+        GIVEN("An empty Red Black Tree") {
+                forest::red_black_tree <int, int> red_black_tree;
+                THEN("Test increasing keys inserted at end()") {
+                        for (int i = 0; i < 1000; i++) {
+                                auto x = red_black_tree.insert(red_black_tree.end(), i, i * 2);
+                                REQUIRE(x->key == i);
+                        }
+                        REQUIRE(red_black_tree.size() == 1000);
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        int expected = 0;
+                        for (const auto &node : red_black_tree) {
+                                REQUIRE(node.key == expected);
+                                REQUIRE(node.value == expected * 2);
+                                expected++;
+                        }
+                }
+                THEN("Test decreasing keys inserted before the previous node") {
+                        auto hint = red_black_tree.end();
+                        for (int i = 999; i >= 0; i--) {
+                                hint = red_black_tree.insert(hint, i, i);
+                                REQUIRE(hint->key == i);
+                        }
+                        REQUIRE(red_black_tree.size() == 1000);
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(red_black_tree.minimum()->key == 0);
+                        REQUIRE(red_black_tree.maximum()->key == 999);
+                }
+                THEN("Test duplicate keys return the existing node") {
+                        red_black_tree.insert(5, 50);
+                        auto x = red_black_tree.insert(red_black_tree.begin(), 5, 60);
+                        REQUIRE(x == red_black_tree.begin());
+                        REQUIRE(x->value == 50);
+                        REQUIRE(red_black_tree.insert(red_black_tree.end(), 5, 70)->value == 50);
+                        REQUIRE(red_black_tree.size() == 1);
+                }
+                THEN("Test the append path after the maximum is erased") {
+                        for (int i = 0; i < 100; i++) {
+                                red_black_tree.insert(i, i);
+                        }
+                        for (int i = 99; i >= 50; i--) {
+                                REQUIRE(red_black_tree.erase(i));
+                        }
+                        red_black_tree.insert(60, 60);
+                        red_black_tree.insert(55, 55);
+                        red_black_tree.insert(red_black_tree.end(), 70, 70);
+                        REQUIRE(red_black_tree.maximum()->key == 70);
+                        REQUIRE(red_black_tree.size() == 53);
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        std::vector <int> keys;
+                        for (const auto &node : red_black_tree) {
+                                keys.push_back(node.key);
+                        }
+                        REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+                }
+        }
+        GIVEN("A Red Black Tree filled with random keys and random hints") {
+                forest::red_black_tree <int, int> red_black_tree;
+                std::set <int> reference;
+                std::mt19937 random(11);
+                for (int i = 0; i < 2000; i++) {
+                        int key = static_cast<int>(random() % 1000);
+                        auto hint = red_black_tree.lower_bound(static_cast<int>(random() % 1000));
+                        auto x = red_black_tree.insert(hint, key, key);
+                        reference.insert(key);
+                        REQUIRE(x->key == key);
+                }
+                THEN("The tree holds the same keys as a std::set") {
+                        REQUIRE(red_black_tree.size() == reference.size());
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(std::equal(reference.begin(), reference.end(), red_black_tree.begin(), [](int key, const forest::red_black_tree_node <int, int> &node) {
+                                return key == node.key;
+                        }));
+                        REQUIRE(red_black_tree.maximum()->key == *reference.rbegin());
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree minimum and maximum") {
+        GIVEN("An empty Red Black Tree") {
+                forest::red_black_tree <int, int> red_black_tree;
+                THEN("There is no minimum or maximum to remove") {
+                        REQUIRE(red_black_tree.minimum() == nullptr);
+                        REQUIRE(red_black_tree.maximum() == nullptr);
+                        REQUIRE(!red_black_tree.pop_min());
+                        REQUIRE(!red_black_tree.pop_max());
+                }
+        }
+        GIVEN("A Red Black Tree changed by random inserts and erases") {
+                forest::red_black_tree <int, int> red_black_tree;
+                std::set <int> reference;
+                std::mt19937 random(5);
+                THEN("The minimum and maximum always match a std::set") {
+                        for (int i = 0; i < 5000; i++) {
+                                int key = static_cast<int>(random() % 500);
+                                switch (random() % 4) {
+                                case 0:
+                                        REQUIRE(red_black_tree.erase(key) == (reference.erase(key) == 1));
+                                        break;
+                                case 1:
+                                        REQUIRE(red_black_tree.pop_min() == !reference.empty());
+                                        if (!reference.empty()) reference.erase(reference.begin());
+                                        break;
+                                default:
+                                        red_black_tree.insert(key, key);
+                                        reference.insert(key);
+                                }
+                                if (reference.empty()) {
+                                        REQUIRE(red_black_tree.minimum() == nullptr);
+                                        REQUIRE(red_black_tree.maximum() == nullptr);
+                                } else {
+                                        REQUIRE(red_black_tree.minimum()->key == *reference.begin());
+                                        REQUIRE(red_black_tree.maximum()->key == *reference.rbegin());
+                                        REQUIRE(red_black_tree.begin()->key == *reference.begin());
+                                }
+                        }
+                }
+        }
+        GIVEN("A Red Black Tree with the keys 0 to 99") {
+                forest::red_black_tree <int, int> red_black_tree;
+                for (int key : {50, 20, 80, 10, 30, 70, 90}) {
+                        red_black_tree.insert(key, key);
+                }
+                for (int i = 0; i < 100; i++) {
+                        red_black_tree.insert(i, i);
+                }
+                THEN("Test pop_min removes the keys in increasing order") {
+                        for (int i = 0; i < 100; i++) {
+                                REQUIRE(red_black_tree.minimum()->key == i);
+                                REQUIRE(red_black_tree.pop_min());
+                        }
+                        REQUIRE(red_black_tree.empty());
+                        REQUIRE(!red_black_tree.pop_min());
+                }
+                THEN("Test pop_max removes the keys in decreasing order") {
+                        for (int i = 99; i >= 0; i--) {
+                                REQUIRE(red_black_tree.maximum()->key == i);
+                                REQUIRE(red_black_tree.pop_max());
+                        }
+                        REQUIRE(red_black_tree.empty());
+                        REQUIRE(red_black_tree.begin() == red_black_tree.end());
+                }
+                THEN("Test popping from both ends") {
+                        for (int i = 0; i < 50; i++) {
+                                REQUIRE(red_black_tree.pop_min());
+                                REQUIRE(red_black_tree.pop_max());
+                        }
+                        REQUIRE(red_black_tree.empty());
+                        red_black_tree.insert(7, 7);
+                        REQUIRE(red_black_tree.minimum() == red_black_tree.maximum());
+                }
+        }
+        GIVEN("A bulk loaded Red Black Tree") {
+                std::vector <std::pair <int, int> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i * 2, i));
+                }
+                forest::red_black_tree <int, int> red_black_tree = forest::red_black_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+                THEN("The minimum and maximum are known") {
+                        REQUIRE(red_black_tree.minimum()->key == 0);
+                        REQUIRE(red_black_tree.maximum()->key == 198);
+                        forest::red_black_tree <int, int> moved(std::move(red_black_tree));
+                        REQUIRE(red_black_tree.minimum() == nullptr);
+                        REQUIRE(moved.minimum()->key == 0);
+                        REQUIRE(moved.maximum()->key == 198);
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree compact nodes") {
+        typedef forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, false, true> compact_tree;
+        typedef forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, true, true> compact_order_statistic_tree;
+        GIVEN("The node layouts") {
+                THEN("The color takes no space in a compact node") {
+                        REQUIRE(sizeof(forest::red_black_tree_node <int, int, false, true>) == 4 + 4 + 3 * sizeof(void *));
+                        REQUIRE(sizeof(forest::red_black_tree_node <int, int, false, true>) < sizeof(forest::red_black_tree_node <int, int>));
+                }
+                THEN("The parent and the color are independent") {
+                        compact_tree red_black_tree;
+                        red_black_tree.insert(2, 2);
+                        red_black_tree.insert(1, 1);
+                        red_black_tree.insert(3, 3);
+                        const forest::red_black_tree_node <int, int, false, true> *root = red_black_tree.search(2);
+                        REQUIRE(root->get_color() == forest::black);
+                        REQUIRE(root->get_parent() == nullptr);
+                        for (int key : {1, 3}) {
+                                const forest::red_black_tree_node <int, int, false, true> *x = red_black_tree.search(key);
+                                REQUIRE(x->get_color() == forest::red);
+                                REQUIRE(x->get_parent() == root);
+                        }
+                        REQUIRE(root->get_left() == red_black_tree.search(1));
+                        REQUIRE(root->get_right() == red_black_tree.search(3));
+                        red_black_tree.insert(4, 4);
+                        REQUIRE(red_black_tree.search(3)->get_color() == forest::black);
+                        REQUIRE(red_black_tree.search(3)->get_parent() == root);
+                        REQUIRE(red_black_tree.search(4)->get_color() == forest::red);
+                        REQUIRE(red_black_tree.search(4)->get_parent() == red_black_tree.search(3));
+                }
+        }
+        GIVEN("A compact Red Black Tree under random inserts and erases") {
+                compact_tree red_black_tree;
+                std::set <int> reference;
+                std::mt19937 random(21);
+                bool ok = true;
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 512);
+                        if (random() % 3 != 0) {
+                                red_black_tree.insert(key, key);
+                                reference.insert(key);
+                        } else {
+                                REQUIRE(red_black_tree.erase(key) == (reference.erase(key) == 1));
+                        }
+                        if (i % 64 == 0) ok = ok && valid(red_black_tree.minimum());
+                }
+                THEN("The tree stays valid and holds the same keys as a std::set") {
+                        REQUIRE(ok);
+                        REQUIRE(red_black_tree.size() == reference.size());
+                        REQUIRE(std::equal(reference.begin(), reference.end(), red_black_tree.begin(), [](int key, const forest::red_black_tree_node <int, int, false, true> &node) {
+                                return key == node.key;
+                        }));
+                        REQUIRE(std::equal(reference.rbegin(), reference.rend(), red_black_tree.rbegin(), [](int key, const forest::red_black_tree_node <int, int, false, true> &node) {
+                                return key == node.key;
+                        }));
+                }
+        }
+        GIVEN("A compact Red Black Tree with order statistics") {
+                compact_order_statistic_tree red_black_tree;
+                std::vector <std::pair <int, int> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i * 3, i));
+                }
+                red_black_tree.assign_sorted(pairs.begin(), pairs.end());
+                for (int i = 0; i < 100; i++) {
+                        red_black_tree.insert(i * 3 + 1, i);
+                }
+                THEN("select and rank work on compact nodes") {
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(red_black_tree.size() == 200);
+                        REQUIRE(red_black_tree.select(0)->key == 0);
+                        REQUIRE(red_black_tree.select(1)->key == 1);
+                        REQUIRE(red_black_tree.select(199)->key == 298);
+                        REQUIRE(red_black_tree.rank(150) == 100);
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree index storage") {
+        typedef forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, false, false, true> indexed_tree;
+        typedef forest::red_black_tree <int, int, std::less <int>, std::allocator <forest::red_black_tree_node <int, int> >, true, true, true> indexed_order_statistic_tree;
+        GIVEN("The node layouts") {
+                THEN("Links take 4 bytes each") {
+                        REQUIRE(sizeof(forest::red_black_tree_node <int, int, false, false, true>) == 4 + 4 + 4 + 3 * 4);
+                        REQUIRE(sizeof(forest::red_black_tree_node <int, int, false, false, true>) < sizeof(forest::red_black_tree_node <int, int, false, true>));
+                }
+        }
+        GIVEN("An indexed Red Black Tree under random inserts and erases") {
+                indexed_tree red_black_tree;
+                std::set <int> reference;
+                std::mt19937 random(23);
+                bool ok = true;
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 1024);
+                        if (random() % 3 != 0) {
+                                red_black_tree.insert(key, key);
+                                reference.insert(key);
+                        } else {
+                                REQUIRE(red_black_tree.erase(key) == (reference.erase(key) == 1));
+                        }
+                        if (i % 64 == 0) ok = ok && valid(red_black_tree.minimum());
+                }
+                THEN("The tree stays valid and holds the same keys as a std::set") {
+                        REQUIRE(ok);
+                        REQUIRE(red_black_tree.size() == reference.size());
+                        REQUIRE(std::equal(reference.begin(), reference.end(), red_black_tree.begin(), [](int key, const forest::red_black_tree_node <int, int, false, false, true> &node) {
+                                return key == node.key;
+                        }));
+                        REQUIRE(std::equal(reference.rbegin(), reference.rend(), red_black_tree.rbegin(), [](int key, const forest::red_black_tree_node <int, int, false, false, true> &node) {
+                                return key == node.key;
+                        }));
+                }
+                WHEN("The tree is cloned and the original is cleared") {
+                        indexed_tree copy = red_black_tree.clone();
+                        red_black_tree.clear();
+                        THEN("The clone keeps every node") {
+                                REQUIRE(valid(copy.minimum()));
+                                REQUIRE(copy.size() == reference.size());
+                                REQUIRE(copy.minimum()->key == *reference.begin());
+                                REQUIRE(copy.maximum()->key == *reference.rbegin());
+                                REQUIRE(std::equal(reference.begin(), reference.end(), copy.begin(), [](int key, const forest::red_black_tree_node <int, int, false, false, true> &node) {
+                                        return key == node.key;
+                                }));
+                        }
+                }
+                WHEN("The tree is saved and loaded into another tree") {
+                        std::stringstream stream;
+                        red_black_tree.save(stream);
+                        indexed_tree loaded;
+                        loaded.insert(-1, -1);
+                        loaded.load(stream);
+                        THEN("The loaded tree holds the same keys and accepts new ones") {
+                                REQUIRE(valid(loaded.minimum()));
+                                REQUIRE(loaded.size() == reference.size());
+                                REQUIRE(std::equal(reference.begin(), reference.end(), loaded.begin(), [](int key, const forest::red_black_tree_node <int, int, false, false, true> &node) {
+                                        return key == node.key;
+                                }));
+                                for (int i = 2000; i < 3000; i++) {
+                                        loaded.insert(i, i);
+                                }
+                                REQUIRE(valid(loaded.minimum()));
+                                REQUIRE(loaded.size() == reference.size() + 1000);
+                                REQUIRE(loaded.search(2500)->value == 2500);
+                        }
+                }
+        }
+        GIVEN("An indexed Red Black Tree filled through hints") {
+                indexed_tree red_black_tree;
+                for (int i = 0; i < 1000; i++) {
+                        red_black_tree.insert(red_black_tree.end(), i * 2, i);
+                }
+                for (int i = 0; i < 1000; i++) {
+                        red_black_tree.insert(red_black_tree.lower_bound(i * 2 + 1), i * 2 + 1, i);
+                }
+                THEN("The hints survive the nodes moving as the array grows") {
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(red_black_tree.size() == 2000);
+                        int key = 0;
+                        for (const auto &node : red_black_tree) {
+                                REQUIRE(node.key == key++);
+                        }
+                }
+        }
+        GIVEN("An indexed Red Black Tree with reserved nodes") {
+                indexed_order_statistic_tree red_black_tree;
+                red_black_tree.reserve(1000);
+                red_black_tree.insert(0, 0);
+                const forest::red_black_tree_node <int, int, true, true, true> *first = red_black_tree.search(0);
+                for (int i = 1; i < 1000; i++) {
+                        red_black_tree.insert(i, i);
+                }
+                THEN("Nodes do not move and order statistics work") {
+                        REQUIRE(red_black_tree.search(0) == first);
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(red_black_tree.select(500)->key == 500);
+                        REQUIRE(red_black_tree.rank(500) == 500);
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree batched search") {
+        GIVEN("An empty Red Black Tree") {
+                forest::red_black_tree <int, int> red_black_tree;
+                forest::red_black_tree <int, int> other;
+                other.insert(1, 1);
+                std::vector <int> keys = {1, 2, 3};
+                std::vector <forest::red_black_tree_node <int, int> *> found(keys.size(), other.search(1));
+                red_black_tree.search_batch(keys.data(), keys.size(), found.data());
+                THEN("Every search misses") {
+                        REQUIRE(std::count(found.begin(), found.end(), nullptr) == 3);
+                }
+        }
+        GIVEN("A Red Black Tree with random keys") {
+                forest::red_black_tree <int, int> red_black_tree;
+                std::mt19937 random(99);
+                for (int i = 0; i < 1000; i++) {
+                        int key = static_cast<int>(random() % 2000);
+                        red_black_tree.insert(key, -key);
+                }
+                THEN("Batches of every size up to 40 find what search finds") {
+                        for (std::size_t n = 0; n <= 40; n++) {
+                                std::vector <int> keys;
+                                for (std::size_t i = 0; i < n; i++) {
+                                        keys.push_back(static_cast<int>(random() % 2100) - 50);
+                                }
+                                std::vector <forest::red_black_tree_node <int, int> *> found(n);
+                                red_black_tree.search_batch(keys.data(), n, found.data());
+                                for (std::size_t i = 0; i < n; i++) {
+                                        REQUIRE(found[i] == red_black_tree.search(keys[i]));
+                                }
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Red Black Tree pool allocator") {
+        GIVEN("A Red Black Tree with a pool allocator") {
+                forest::red_black_tree <int, int, std::less <int>, forest::pool_allocator <forest::red_black_tree_node <int, int> > > red_black_tree;
+                for (int i = 0; i < 10000; i++) {
+                        red_black_tree.insert(i, -i);
+                }
+                for (int i = 0; i < 10000; i += 2) {
+                        red_black_tree.erase(i);
+                }
+                THEN("Test the nodes and array allocations that do not fit in memory") {
+                        REQUIRE(valid(red_black_tree.minimum()));
+                        REQUIRE(red_black_tree.size() == 5000);
+                        REQUIRE(red_black_tree.search(9999)->value == -9999);
+                        forest::pool_allocator <std::uint64_t> allocator;
+                        REQUIRE_THROWS_AS(allocator.allocate(static_cast<std::size_t>(-1) / 4), std::bad_array_new_length);
+                        std::uint64_t *array = allocator.allocate(3);
+                        allocator.deallocate(array, 3);
+                }
+        }
+}
@@ -1,5 +1,44 @@
 #include "catch.hpp"
 #include <forest/splay_tree.h>
+#include "assignable.h"
+#include "counted.h"
+#include "string_less.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(!element_assignable <forest::splay_tree <int, int>::iterator>::value, "whole nodes must not be assigned or swapped through an iterator, their links would go with them");
+static_assert(!key_assignable <forest::splay_tree <int, int>::iterator>::value, "keys must not be changed through an iterator");
+static_assert(value_assignable <forest::splay_tree <int, int>::iterator>::value, "values may be changed through an iterator");
+static_assert(!links_assignable <decltype(std::declval <forest::splay_tree <int, int> &> ().search(0))>::value, "a node returned by search must not be relinked");
+static_assert(!links_assignable <forest::splay_tree <int, int>::iterator>::value, "nodes must not be relinked through an iterator");
+
+/**
+ * @brief Checks the parent links and the ordering of the subtree rooted at x
+ */
+template <typename node_t>
+bool valid(const node_t *x) {
+        if (x == nullptr) return true;
+        if (x->get_left() != nullptr && (x->get_left()->get_parent() != x || !(x->get_left()->key < x->key))) return false;
+        if (x->get_right() != nullptr && (x->get_right()->get_parent() != x || !(x->key < x->get_right()->key))) return false;
+        return valid(x->get_left()) && valid(x->get_right());
+}
+
+/**
+ * @brief Finds the root of the tree containing x
+ */
+template <typename node_t>
+const node_t *find_root(const node_t *x) {
+        if (x == nullptr) return nullptr;
+        while (x->get_parent() != nullptr) x = x->get_parent();
+        return x;
+}
 
 SCENARIO("Test Splay Tree") {
         GIVEN("A Splay Tree") {
@@ -41,6 +80,10 @@ SCENARIO("Test Splay Tree") {
                         THEN("Test size") {
                                 REQUIRE(splay_tree.size() == 7);
                         }
+                        THEN("Test size after inserting a key that already exists") {
+                                splay_tree.insert(3, 5);
+                                REQUIRE(splay_tree.size() == 7);
+                        }
                         THEN("Test height") {
                                 REQUIRE(splay_tree.height() == 5);
                         }
@@ -141,3 +184,651 @@ SCENARIO("Test Splay Tree") {
                 }
         }
 }
+
+SCENARIO("Test Splay Tree destruction") {
+        GIVEN("A Splay Tree of counted values") {
+                long long alive = counted::alive();
+                WHEN("The Splay Tree goes out of scope") {
+                        {
+                                forest::splay_tree <int, counted> splay_tree;
+                                for (int i = 0; i < 1000; i++) {
+                                        splay_tree.insert((i * 7919) % 1000, counted(i));
+                                }
+                                REQUIRE(counted::alive() == alive + 1000);
+                        }
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                        }
+                }
+                WHEN("Nodes are inserted in ascending order and the Splay Tree goes out of scope") {
+                        {
+                                forest::splay_tree <int, counted> splay_tree;
+                                for (int i = 0; i < 10000; i++) {
+                                        splay_tree.insert(i, counted(i));
+                                }
+                        }
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                        }
+                }
+                WHEN("The Splay Tree is cleared") {
+                        forest::splay_tree <int, counted> splay_tree;
+                        for (int i = 0; i < 1000; i++) {
+                                splay_tree.insert(i, counted(i));
+                        }
+                        splay_tree.clear();
+                        THEN("Every node is freed") {
+                                REQUIRE(counted::alive() == alive);
+                                REQUIRE(splay_tree.empty() == true);
+                                REQUIRE(splay_tree.size() == 0);
+                                REQUIRE(splay_tree.search(10) == nullptr);
+                        }
+                        THEN("The Splay Tree can be reused") {
+                                REQUIRE(splay_tree.insert(10, counted(10)) != nullptr);
+                                REQUIRE(splay_tree.size() == 1);
+                                REQUIRE(splay_tree.search(10) != nullptr);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree erase") {
+        GIVEN("A Splay Tree") {
+                forest::splay_tree <int, int> splay_tree;
+                for (int i = 0; i < 10; i++) {
+                        splay_tree.insert(i, i*i);
+                }
+                WHEN("A key that does not exist is erased") {
+                        REQUIRE(splay_tree.erase(1337) == false);
+                        THEN("Nothing is removed and the last node visited is splayed") {
+                                REQUIRE(splay_tree.size() == 10);
+                                REQUIRE(find_root(splay_tree.minimum())->key == 9);
+                        }
+                }
+                WHEN("A key that does exist is erased") {
+                        REQUIRE(splay_tree.erase(5) == true);
+                        THEN("The maximum of the left subtree becomes the root") {
+                                REQUIRE(splay_tree.size() == 9);
+                                REQUIRE(splay_tree.search(5) == nullptr);
+                                REQUIRE(splay_tree.search(6)->value == 36);
+                                REQUIRE(find_root(splay_tree.minimum())->key == 4);
+                                REQUIRE(valid(find_root(splay_tree.minimum())));
+                        }
+                }
+                WHEN("The minimum is erased") {
+                        splay_tree.erase(splay_tree.minimum());
+                        THEN("The right subtree becomes the tree") {
+                                REQUIRE(splay_tree.size() == 9);
+                                REQUIRE(splay_tree.minimum()->key == 1);
+                                REQUIRE(valid(find_root(splay_tree.minimum())));
+                        }
+                }
+                WHEN("Every key is erased") {
+                        for (int i = 9; i >= 0; i--) {
+                                REQUIRE(splay_tree.erase(i) == true);
+                        }
+                        THEN("The Splay Tree is empty") {
+                                REQUIRE(splay_tree.empty() == true);
+                                REQUIRE(splay_tree.size() == 0);
+                                REQUIRE(splay_tree.minimum() == nullptr);
+                        }
+                }
+        }
+        GIVEN("A Splay Tree under random inserts and erases") {
+                forest::splay_tree <int, counted> splay_tree;
+                std::set <int> reference;
+                std::mt19937 random(1234);
+                long long alive = counted::alive();
+                bool ok = true;
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 512);
+                        if (random() % 2 == 0) {
+                                splay_tree.insert(key, counted(key));
+                                reference.insert(key);
+                        } else {
+                                ok = ok && splay_tree.erase(key) == (reference.erase(key) == 1);
+                        }
+                }
+                THEN("The contents are preserved") {
+                        REQUIRE(ok);
+                        REQUIRE(valid(find_root(splay_tree.minimum())));
+                        REQUIRE(splay_tree.size() == reference.size());
+                        REQUIRE(counted::alive() == alive + static_cast<long long>(reference.size()));
+                        for (int key = 0; key < 512; key++) {
+                                REQUIRE((splay_tree.search(key) != nullptr) == (reference.count(key) == 1));
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree iterators") {
+        GIVEN("A Splay Tree") {
+                forest::splay_tree <int, int> splay_tree;
+                WHEN("The Splay Tree is empty") {
+                        THEN("begin is equal to end") {
+                                REQUIRE(splay_tree.begin() == splay_tree.end());
+                                REQUIRE(splay_tree.rbegin() == splay_tree.rend());
+                                REQUIRE(splay_tree.cbegin() == splay_tree.cend());
+                        }
+                }
+                WHEN("Nodes are inserted in random order") {
+                        for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                                splay_tree.insert(key, key * 10);
+                        }
+                        THEN("Test in order iteration") {
+                                std::vector <int> keys;
+                                for (auto &node : splay_tree) {
+                                        keys.push_back(node.key);
+                                        REQUIRE(node.value == node.key * 10);
+                                }
+                                REQUIRE(keys == std::vector <int>({0, 2, 3, 4, 14, 45, 90}));
+                        }
+                        THEN("Test reverse iteration") {
+                                std::vector <int> keys;
+                                for (auto it = splay_tree.rbegin(); it != splay_tree.rend(); ++it) {
+                                        keys.push_back(it->key);
+                                }
+                                REQUIRE(keys == std::vector <int>({90, 45, 14, 4, 3, 2, 0}));
+                        }
+                        THEN("Test decrementing end") {
+                                auto it = splay_tree.end();
+                                --it;
+                                REQUIRE(it->key == 90);
+                                it--;
+                                REQUIRE(it->key == 45);
+                        }
+                        THEN("Test algorithms") {
+                                REQUIRE(std::distance(splay_tree.begin(), splay_tree.end()) == 7);
+                                auto it = std::find_if(splay_tree.begin(), splay_tree.end(), [](const forest::splay_tree_node <int, int> &node) {
+                                        return node.key > 10;
+                                });
+                                REQUIRE(it != splay_tree.end());
+                                REQUIRE(it->key == 14);
+                        }
+                        THEN("Test constant iteration") {
+                                const forest::splay_tree <int, int> &tree = splay_tree;
+                                forest::splay_tree <int, int>::const_iterator it = splay_tree.begin();
+                                REQUIRE(it == tree.begin());
+                                int sum = 0;
+                                for (const auto &node : tree) {
+                                        sum += node.key;
+                                }
+                                REQUIRE(sum == 158);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree range queries") {
+        GIVEN("A Splay Tree with the even keys from 0 to 98") {
+                forest::splay_tree <int, int> splay_tree;
+                for (int i = 0; i < 50; i++) {
+                        splay_tree.insert((i * 17) % 50 * 2, i);
+                }
+                THEN("Test lower_bound") {
+                        REQUIRE(splay_tree.lower_bound(-5)->key == 0);
+                        REQUIRE(splay_tree.lower_bound(10)->key == 10);
+                        REQUIRE(splay_tree.lower_bound(11)->key == 12);
+                        REQUIRE(splay_tree.lower_bound(98)->key == 98);
+                        REQUIRE(splay_tree.lower_bound(99) == splay_tree.end());
+                }
+                THEN("Test upper_bound") {
+                        REQUIRE(splay_tree.upper_bound(-5)->key == 0);
+                        REQUIRE(splay_tree.upper_bound(10)->key == 12);
+                        REQUIRE(splay_tree.upper_bound(11)->key == 12);
+                        REQUIRE(splay_tree.upper_bound(98) == splay_tree.end());
+                }
+                THEN("Test equal_range") {
+                        auto found = splay_tree.equal_range(20);
+                        REQUIRE(std::distance(found.first, found.second) == 1);
+                        REQUIRE(found.first->key == 20);
+                        auto missing = splay_tree.equal_range(21);
+                        REQUIRE(missing.first == missing.second);
+                        REQUIRE(missing.first->key == 22);
+                }
+                THEN("Test for_each_in_range") {
+                        std::vector <int> keys;
+                        splay_tree.for_each_in_range(15, 25, [&keys](const forest::splay_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys == std::vector <int>({16, 18, 20, 22, 24}));
+                        keys.clear();
+                        splay_tree.for_each_in_range(90, 1000, [&keys](const forest::splay_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys == std::vector <int>({90, 92, 94, 96, 98}));
+                        keys.clear();
+                        splay_tree.for_each_in_range(31, 32, [&keys](const forest::splay_tree_node <int, int> &node) {
+                                keys.push_back(node.key);
+                        });
+                        REQUIRE(keys.empty());
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree bulk loading") {
+        GIVEN("Sorted ranges of every size up to 100") {
+                THEN("from_sorted creates a perfectly balanced Splay Tree containing the range") {
+                        for (int n = 0; n <= 100; n++) {
+                                std::vector <std::pair <int, int> > pairs;
+                                for (int i = 0; i < n; i++) {
+                                        pairs.push_back(std::make_pair(i * 3, -i));
+                                }
+                                auto splay_tree = forest::splay_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+                                unsigned long long height = 0;
+                                while ((1ULL << height) - 1 < static_cast<unsigned long long>(n)) height++;
+                                REQUIRE(splay_tree.size() == static_cast<unsigned long long>(n));
+                                REQUIRE(splay_tree.height() == height);
+                                REQUIRE(valid(find_root(splay_tree.minimum())));
+                                std::vector <std::pair <int, int> > contents;
+                                for (const auto &node : splay_tree) {
+                                        contents.push_back(std::make_pair(node.key, node.value));
+                                }
+                                REQUIRE(contents == pairs);
+                        }
+                }
+        }
+        GIVEN("A Splay Tree with nodes") {
+                forest::splay_tree <int, int> splay_tree;
+                for (int i = 0; i < 10; i++) {
+                        splay_tree.insert(i, i);
+                }
+                WHEN("A sorted range is assigned") {
+                        std::vector <std::pair <int, int> > pairs;
+                        for (int i = 100; i < 200; i += 2) {
+                                pairs.push_back(std::make_pair(i, i));
+                        }
+                        splay_tree.assign_sorted(pairs.begin(), pairs.end());
+                        THEN("The old nodes are replaced") {
+                                REQUIRE(splay_tree.size() == 50);
+                                REQUIRE(splay_tree.search(5) == nullptr);
+                                REQUIRE(splay_tree.minimum()->key == 100);
+                                REQUIRE(splay_tree.maximum()->key == 198);
+                        }
+                        THEN("The Splay Tree can still be modified") {
+                                REQUIRE(splay_tree.insert(101, 0) != nullptr);
+                                REQUIRE(splay_tree.erase(100) == true);
+                                REQUIRE(splay_tree.size() == 50);
+                                REQUIRE(splay_tree.minimum()->key == 101);
+                                REQUIRE(valid(find_root(splay_tree.minimum())));
+                        }
+                }
+        }
+        GIVEN("A Splay Tree of counted values and a sorted range whose values throw when copied") {
+                forest::splay_tree <int, counted> splay_tree;
+                for (int i = 0; i < 10; i++) {
+                        splay_tree.insert(i, counted(i));
+                }
+                std::vector <std::pair <int, counted> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i, counted(i)));
+                }
+                long long alive = counted::alive() - 10;
+                THEN("Every node built before the throw is freed and the Splay Tree is left empty") {
+                        bool ok = true;
+                        for (long long limit = 0; limit < 100; limit++) {
+                                counted::reset();
+                                counted::copy_limit() = limit;
+                                bool thrown = false;
+                                try {
+                                        splay_tree.assign_sorted(pairs.begin(), pairs.end());
+                                } catch (const std::runtime_error &) {
+                                        thrown = true;
+                                }
+                                ok = ok && thrown && counted::alive() == alive && splay_tree.empty() && splay_tree.size() == 0;
+                                ok = ok && splay_tree.minimum() == nullptr && splay_tree.begin() == splay_tree.end();
+                        }
+                        counted::reset();
+                        REQUIRE(ok);
+                }
+                THEN("The Splay Tree can be bulk loaded again") {
+                        counted::reset();
+                        counted::copy_limit() = 50;
+                        REQUIRE_THROWS_AS(splay_tree.assign_sorted(pairs.begin(), pairs.end()), std::runtime_error);
+                        counted::reset();
+                        splay_tree.assign_sorted(pairs.begin(), pairs.end());
+                        REQUIRE(splay_tree.size() == 100);
+                        REQUIRE(valid(find_root(splay_tree.minimum())));
+                        REQUIRE(counted::alive() == alive + 100);
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree comparators") {
+        GIVEN("A Splay Tree ordered by std::greater") {
+                forest::splay_tree <int, int, std::greater <int> > splay_tree;
+                for (int key : {4, 2, 90, 3, 0, 14, 45}) {
+                        splay_tree.insert(key, key);
+                }
+                THEN("The keys are in descending order") {
+                        std::vector <int> keys;
+                        for (const auto &node : splay_tree) {
+                                keys.push_back(node.key);
+                        }
+                        REQUIRE(keys == std::vector <int>({90, 45, 14, 4, 3, 2, 0}));
+                        REQUIRE(splay_tree.minimum()->key == 90);
+                        REQUIRE(splay_tree.maximum()->key == 0);
+                        REQUIRE(splay_tree.search(14) != nullptr);
+                        REQUIRE(splay_tree.search(15) == nullptr);
+                        REQUIRE(splay_tree.lower_bound(15)->key == 14);
+                        REQUIRE(splay_tree.insert(14, 0) == splay_tree.search(14));
+                        REQUIRE(splay_tree.size() == 7);
+                }
+        }
+        GIVEN("A Splay Tree of strings with a transparent comparator") {
+                forest::splay_tree <std::string, int, string_less> splay_tree;
+                const char *words[] = {"pear", "apple", "fig", "banana", "cherry", "kiwi", "grape", "lemon"};
+                for (int i = 0; i < 8; i++) {
+                        splay_tree.insert(words[i], i);
+                }
+                THEN("Test search with a const char *") {
+                        auto result = splay_tree.search("banana");
+                        REQUIRE(result != nullptr);
+                        REQUIRE(result->value == 3);
+                        REQUIRE(splay_tree.search("mango") == nullptr);
+                }
+                THEN("Test bounds with a const char *") {
+                        REQUIRE(splay_tree.lower_bound("c")->key == "cherry");
+                        REQUIRE(splay_tree.upper_bound("fig")->key == "grape");
+                        auto range = splay_tree.equal_range("kiwi");
+                        REQUIRE(std::distance(range.first, range.second) == 1);
+                }
+                THEN("Test one comparison per level") {
+                        unsigned long long height = splay_tree.height();
+                        for (int i = 0; i < 8; i++) {
+                                long long comparisons = string_less::comparisons();
+                                REQUIRE(splay_tree.search(words[i]) != nullptr);
+                                REQUIRE(string_less::comparisons() - comparisons <= static_cast<long long>(height) + 1);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree value construction") {
+        GIVEN("A Splay Tree of counted values") {
+                forest::splay_tree <int, counted> splay_tree;
+                for (int i = 0; i < 10; i++) {
+                        splay_tree.insert(i, counted(i));
+                }
+                THEN("Test inserting an rvalue moves the value") {
+                        counted::reset();
+                        REQUIRE(splay_tree.insert(10, counted(10)) != nullptr);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 1);
+                }
+                THEN("Test inserting an lvalue copies the value once") {
+                        counted value(10);
+                        counted::reset();
+                        REQUIRE(splay_tree.insert(10, value) != nullptr);
+                        REQUIRE(counted::copies() == 1);
+                        REQUIRE(counted::moves() == 0);
+                }
+                THEN("Test inserting a duplicate key leaves the value untouched") {
+                        counted value(50);
+                        counted::reset();
+                        REQUIRE(splay_tree.insert(5, std::move(value)) == splay_tree.search(5));
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 0);
+                        REQUIRE(value.value == 50);
+                        REQUIRE(splay_tree.search(5)->value.value == 5);
+                }
+                THEN("Test try_emplace constructs the value in place") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        auto result = splay_tree.try_emplace(10, 100);
+                        REQUIRE(result.second);
+                        REQUIRE(result.first->key == 10);
+                        REQUIRE(result.first->value.value == 100);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 0);
+                        REQUIRE(counted::alive() == alive + 1);
+                }
+                THEN("Test try_emplace with an existing key constructs nothing") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        auto result = splay_tree.try_emplace(5, 100);
+                        REQUIRE(!result.second);
+                        REQUIRE(result.first == splay_tree.search(5));
+                        REQUIRE(result.first->value.value == 5);
+                        REQUIRE(counted::alive() == alive);
+                        REQUIRE(splay_tree.size() == 10);
+                }
+        }
+        GIVEN("A Splay Tree of move only values") {
+                forest::splay_tree <std::string, std::unique_ptr <int> > splay_tree;
+                THEN("Test insert, try_emplace and emplace") {
+                        std::string key = "b";
+                        REQUIRE(splay_tree.insert(std::move(key), std::unique_ptr <int> (new int(2))) != nullptr);
+                        REQUIRE(splay_tree.try_emplace("a", new int(1)).second);
+                        REQUIRE(splay_tree.emplace("c", new int(3)).second);
+                        REQUIRE(!splay_tree.emplace("c", nullptr).second);
+                        REQUIRE(splay_tree.size() == 3);
+                        int expected = 1;
+                        for (const auto &node : splay_tree) {
+                                REQUIRE(*node.value == expected++);
+                        }
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree upserts") {
+        GIVEN("A Splay Tree of word counts") {
+                forest::splay_tree <std::string, int> splay_tree;
+                const char *words[] = {"to", "be", "or", "not", "to", "be", "that", "is", "the", "question", "to"};
+                for (const char *word : words) {
+                        splay_tree.upsert(word, [](int &count) { count++; });
+                }
+                THEN("Test every word is counted once per occurrence") {
+                        REQUIRE(splay_tree.size() == 8);
+                        REQUIRE(splay_tree.search("to")->value == 3);
+                        REQUIRE(splay_tree.search("be")->value == 2);
+                        REQUIRE(splay_tree.search("question")->value == 1);
+                        int total = 0;
+                        for (const auto &node : splay_tree) {
+                                total += node.value;
+                        }
+                        REQUIRE(total == 11);
+                }
+                THEN("Test insert_or_assign inserts new keys") {
+                        auto result = splay_tree.insert_or_assign("whether", 7);
+                        REQUIRE(result.second);
+                        REQUIRE(result.first->key == "whether");
+                        REQUIRE(result.first->value == 7);
+                        REQUIRE(splay_tree.size() == 9);
+                }
+                THEN("Test insert_or_assign assigns existing keys") {
+                        auto result = splay_tree.insert_or_assign("be", 10);
+                        REQUIRE(!result.second);
+                        REQUIRE(result.first == splay_tree.search("be"));
+                        REQUIRE(result.first->value == 10);
+                        REQUIRE(splay_tree.size() == 8);
+                }
+                THEN("Test values can be modified through returned nodes") {
+                        splay_tree.search("or")->value = 42;
+                        splay_tree.try_emplace("not").first->value += 5;
+                        REQUIRE(splay_tree.search("or")->value == 42);
+                        REQUIRE(splay_tree.search("not")->value == 6);
+                        REQUIRE(splay_tree.upsert("is", [](int &count) { count *= 3; })->value == 3);
+                }
+        }
+        GIVEN("A Splay Tree of counted values") {
+                forest::splay_tree <int, counted> splay_tree;
+                splay_tree.insert(1, counted(1));
+                THEN("Test insert_or_assign moves into the existing value") {
+                        long long alive = counted::alive();
+                        counted::reset();
+                        REQUIRE(!splay_tree.insert_or_assign(1, counted(2)).second);
+                        REQUIRE(counted::copies() == 0);
+                        REQUIRE(counted::moves() == 1);
+                        REQUIRE(counted::alive() == alive);
+                        REQUIRE(splay_tree.search(1)->value.value == 2);
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree minimum and maximum") {
+        GIVEN("An empty Splay Tree") {
+                forest::splay_tree <int, int> splay_tree;
+                THEN("There is no minimum or maximum to remove") {
+                        REQUIRE(splay_tree.minimum() == nullptr);
+                        REQUIRE(splay_tree.maximum() == nullptr);
+                        REQUIRE(!splay_tree.pop_min());
+                        REQUIRE(!splay_tree.pop_max());
+                }
+        }
+        GIVEN("A Splay Tree changed by random inserts and erases") {
+                forest::splay_tree <int, int> splay_tree;
+                std::set <int> reference;
+                std::mt19937 random(5);
+                THEN("The minimum and maximum always match a std::set") {
+                        for (int i = 0; i < 5000; i++) {
+                                int key = static_cast<int>(random() % 500);
+                                switch (random() % 4) {
+                                case 0:
+                                        REQUIRE(splay_tree.erase(key) == (reference.erase(key) == 1));
+                                        break;
+                                case 1:
+                                        REQUIRE(splay_tree.pop_min() == !reference.empty());
+                                        if (!reference.empty()) reference.erase(reference.begin());
+                                        break;
+                                default:
+                                        splay_tree.insert(key, key);
+                                        reference.insert(key);
+                                }
+                                if (reference.empty()) {
+                                        REQUIRE(splay_tree.minimum() == nullptr);
+                                        REQUIRE(splay_tree.maximum() == nullptr);
+                                } else {
+                                        REQUIRE(splay_tree.minimum()->key == *reference.begin());
+                                        REQUIRE(splay_tree.maximum()->key == *reference.rbegin());
+                                        REQUIRE(splay_tree.begin()->key == *reference.begin());
+                                }
+                        }
+                }
+        }
+        GIVEN("A Splay Tree with the keys 0 to 99") {
+                forest::splay_tree <int, int> splay_tree;
+                for (int key : {50, 20, 80, 10, 30, 70, 90}) {
+                        splay_tree.insert(key, key);
+                }
+                for (int i = 0; i < 100; i++) {
+                        splay_tree.insert(i, i);
+                }
+                THEN("Test pop_min removes the keys in increasing order") {
+                        for (int i = 0; i < 100; i++) {
+                                REQUIRE(splay_tree.minimum()->key == i);
+                                REQUIRE(splay_tree.pop_min());
+                        }
+                        REQUIRE(splay_tree.empty());
+                        REQUIRE(!splay_tree.pop_min());
+                }
+                THEN("Test pop_max removes the keys in decreasing order") {
+                        for (int i = 99; i >= 0; i--) {
+                                REQUIRE(splay_tree.maximum()->key == i);
+                                REQUIRE(splay_tree.pop_max());
+                        }
+                        REQUIRE(splay_tree.empty());
+                        REQUIRE(splay_tree.begin() == splay_tree.end());
+                }
+                THEN("Test popping from both ends") {
+                        for (int i = 0; i < 50; i++) {
+                                REQUIRE(splay_tree.pop_min());
+                                REQUIRE(splay_tree.pop_max());
+                        }
+                        REQUIRE(splay_tree.empty());
+                        splay_tree.insert(7, 7);
+                        REQUIRE(splay_tree.minimum() == splay_tree.maximum());
+                }
+        }
+        GIVEN("A bulk loaded Splay Tree") {
+                std::vector <std::pair <int, int> > pairs;
+                for (int i = 0; i < 100; i++) {
+                        pairs.push_back(std::make_pair(i * 2, i));
+                }
+                forest::splay_tree <int, int> splay_tree = forest::splay_tree <int, int>::from_sorted(pairs.begin(), pairs.end());
+                THEN("The minimum and maximum are known") {
+                        REQUIRE(splay_tree.minimum()->key == 0);
+                        REQUIRE(splay_tree.maximum()->key == 198);
+                        forest::splay_tree <int, int> moved(std::move(splay_tree));
+                        REQUIRE(splay_tree.minimum() == nullptr);
+                        REQUIRE(moved.minimum()->key == 0);
+                        REQUIRE(moved.maximum()->key == 198);
+                }
+        }
+}
+
+SCENARIO("Test Splay Tree index storage") {
+        typedef forest::splay_tree <int, int, std::less <int>, true> indexed_tree;
+        GIVEN("The node layouts") {
+                THEN("Links take 4 bytes each") {
+                        REQUIRE(sizeof(forest::splay_tree_node <int, int, true>) == 4 + 4 + 3 * 4);
+                        REQUIRE(sizeof(forest::splay_tree_node <int, int, true>) < sizeof(forest::splay_tree_node <int, int>));
+                }
+        }
+        GIVEN("An indexed Splay Tree under random inserts and erases") {
+                indexed_tree splay_tree;
+                std::set <int> reference;
+                std::mt19937 random(31);
+                for (int i = 0; i < 20000; i++) {
+                        int key = static_cast<int>(random() % 1024);
+                        if (random() % 3 != 0) {
+                                splay_tree.insert(key, key);
+                                reference.insert(key);
+                        } else {
+                                REQUIRE(splay_tree.erase(key) == (reference.erase(key) == 1));
+                        }
+                }
+                THEN("The tree holds the same keys as a std::set") {
+                        REQUIRE(splay_tree.size() == reference.size());
+                        REQUIRE(std::equal(reference.begin(), reference.end(), splay_tree.begin(), [](int key, const forest::splay_tree_node <int, int, true> &node) {
+                                return key == node.key;
+                        }));
+                        REQUIRE(std::equal(reference.rbegin(), reference.rend(), splay_tree.rbegin(), [](int key, const forest::splay_tree_node <int, int, true> &node) {
+                                return key == node.key;
+                        }));
+                }
+                WHEN("The tree is cloned and the original is cleared") {
+                        indexed_tree copy = splay_tree.clone();
+                        splay_tree.clear();
+                        THEN("The clone keeps every node") {
+                                REQUIRE(copy.size() == reference.size());
+                                REQUIRE(copy.minimum()->key == *reference.begin());
+                                REQUIRE(copy.maximum()->key == *reference.rbegin());
+                                REQUIRE(std::equal(reference.begin(), reference.end(), copy.begin(), [](int key, const forest::splay_tree_node <int, int, true> &node) {
+                                        return key == node.key;
+                                }));
+                        }
+                }
+                WHEN("The tree is saved and loaded into another tree") {
+                        std::stringstream stream;
+                        splay_tree.save(stream);
+                        indexed_tree loaded;
+                        loaded.insert(-1, -1);
+                        loaded.load(stream);
+                        THEN("The loaded tree holds the same keys and accepts new ones") {
+                                REQUIRE(loaded.size() == reference.size());
+                                REQUIRE(std::equal(reference.begin(), reference.end(), loaded.begin(), [](int key, const forest::splay_tree_node <int, int, true> &node) {
+                                        return key == node.key;
+                                }));
+                                for (int i = 2000; i < 3000; i++) {
+                                        loaded.insert(i, i);
+                                }
+                                REQUIRE(loaded.size() == reference.size() + 1000);
+                                REQUIRE(loaded.search(2500)->value == 2500);
+                        }
+                }
+        }
+        GIVEN("An indexed Splay Tree with reserved nodes") {
+                indexed_tree splay_tree;
+                splay_tree.reserve(1000);
+                splay_tree.insert(0, 0);
+                const forest::splay_tree_node <int, int, true> *first = splay_tree.search(0);
+                for (int i = 1; i < 1000; i++) {
+                        splay_tree.insert(i, i);
+                }
+                THEN("Nodes do not move") {
+                        REQUIRE(splay_tree.search(0) == first);
+                        REQUIRE(splay_tree.size() == 1000);
+                }
+        }
+}
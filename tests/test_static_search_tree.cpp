@@ -0,0 +1,149 @@
+#include "catch.hpp"
+#include <forest/b_tree.h>
+#include <forest/binary_search_tree.h>
+#include <forest/bplus_tree.h>
+#include <forest/red_black_tree.h>
+#include <forest/splay_tree.h>
+#include <forest/static_search_tree.h>
+#include "counted.h"
+#include "string_less.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks every key of a frozen tree built from the odd keys 1 to 2n - 1, and the gaps between them
+ */
+template <typename tree_t>
+bool same_frozen_keys(const forest::static_search_tree <int, int> &frozen, const tree_t &tree) {
+        int n = static_cast<int>(tree.size());
+        if (frozen.size() != tree.size()) return false;
+        for (int key = 0; key <= 2 * n; key++) {
+                const int *value = frozen.search(key);
+                const int *lower = frozen.lower_bound(key);
+                if (key % 2 == 1) {
+                        if (value == nullptr || *value != -key) return false;
+                        if (lower == nullptr || *lower != key) return false;
+                } else {
+                        if (value != nullptr) return false;
+                        if (key == 2 * n ? lower != nullptr : lower == nullptr || *lower != key + 1) return false;
+                }
+        }
+        return true;
+}
+
+SCENARIO("Test Static Search Tree") {
+        GIVEN("An empty Static Search Tree") {
+                forest::static_search_tree <int, int> frozen;
+                THEN("Test empty") {
+                        REQUIRE(frozen.empty() == true);
+                        REQUIRE(frozen.size() == 0);
+                        REQUIRE(frozen.height() == 0);
+                        REQUIRE(frozen.search(1) == nullptr);
+                        REQUIRE(frozen.lower_bound(1) == nullptr);
+                }
+        }
+        GIVEN("Red Black Trees of every size up to 200") {
+                THEN("Test every key and gap of the frozen tree") {
+                        for (int n = 0; n <= 200; n++) {
+                                forest::red_black_tree <int, int> tree;
+                                for (int i = 0; i < n; i++) {
+                                        tree.insert(2 * i + 1, -(2 * i + 1));
+                                }
+                                forest::static_search_tree <int, int> frozen = tree.freeze();
+                                REQUIRE(same_frozen_keys(frozen, tree));
+                        }
+                }
+        }
+        GIVEN("Every kind of tree with the same keys") {
+                forest::red_black_tree <int, int> red_black_tree;
+                forest::binary_search_tree <int, int> binary_search_tree;
+                forest::splay_tree <int, int> splay_tree;
+                forest::b_tree <int, int, std::less <int>, 5> b_tree;
+                forest::bplus_tree <int, int, std::less <int>, 5> bplus_tree;
+                for (int i = 0; i < 1000; i++) {
+                        int key = 2 * ((i * 7919) % 1000) + 1;
+                        red_black_tree.insert(key, -key);
+                        binary_search_tree.insert(key, -key);
+                        splay_tree.insert(key, -key);
+                        b_tree.insert(key, -key);
+                        bplus_tree.insert(key, -key);
+                }
+                THEN("Test freeze on every tree") {
+                        REQUIRE(same_frozen_keys(red_black_tree.freeze(), red_black_tree));
+                        REQUIRE(same_frozen_keys(binary_search_tree.freeze(), binary_search_tree));
+                        REQUIRE(same_frozen_keys(splay_tree.freeze(), splay_tree));
+                        REQUIRE(same_frozen_keys(b_tree.freeze(), b_tree));
+                        REQUIRE(same_frozen_keys(bplus_tree.freeze(), bplus_tree));
+                }
+                THEN("Test the frozen tree outlives its source and moves") {
+                        forest::static_search_tree <int, int> frozen = red_black_tree.freeze();
+                        red_black_tree.clear();
+                        REQUIRE(frozen.height() == 10);
+                        forest::static_search_tree <int, int> other(std::move(frozen));
+                        REQUIRE(frozen.empty());
+                        REQUIRE(other.size() == 1000);
+                        REQUIRE(*other.search(999) == -999);
+                        frozen = std::move(other);
+                        REQUIRE(*frozen.search(1) == -1);
+                }
+        }
+}
+
+SCENARIO("Test Static Search Tree values") {
+        GIVEN("A Red Black Tree of counted values") {
+                long long alive = counted::alive();
+                {
+                        forest::red_black_tree <int, counted> tree;
+                        for (int i = 0; i < 100; i++) {
+                                tree.insert(i, counted(i));
+                        }
+                        {
+                                forest::static_search_tree <int, counted> frozen = tree.freeze();
+                                REQUIRE(counted::alive() == alive + 200);
+                                REQUIRE(frozen.search(42)->value == 42);
+                        }
+                        THEN("Test the frozen values are destroyed with the Static Search Tree") {
+                                REQUIRE(counted::alive() == alive + 100);
+                        }
+                }
+        }
+        GIVEN("A Red Black Tree of strings with a transparent comparator") {
+                forest::red_black_tree <std::string, int, string_less> tree;
+                std::vector <std::string> words = {"pear", "apple", "fig", "plum", "kiwi"};
+                for (const std::string &word : words) {
+                        tree.insert(word, static_cast<int>(word.size()));
+                }
+                forest::static_search_tree <std::string, int, string_less> frozen = tree.freeze();
+                THEN("Test search by string literal") {
+                        REQUIRE(*frozen.search("apple") == 5);
+                        REQUIRE(*frozen.search("fig") == 3);
+                        REQUIRE(frozen.search("grape") == nullptr);
+                        REQUIRE(*frozen.lower_bound("grape") == "kiwi");
+                }
+        }
+}
+
+SCENARIO("Test Static Search Tree batched search") {
+        GIVEN("Red Black Trees of every size up to 100") {
+                THEN("Batches of every size up to 40 find what search finds") {
+                        for (int n = 0; n <= 100; n++) {
+                                forest::red_black_tree <int, int> red_black_tree;
+                                for (int i = 0; i < n; i++) {
+                                        red_black_tree.insert(2 * i + 1, -(2 * i + 1));
+                                }
+                                forest::static_search_tree <int, int> frozen = red_black_tree.freeze();
+                                for (std::size_t m = 0; m <= 40; m++) {
+                                        std::vector <int> keys;
+                                        for (std::size_t i = 0; i < m; i++) {
+                                                keys.push_back(static_cast<int>((i * 37 + m) % (2 * n + 3)) - 1);
+                                        }
+                                        std::vector <const int *> found(m);
+                                        frozen.search_batch(keys.data(), m, found.data());
+                                        for (std::size_t i = 0; i < m; i++) {
+                                                REQUIRE(found[i] == frozen.search(keys[i]));
+                                        }
+                                }
+                        }
+                }
+        }
+}